@@ -108,6 +108,85 @@ float ADSR::Value(double time) const
    return ofLerp(stageStartValue, mStages[stage].target * mMult, lerp);
 }
 
+//same as calling Value() for each sample from time onwards, but only looks up the stage when it changes.
+//linear segments give exactly the same result as Value(), curved ones step the power curve along with a
+//short series instead of calling powf() for every sample, resyncing every few samples to keep the error down
+void ADSR::Render(double time, float* out, int samples) const
+{
+   const int kCurveResyncInterval = 16;
+   const float kMaxCurveStepRatio = 1.0f / 64; //the series is only accurate for small steps
+   
+   int i = 0;
+   while (i < samples)
+   {
+      double stageStartTime;
+      int stage = GetStage(time, stageStartTime);
+      
+      if (stage == mNumStages)  //done, or not started yet
+      {
+         float value = mStages[stage-1].target;
+         bool waitingToStart = time < mStartTime;
+         for (; i < samples && (!waitingToStart || time < mStartTime); ++i, time += gInvSampleRateMs)
+            out[i] = value;
+         continue;
+      }
+      
+      bool stopPending = mHasSustainStage && stage <= mSustainStage && mStopTime > mStartTime;
+      double stageEndTime = stageStartTime + mStages[stage].time;
+      
+      if (mHasSustainStage && stage == mSustainStage && time > stageEndTime)  //holding at sustain
+      {
+         float value = mStages[mSustainStage].target * mMult;
+         for (; i < samples && !(stopPending && time >= mStopTime); ++i, time += gInvSampleRateMs)
+            out[i] = value;
+         continue;
+      }
+      
+      float stageStartValue;
+      if (stage == 0)
+         stageStartValue = mStartBlendFromValue;
+      else if (mHasSustainStage && stage == mSustainStage + 1)
+         stageStartValue = mStopBlendFromValue;
+      else
+         stageStartValue = mStages[stage-1].target * mMult;
+      float stageTarget = mStages[stage].target * mMult;
+      float stageTime = mStages[stage].time;
+      
+      if (mStages[stage].curve == 0)
+      {
+         for (; i < samples && time <= stageEndTime && !(stopPending && time >= mStopTime); ++i, time += gInvSampleRateMs)
+            out[i] = ofLerp(stageStartValue, stageTarget, (time - stageStartTime) / stageTime);
+      }
+      else
+      {
+         //MathUtils::Curve(t, c) is pow(t, 5^-c)
+         float exponent = powf(5, -mStages[stage].curve * ((stageStartValue < stageTarget) ? 1 : -1));
+         float lerpStep = gInvSampleRateMs / stageTime;
+         float c1 = exponent;
+         float c2 = exponent * (exponent - 1) / 2;
+         float c3 = c2 * (exponent - 2) / 3;
+         float curved = 0;
+         int stepsSinceResync = kCurveResyncInterval;
+         for (; i < samples && time <= stageEndTime && !(stopPending && time >= mStopTime); ++i, time += gInvSampleRateMs)
+         {
+            float lerp = (time - stageStartTime) / stageTime;
+            float ratio = lerpStep / (lerp - lerpStep);  //relative step from the previous sample's lerp
+            if (stepsSinceResync >= kCurveResyncInterval || lerp <= lerpStep || ratio > kMaxCurveStepRatio)
+            {
+               curved = powf(lerp, exponent);
+               stepsSinceResync = 0;
+            }
+            else
+            {
+               curved *= 1 + ratio * (c1 + ratio * (c2 + ratio * c3));
+               ++stepsSinceResync;
+            }
+            out[i] = ofLerp(stageStartValue, stageTarget, curved);
+         }
+      }
+   }
+}
+
 int ADSR::GetStage(double time, double& stageStartTimeOut) const
 {
    if (time < mStartTime || mStartTime < 0)
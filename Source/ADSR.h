@@ -35,6 +35,7 @@ public:
    void Start(double time, float target, const ADSR& adsr);
    void Stop(double time);
    float Value(double time) const;
+   void Render(double time, float* out, int samples) const;
    void Set(float a, float d, float s, float r, float h = -1);
    void Set(const ADSR& other);
    void Clear() { mMult = 0; mStartTime = -10000; mStopTime = -10000; mStartBlendFromValue = 0; mStopBlendFromValue = 0; }
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    ADSRTests.cpp
+    Created: 18 Oct 2026 2:14:51pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "ADSR.h"
+#include "SynthGlobals.h"
+
+#if JUCE_UNIT_TESTS
+
+//ADSR::Render() has to stay interchangeable with calling ADSR::Value() for every sample,
+//since voices and the envelope display mix the two freely
+class ADSRTests : public UnitTest
+{
+public:
+   ADSRTests() : UnitTest("ADSR") {}
+
+   void runTest() override
+   {
+      beginTest("linear envelope");
+      {
+         ADSR adsr(10, 50, .5f, 100);
+         adsr.Start(0, 1);
+         adsr.Stop(300);
+         ExpectRenderMatchesValue(adsr, -5, 450);
+      }
+
+      beginTest("curved stages");
+      {
+         ADSR adsr(30, 80, .3f, 200);
+         adsr.GetStageData(0).curve = .8f;
+         adsr.GetStageData(1).curve = -.7f;
+         adsr.GetStageData(2).curve = .5f;
+         adsr.Start(0, .8f);
+         adsr.Stop(200);
+         ExpectRenderMatchesValue(adsr, -5, 450);
+      }
+
+      beginTest("stopped during attack");
+      {
+         ADSR adsr(100, 50, .5f, 80);
+         adsr.GetStageData(0).curve = -.4f;
+         adsr.Start(0, 1);
+         adsr.Stop(37.3);
+         ExpectRenderMatchesValue(adsr, 0, 200);
+      }
+
+      beginTest("max sustain");
+      {
+         ADSR adsr(5, 20, .8f, 50);
+         adsr.SetMaxSustain(40);
+         adsr.Start(0, 1);
+         ExpectRenderMatchesValue(adsr, 0, 150);
+      }
+
+      beginTest("retriggered while releasing");
+      {
+         ADSR adsr(20, 30, .6f, 120);
+         adsr.GetStageData(2).curve = .6f;
+         adsr.Start(0, 1);
+         adsr.Stop(80);
+         adsr.Start(140, .7f);
+         adsr.Stop(260);
+         ExpectRenderMatchesValue(adsr, 130, 420);
+      }
+
+      beginTest("multi-stage envelope");
+      {
+         ADSR adsr;
+         adsr.SetNumStages(5);
+         float targets[] = { 1, .2f, .7f, .4f, 0 };
+         float times[] = { 15, 25, 40, 10, 90 };
+         float curves[] = { .3f, 0, -.5f, 0, .9f };
+         for (int i=0; i<5; ++i)
+         {
+            adsr.GetStageData(i).target = targets[i];
+            adsr.GetStageData(i).time = times[i];
+            adsr.GetStageData(i).curve = curves[i];
+         }
+         adsr.GetHasSustainStage() = true;
+         adsr.SetSustainStage(3);
+         adsr.Start(0, 1);
+         adsr.Stop(180);
+         ExpectRenderMatchesValue(adsr, 0, 320);
+      }
+   }
+
+private:
+   void ExpectRenderMatchesValue(const ADSR& adsr, double startTime, double endTime)
+   {
+      //an odd block size, so stage changes land all over the blocks
+      const int kBlockSize = 37;
+      float block[kBlockSize];
+      float maxError = 0;
+      for (double time = startTime; time < endTime; time += kBlockSize * gInvSampleRateMs)
+      {
+         adsr.Render(time, block, kBlockSize);
+         //step the time along the same way Render() does, so a sample that lands right on a stage change isn't
+         //judged against the other side of it
+         double sampleTime = time;
+         for (int i=0; i<kBlockSize; ++i, sampleTime += gInvSampleRateMs)
+            maxError = MAX(maxError, fabsf(block[i] - adsr.Value(sampleTime)));
+      }
+      expect(maxError < 1e-5f, "Render() strays "+String(maxError)+" from Value()");
+   }
+};
+
+static ADSRTests sADSRTests;
+
+#endif
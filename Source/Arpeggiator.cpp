@@ -316,6 +316,8 @@ void Arpeggiator::OnTimeEvent(int samplesTo)
 {
    if (!mEnabled)
       return;
+   
+   double time = gTime + samplesTo * gInvSampleRateMs;
 
    if (mViewGrid)
    {
@@ -340,7 +342,7 @@ void Arpeggiator::OnTimeEvent(int samplesTo)
    if (mChord.size() == 0)
    {
       if (mLastPitch != -1)
-         PlayNoteOutput(gTime, mLastPitch, 0, -1);
+         PlayNoteOutput(time, mLastPitch, 0, -1);
       mLastPitch = -1;
       return;
    }
@@ -420,11 +422,11 @@ void Arpeggiator::OnTimeEvent(int samplesTo)
          {
             if (mLastPitch == outPitch)   //same note, play noteoff first
             {
-               PlayNoteOutput(gTime, mLastPitch, 0, -1);
+               PlayNoteOutput(time, mLastPitch, 0, -1);
                offPitch = -1;
             }
             float pressure = current.modulation.pressure ? current.modulation.pressure->GetValue(0) : 0;
-            PlayNoteOutput(gTime, outPitch, ofClamp(current.vel+127*pressure,0,127), current.voiceIdx, current.modulation);
+            PlayNoteOutput(time, outPitch, ofClamp(current.vel+127*pressure,0,127), current.voiceIdx, current.modulation);
             mLastPitch = outPitch;
          }
       }
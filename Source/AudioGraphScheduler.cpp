@@ -0,0 +1,289 @@
+/*
+  ==============================================================================
+
+    AudioGraphScheduler.cpp
+    Created: 17 Oct 2026 10:12:04am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "AudioGraphScheduler.h"
+#include "IAudioSource.h"
+#include "IAudioReceiver.h"
+
+AudioGraphScheduler::AudioGraphScheduler()
+: mPlan(new Plan())
+, mPendingPlan(nullptr)
+, mRetiredPlan(nullptr)
+, mTime(0)
+, mNextNode(0)
+, mBlockNodeCount(0)
+, mNodesDone(0)
+{
+   for (int i=0; i<kMaxWorkers+1; ++i)
+   {
+      mBusyTicks[i] = 0;
+      mLoad[i] = 0;
+   }
+}
+
+AudioGraphScheduler::~AudioGraphScheduler()
+{
+   StopWorkers();
+   delete mPlan;
+   delete mPendingPlan.exchange(nullptr);
+   delete mRetiredPlan.exchange(nullptr);
+}
+
+//builds a new plan and hands it to the audio thread, which picks it up at the start of its next block.
+//the audio thread gives the old plan back through mRetiredPlan, and we free it here so it never has to
+void AudioGraphScheduler::SetSources(const vector<IAudioSource*>& orderedSources)
+{
+   FreeRetiredPlan();
+
+   Plan* plan = new Plan();
+   int numNodes = (int)orderedSources.size();
+   plan->mNodes.resize(numNodes);
+
+   vector<IAudioReceiver*> receivers;
+   vector< vector<IAudioReceiver*> > targets(numNodes);
+   for (int i=0; i<numNodes; ++i)
+   {
+      plan->mNodes[i].mSource = orderedSources[i];
+      for (int k=0; k<orderedSources[i]->GetNumTargets(); ++k)
+      {
+         IAudioReceiver* target = orderedSources[i]->GetTarget(k);
+         if (target != nullptr && !VectorContains(target, targets[i]))
+         {
+            targets[i].push_back(target);
+            auto iter = std::find(receivers.begin(), receivers.end(), target);
+            if (iter == receivers.end())
+            {
+               plan->mNodes[i].mReceiverLocks.push_back((int)receivers.size());
+               receivers.push_back(target);
+            }
+            else
+            {
+               plan->mNodes[i].mReceiverLocks.push_back(int(iter - receivers.begin()));
+            }
+         }
+      }
+      std::sort(plan->mNodes[i].mReceiverLocks.begin(), plan->mNodes[i].mReceiverLocks.end());
+   }
+
+   //whichever of two connected sources comes first in the serial ordering runs first.
+   //that also covers feedback loops, where the serial ordering decides who hears last block's audio
+   for (int i=0; i<numNodes; ++i)
+   {
+      IAudioReceiver* receiverI = dynamic_cast<IAudioReceiver*>(orderedSources[i]);
+      for (int j=0; j<i; ++j)
+      {
+         IAudioReceiver* receiverJ = dynamic_cast<IAudioReceiver*>(orderedSources[j]);
+         bool connected = (receiverI != nullptr && VectorContains(receiverI, targets[j])) ||
+                          (receiverJ != nullptr && VectorContains(receiverJ, targets[i]));
+         if (connected)
+         {
+            plan->mNodes[j].mDependents.push_back(i);
+            ++plan->mNodes[i].mNumDependencies;
+         }
+      }
+   }
+
+   plan->mNumReceivers = (int)receivers.size();
+   plan->mPending.reset(new std::atomic<int>[MAX(numNodes,1)]);
+   plan->mReceiverBusy.reset(new std::atomic<bool>[MAX(plan->mNumReceivers,1)]);
+   for (int i=0; i<plan->mNumReceivers; ++i)
+      plan->mReceiverBusy[i] = false;
+
+   delete mPendingPlan.exchange(plan);   //if the audio thread never saw the previous one, it's ours to free
+}
+
+void AudioGraphScheduler::FreeRetiredPlan()
+{
+   delete mRetiredPlan.exchange(nullptr);
+}
+
+void AudioGraphScheduler::SetNumWorkers(int numWorkers)
+{
+   numWorkers = ofClamp(numWorkers, 0, kMaxWorkers);
+
+   ScopedLock lock(mWorkersMutex);
+   StopWorkers();
+   for (int i=0; i<numWorkers; ++i)
+   {
+      Worker* worker = new Worker(this, i+1);
+      worker->startThread(9);
+      mWorkers.push_back(worker);
+   }
+   for (int i=0; i<kMaxWorkers+1; ++i)
+   {
+      mBusyTicks[i] = 0;
+      mLoad[i] = 0;
+   }
+}
+
+void AudioGraphScheduler::StopWorkers()
+{
+   for (auto* worker : mWorkers)
+      worker->signalThreadShouldExit();
+   for (auto* worker : mWorkers)
+   {
+      worker->Wake();
+      worker->stopThread(1000);
+      delete worker;
+   }
+   mWorkers.clear();
+}
+
+void AudioGraphScheduler::Process(double time)
+{
+   //only take a new plan once the last retired one has been freed, so the audio thread never deletes anything
+   if (mRetiredPlan.load(std::memory_order_acquire) == nullptr)
+   {
+      Plan* pending = mPendingPlan.exchange(nullptr, std::memory_order_acq_rel);
+      if (pending != nullptr)
+      {
+         mRetiredPlan.store(mPlan, std::memory_order_release);
+         mPlan = pending;
+      }
+   }
+
+   int numNodes = (int)mPlan->mNodes.size();
+   if (numNodes == 0)
+      return;
+   
+   //if the ui thread is busy changing the worker count, just run this block serially
+   ScopedTryLock lock(mWorkersMutex);
+   if (!lock.isLocked() || mWorkers.empty())
+   {
+      for (int i=0; i<numNodes; ++i)
+         mPlan->mNodes[i].mSource->Process(time);
+      return;
+   }
+
+   mTime = time;
+   for (int i=0; i<numNodes; ++i)
+      mPlan->mPending[i].store(mPlan->mNodes[i].mNumDependencies, std::memory_order_relaxed);
+   mNodesDone.store(0, std::memory_order_relaxed);
+   mNextNode.store(0, std::memory_order_release);
+   mBlockNodeCount.store(numNodes, std::memory_order_release);
+
+   for (auto* worker : mWorkers)
+      worker->Wake();
+
+   RunNodes(0);
+
+   SpinWait wait;
+   while (mNodesDone.load(std::memory_order_acquire) < numNodes)
+      wait.Pause();  //a worker is finishing up the last nodes
+
+   mBlockNodeCount.store(0, std::memory_order_release);
+
+   double budgetTicks = Time::getHighResolutionTicksPerSecond() * gBufferSize / double(gSampleRate);
+   for (int i=0; i<GetNumLoadSlots(); ++i)
+   {
+      float load = mBusyTicks[i].exchange(0) / budgetTicks;
+      mLoad[i] = MAX(load, mLoad[i] * .995f); //hold peaks long enough to be read
+   }
+}
+
+void AudioGraphScheduler::RunNodes(int slot)
+{
+   int64 start = Time::getHighResolutionTicks();
+
+   while (true)
+   {
+      int count = mBlockNodeCount.load(std::memory_order_acquire);
+      int index = mNextNode.load(std::memory_order_relaxed);
+      if (index >= count)
+         break;
+      if (!mNextNode.compare_exchange_weak(index, index+1, std::memory_order_acq_rel))
+         continue;
+      if (index >= mBlockNodeCount.load(std::memory_order_acquire))
+         break;   //woke up late and the block we claimed for is already over
+      RunNode(index);
+   }
+
+   mBusyTicks[slot] += Time::getHighResolutionTicks() - start;
+}
+
+void AudioGraphScheduler::RunNode(int index)
+{
+   const Node& node = mPlan->mNodes[index];
+
+   //nodes are claimed in order, so anything we're waiting on is already being processed
+   SpinWait wait;
+   while (mPlan->mPending[index].load(std::memory_order_acquire) > 0)
+      wait.Pause();
+
+   for (int lock : node.mReceiverLocks)
+   {
+      bool expected = false;
+      while (!mPlan->mReceiverBusy[lock].compare_exchange_weak(expected, true, std::memory_order_acquire))
+      {
+         expected = false;
+         wait.Pause();
+      }
+   }
+
+   node.mSource->Process(mTime);
+
+   for (int lock : node.mReceiverLocks)
+      mPlan->mReceiverBusy[lock].store(false, std::memory_order_release);
+
+   for (int dependent : node.mDependents)
+      mPlan->mPending[dependent].fetch_sub(1, std::memory_order_acq_rel);
+
+   mNodesDone.fetch_add(1, std::memory_order_acq_rel);
+}
+
+float AudioGraphScheduler::GetLoad(int slot) const
+{
+   assert(slot >= 0 && slot <= kMaxWorkers);
+   return mLoad[slot];
+}
+
+void AudioGraphScheduler::Draw()
+{
+   if (!IsParallel())
+      return;
+
+   ofPushMatrix();
+   ofPushStyle();
+   ofTranslate(ofGetWidth() / gDrawScale - 210, 30);
+   ofFill();
+   ofSetColor(0,0,0,140);
+   ofRect(-5,-15,210,GetNumLoadSlots()*15+10);
+   for (int i=0; i<GetNumLoadSlots(); ++i)
+   {
+      float load = GetLoad(i);
+      ofSetColor(255,255,255);
+      gFont.DrawString((i == 0 ? "audio: " : "worker "+ofToString(i)+": ")+ofToString(int(load*100))+"%", 15, 0, 0);
+      if (load > 1)
+         ofSetColor(255,0,0);
+      else
+         ofSetColor(0,255,0);
+      ofRect(100, -10, MIN(load,1)*100, 10);
+      ofTranslate(0, 15);
+   }
+   ofPopStyle();
+   ofPopMatrix();
+}
+
+AudioGraphScheduler::Worker::Worker(AudioGraphScheduler* owner, int slot)
+: juce::Thread("audio graph worker "+String(slot))
+, mOwner(owner)
+, mSlot(slot)
+{
+}
+
+void AudioGraphScheduler::Worker::run()
+{
+   PrepareAudioThread();
+   while (!threadShouldExit())
+   {
+      if (mWake.wait(100))
+         mOwner->RunNodes(mSlot);
+   }
+}
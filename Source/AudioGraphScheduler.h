@@ -0,0 +1,91 @@
+/*
+  ==============================================================================
+
+    AudioGraphScheduler.h
+    Created: 17 Oct 2026 10:12:04am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SynthGlobals.h"
+#include <atomic>
+#include <memory>
+
+class IAudioSource;
+class IAudioReceiver;
+
+//runs the audio source graph on a pool of worker threads.
+//sources are claimed in dependency order, a source only runs once everything that feeds it has run,
+//and sources that write into the same receiver never run at the same time.
+//graph changes are double-buffered, so the audio thread never waits on the ui to rebuild the plan
+class AudioGraphScheduler
+{
+public:
+   AudioGraphScheduler();
+   ~AudioGraphScheduler();
+
+   void SetSources(const vector<IAudioSource*>& orderedSources);
+   void FreeRetiredPlan();   //main thread. the audio thread won't take another plan until the last one it let go of is freed
+   void SetNumWorkers(int numWorkers);
+   int GetNumWorkers() const { return (int)mWorkers.size(); }
+   bool IsParallel() const { return !mWorkers.empty(); }
+   void Process(double time);
+
+   int GetNumLoadSlots() const { return GetNumWorkers() + 1; }  //slot 0 is the audio device thread
+   float GetLoad(int slot) const;
+   void Draw();
+
+   static const int kMaxWorkers = 15;
+
+private:
+   class Worker : public juce::Thread
+   {
+   public:
+      Worker(AudioGraphScheduler* owner, int slot);
+      void run() override;
+      void Wake() { mWake.signal(); }
+   private:
+      AudioGraphScheduler* mOwner;
+      int mSlot;
+      WaitableEvent mWake;
+   };
+
+   struct Node
+   {
+      Node() : mSource(nullptr), mNumDependencies(0) {}
+      IAudioSource* mSource;
+      int mNumDependencies;
+      vector<int> mDependents;
+      vector<int> mReceiverLocks;   //sorted, so they're always taken in the same order
+   };
+
+   struct Plan
+   {
+      Plan() : mNumReceivers(0) {}
+      vector<Node> mNodes;
+      int mNumReceivers;
+      std::unique_ptr<std::atomic<int>[]> mPending;
+      std::unique_ptr<std::atomic<bool>[]> mReceiverBusy;
+   };
+
+   void RunNodes(int slot);
+   void RunNode(int index);
+   void StopWorkers();
+
+   Plan* mPlan;   //only touched by the audio thread (and the workers while it waits on them)
+   std::atomic<Plan*> mPendingPlan;
+   std::atomic<Plan*> mRetiredPlan;
+   CriticalSection mWorkersMutex;
+   vector<Worker*> mWorkers;
+
+   double mTime;
+   std::atomic<int> mNextNode;
+   std::atomic<int> mBlockNodeCount;
+   std::atomic<int> mNodesDone;
+
+   std::atomic<int64> mBusyTicks[kMaxWorkers+1];
+   std::atomic<float> mLoad[kMaxWorkers+1];
+};
@@ -680,7 +680,7 @@ void BeatBloks::DrawModule()
       ofPushStyle();
       
       mSample->LockDataMutex(true);
-      DrawAudioBuffer(mBufferW, mBufferH, mSample->Data(), mZoomStart, mZoomEnd, (int)mPlayheadWhole);
+      DrawAudioBuffer(mBufferW, mBufferH, mSample->GetPeaks(), mZoomStart, mZoomEnd, (int)mPlayheadWhole);
       mSample->LockDataMutex(false);
       
       int sampleLength = MAX(1,mSample->LengthInSamples());
@@ -788,7 +788,7 @@ void BeatBloks::DrawModule()
       float dur = ofMap((*iter)->mDuration*sourceSampleLength,mRemixZoomStart,mRemixZoomEnd,0,1);
       
       float width = MAX(0.0f,mBufferW*dur);
-      DrawAudioBuffer(width,mBufferH,mSample->Data(),StartTime(*(*iter))*sourceSampleLength,(StartTime(*(*iter))+(*iter)->mDuration)*sourceSampleLength,-1);
+      DrawAudioBuffer(width,mBufferH,mSample->GetPeaks(),StartTime(*(*iter))*sourceSampleLength,(StartTime(*(*iter))+(*iter)->mDuration)*sourceSampleLength,-1);
       
       if ((*iter)->mType == kBlok_Bar)
       {
@@ -868,7 +868,7 @@ void BeatBloks::DrawModule()
       float dur = ofMap(mHeldBlok->mDuration,0,(mZoomEnd-mZoomStart)/sampleLength,0,1);
       
       float width = mBufferW*dur;
-      DrawAudioBuffer(width,mBufferH,mSample->Data(),StartTime(*mHeldBlok)*sampleLength,(StartTime(*mHeldBlok)+mHeldBlok->mDuration)*sampleLength,-1);
+      DrawAudioBuffer(width,mBufferH,mSample->GetPeaks(),StartTime(*mHeldBlok)*sampleLength,(StartTime(*mHeldBlok)+mHeldBlok->mDuration)*sampleLength,-1);
       
       ofPopMatrix();
       
@@ -281,7 +281,7 @@ void BeatColumn::Draw(int x, int y)
    {
       ofPushMatrix();
       ofTranslate(x, y);
-      DrawAudioBuffer(100, 35, mBeatData.mBeat->Data(), 0, mBeatData.mBeat->LengthInSamples(), mBeatData.mBeat->GetPlayPosition());
+      DrawAudioBuffer(100, 35, mBeatData.mBeat->GetPeaks(), 0, mBeatData.mBeat->LengthInSamples(), mBeatData.mBeat->GetPlayPosition());
       ofPopMatrix();
    }
    mFilterSlider->SetPosition(x,y+40);
@@ -9,6 +9,13 @@
 */
 
 #include "ChannelBuffer.h"
+#include <atomic>
+
+namespace
+{
+   std::atomic<bool> sHoldFrees(false);
+   std::atomic<float*> sHeldFrees[ChannelBuffer::kMaxHeldFrees];
+}
 
 ChannelBuffer::ChannelBuffer(int bufferSize)
 {
@@ -118,7 +125,7 @@ void ChannelBuffer::CopyFrom(ChannelBuffer* src, int length /*= -1*/)
       }
       else
       {
-         delete mBuffers[i];
+         FreeChannelData(mBuffers[i]);
          mBuffers[i] = nullptr;
       }
    }
@@ -127,10 +134,42 @@ void ChannelBuffer::CopyFrom(ChannelBuffer* src, int length /*= -1*/)
 void ChannelBuffer::SetChannelPointer(float* data, int channel, bool deleteOldData)
 {
    if (deleteOldData)
-      delete[] mBuffers[channel];
+      FreeChannelData(mBuffers[channel]);
    mBuffers[channel] = data;
 }
 
+//static
+void ChannelBuffer::FreeChannelData(float* data)
+{
+   if (data == nullptr)
+      return;
+   
+   if (sHoldFrees.load())
+   {
+      for (int i=0; i<kMaxHeldFrees; ++i)
+      {
+         float* expected = nullptr;
+         if (sHeldFrees[i].compare_exchange_strong(expected, data))
+            return;
+      }
+      return;  //out of room. leaking it is better than freeing something a save is still reading
+   }
+   
+   delete[] data;
+}
+
+//static
+void ChannelBuffer::HoldFrees(bool hold)
+{
+   sHoldFrees.store(hold);
+   if (!hold)
+   {
+      //anything that saw the hold just before it was let go gets freed the next time around
+      for (int i=0; i<kMaxHeldFrees; ++i)
+         delete[] sHeldFrees[i].exchange(nullptr);
+   }
+}
+
 void ChannelBuffer::Resize(int bufferSize)
 {
    assert(mOwnsBuffers);
@@ -37,10 +37,16 @@ public:
    void Save(FileStreamOut& out, int writeLength);
    void Load(FileStreamIn& in, int &readLength);
    
+   //main thread. while held, channel data that gets swapped out is kept alive instead of freed,
+   //so a save that only referenced it can still copy it. letting go frees whatever was held
+   static void HoldFrees(bool hold);
+   
    static const int kMaxNumChannels = 2;
+   static const int kMaxHeldFrees = 256;
    
 private:
    void Setup(int bufferSize);
+   static void FreeChannelData(float* data);   //any thread
    
    int mActiveChannels;
    int mNumChannels;
@@ -269,7 +269,7 @@ void ClipLauncher::SampleData::Draw()
 {
    ofPushMatrix();
    ofTranslate(5, mClipLauncher->GetRowY(mIndex));
-   DrawAudioBuffer(100, 36, mSample->Data(), 0, mSample->LengthInSamples(), mPlay ? mSample->GetPlayPosition() : -1);
+   DrawAudioBuffer(100, 36, mSample->GetPeaks(), 0, mSample->LengthInSamples(), mPlay ? mSample->GetPlayPosition() : -1);
    ofPopMatrix();
    mGrabCheckbox->Draw();
    mPlayCheckbox->Draw();
@@ -0,0 +1,215 @@
+/*
+  ==============================================================================
+
+    ConvolutionEffect.cpp
+    Created: 18 Oct 2026 12:31:09am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "ConvolutionEffect.h"
+#include "SynthGlobals.h"
+#include "Profiler.h"
+
+namespace
+{
+   //band-limited resampling for the impulse response. it's only done once per load, so it can afford a long,
+   //well-windowed kernel. going down in rate, the kernel gets stretched so it also filters out whatever won't fit
+   void ResampleIR(const float* in, int inLength, float* out, int outLength, double ratio)
+   {
+      const int kZeroCrossings = 16;
+      double cutoff = MIN(1.0, 1 / ratio);
+      double halfWidth = kZeroCrossings / cutoff;
+      for (int i=0; i<outLength; ++i)
+      {
+         double pos = i * ratio;
+         int first = MAX(int(ceil(pos - halfWidth)), 0);
+         int last = MIN(int(floor(pos + halfWidth)), inLength-1);
+         double sum = 0;
+         for (int k=first; k<=last; ++k)
+         {
+            double x = pos - k;
+            double sinc = x == 0 ? 1 : sin(PI * cutoff * x) / (PI * cutoff * x);
+            double window = .42 + .5 * cos(PI * x / halfWidth) + .08 * cos(2 * PI * x / halfWidth);  //blackman
+            sum += in[k] * sinc * window;
+         }
+         out[i] = float(sum * cutoff);
+      }
+   }
+}
+
+ConvolutionEffect::ConvolutionEffect()
+: mLoadingIR(false)
+, mEngine(nullptr)
+, mDry(1)
+, mWet(.3f)
+, mDrySlider(nullptr)
+, mWetSlider(nullptr)
+{
+}
+
+ConvolutionEffect::~ConvolutionEffect()
+{
+   delete mEngine;
+}
+
+void ConvolutionEffect::CreateUIControls()
+{
+   IDrawableModule::CreateUIControls();
+   mDrySlider = new FloatSlider(this,"dry",5,4,110,15,&mDry,0,1);
+   mWetSlider = new FloatSlider(this,"wet",5,20,110,15,&mWet,0,1);
+}
+
+void ConvolutionEffect::ProcessAudio(double time, ChannelBuffer* buffer)
+{
+   Profiler profiler("ConvolutionEffect");
+   
+   if (!mEnabled)
+      return;
+   
+   ComputeSliders(0);
+   
+   //the main thread only holds the lock for as long as it takes to swap engines, so if we miss it, just play dry this block
+   bool processed = false;
+   if (mEngineMutex.try_lock())
+   {
+      if (mEngine != nullptr)
+      {
+         mEngine->Process(buffer, mDry, mWet);
+         processed = true;
+      }
+      mEngineMutex.unlock();
+   }
+   
+   if (!processed)
+   {
+      for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
+         Mult(buffer->GetChannel(ch), mDry, buffer->BufferSize());
+   }
+}
+
+void ConvolutionEffect::Poll()
+{
+   if (mLoadingIR && !mIR.IsLoading())
+   {
+      mLoadingIR = false;
+      BuildEngine();
+   }
+}
+
+void ConvolutionEffect::LoadIR(string path)
+{
+   mModuleSaveData.SetString("ir", path);
+   mIR.ReadAsync(path.c_str());
+   mLoadingIR = true;
+}
+
+//runs on the main thread. the response is resampled to the current rate and normalized to unit energy,
+//so different rooms come out at about the same loudness
+void ConvolutionEffect::BuildEngine()
+{
+   ConvolutionEngine* engine = nullptr;
+   
+   ChannelBuffer* data = mIR.Data();
+   float sampleRateRatio = mIR.GetSampleRateRatio();
+   int numChannels = MIN(mIR.NumChannels(), int(ChannelBuffer::kMaxNumChannels));
+   int inLength = mIR.LengthInSamples();
+   int length = MIN(int(inLength / sampleRateRatio), int(kMaxIRSeconds * gSampleRate));
+   if (inLength > 0 && length > 0)
+   {
+      vector<float> ir[ChannelBuffer::kMaxNumChannels];
+      const float* irChannels[ChannelBuffer::kMaxNumChannels];
+      double energy = 0;
+      for (int ch=0; ch<numChannels; ++ch)
+      {
+         const float* in = data->GetChannel(ch);
+         ir[ch].resize(length);
+         if (sampleRateRatio == 1)
+            BufferCopy(ir[ch].data(), in, length);
+         else
+            ResampleIR(in, inLength, ir[ch].data(), length, sampleRateRatio);
+         for (int i=0; i<length; ++i)
+            energy += ir[ch][i] * ir[ch][i];
+         irChannels[ch] = ir[ch].data();
+      }
+      
+      if (energy > 0)
+      {
+         float gain = 1 / sqrtf(energy / numChannels);
+         for (int ch=0; ch<numChannels; ++ch)
+            Mult(ir[ch].data(), gain, length);
+      }
+      
+      engine = new ConvolutionEngine(irChannels, numChannels, length);
+   }
+   
+   mEngineMutex.lock();
+   ConvolutionEngine* oldEngine = mEngine;
+   mEngine = engine;
+   mEngineMutex.unlock();
+   delete oldEngine;
+}
+
+void ConvolutionEffect::FilesDropped(vector<string> files, int x, int y)
+{
+   LoadIR(files[0]);
+}
+
+void ConvolutionEffect::DrawModule()
+{
+   if (!mEnabled)
+      return;
+   
+   mDrySlider->Draw();
+   mWetSlider->Draw();
+   
+   string status;
+   if (mLoadingIR)
+      status = "loading...";
+   else if (mEngine != nullptr)
+      status = string(mIR.Name()) + " " + ofToString(float(mEngine->GetIRLength()) / gSampleRate, 2) + "s";
+   else if (mModuleSaveData.GetString("ir") != "")
+      status = "couldn't load ir";
+   else
+      status = "drop an ir here";
+   DrawText(status, 5, 48, 11);
+}
+
+void ConvolutionEffect::GetModuleDimensions(int& width, int& height)
+{
+   if (mEnabled)
+   {
+      width = 120;
+      height = 54;
+   }
+   else
+   {
+      width = 120;
+      height = 0;
+   }
+}
+
+float ConvolutionEffect::GetEffectAmount()
+{
+   if (!mEnabled || mEngine == nullptr)
+      return 0;
+   return mWet;
+}
+
+void ConvolutionEffect::LoadLayout(const ofxJSONElement& moduleInfo)
+{
+   mModuleSaveData.LoadString("ir", moduleInfo);
+}
+
+void ConvolutionEffect::SetUpFromSaveData()
+{
+   string path = mModuleSaveData.GetString("ir");
+   if (path != "")
+      LoadIR(path);
+}
+
+void ConvolutionEffect::SaveLayout(ofxJSONElement& moduleInfo)
+{
+   mModuleSaveData.Save(moduleInfo);
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    ConvolutionEffect.h
+    Created: 18 Oct 2026 12:31:09am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "IAudioEffect.h"
+#include "Slider.h"
+#include "Sample.h"
+#include "ConvolutionEngine.h"
+
+//reverb (or a cabinet, or anything else) from a recorded impulse response. drop a sound file on it to load one
+class ConvolutionEffect : public IAudioEffect, public IFloatSliderListener
+{
+public:
+   ConvolutionEffect();
+   ~ConvolutionEffect();
+   
+   static IAudioEffect* Create() { return new ConvolutionEffect(); }
+   
+   string GetTitleLabel() override { return "convolution"; }
+   void CreateUIControls() override;
+   void Poll() override;
+   
+   //IAudioEffect
+   void ProcessAudio(double time, ChannelBuffer* buffer) override;
+   void SetEnabled(bool enabled) override { mEnabled = enabled; }
+   float GetEffectAmount() override;
+   string GetType() override { return "convolution"; }
+   
+   void FilesDropped(vector<string> files, int x, int y) override;
+   void FloatSliderUpdated(FloatSlider* slider, float oldVal) override {}
+   
+   void LoadLayout(const ofxJSONElement& moduleInfo) override;
+   void SetUpFromSaveData() override;
+   void SaveLayout(ofxJSONElement& moduleInfo) override;
+   
+   static const int kMaxIRSeconds = 20;
+   
+private:
+   //IDrawableModule
+   void DrawModule() override;
+   void GetModuleDimensions(int& x, int& y) override;
+   bool Enabled() const override { return mEnabled; }
+   
+   void LoadIR(string path);
+   void BuildEngine();
+   
+   Sample mIR;
+   bool mLoadingIR;
+   ConvolutionEngine* mEngine;
+   ofMutex mEngineMutex;   //only held to swap engines, and only ever tried from the audio thread
+   float mDry;
+   float mWet;
+   FloatSlider* mDrySlider;
+   FloatSlider* mWetSlider;
+};
@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    ConvolutionEngine.cpp
+    Created: 17 Oct 2026 11:48:36pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "ConvolutionEngine.h"
+#include "SynthGlobals.h"
+
+namespace
+{
+   const int kBlocksPerTailBlock = ConvolutionEngine::kTailBlockSize / ConvolutionEngine::kBlockSize;
+}
+
+ConvolutionEngine::ConvolutionEngine(const float* const* ir, int numIRChannels, int irLength)
+: juce::Thread("convolution tail")
+, mIRLength(irLength)
+, mBlockPos(0)
+, mBlockCount(0)
+, mTailNumChannels(0)
+, mTailRequested(-1)
+, mTailFinished(-1)
+, mNumLateTailBlocks(0)
+, mTailLate(false)
+{
+   for (int slot=0; slot<2; ++slot)
+      mSkippedTail[slot].store(-1);
+   
+   for (int ch=0; ch<ChannelBuffer::kMaxNumChannels; ++ch)
+   {
+      const float* channelIR = ir[MIN(ch, numIRChannels-1)];
+      mInputBlock[ch].resize(kBlockSize);
+      mOutputBlock[ch].resize(kBlockSize);
+      mHeads.add(new Stage(kBlockSize, channelIR, MIN(irLength, kHeadLength)));
+      if (irLength > kHeadLength)
+      {
+         mTails.add(new Stage(kTailBlockSize, channelIR + kHeadLength, irLength - kHeadLength));
+         for (int slot=0; slot<2; ++slot)
+         {
+            mTailInput[slot][ch].resize(kTailBlockSize);
+            mTailOutput[slot][ch].resize(kTailBlockSize);
+         }
+      }
+   }
+   mSilence.resize(kTailBlockSize);
+
+   if (mTails.size() > 0)
+      startThread(8);
+}
+
+ConvolutionEngine::~ConvolutionEngine()
+{
+   if (mTails.size() > 0)
+   {
+      signalThreadShouldExit();
+      mTailWake.signal();
+      stopThread(-1);
+   }
+}
+
+void ConvolutionEngine::Process(ChannelBuffer* buffer, float dry, float wet)
+{
+   int numChannels = MIN(buffer->NumActiveChannels(), int(ChannelBuffer::kMaxNumChannels));
+   int bufferSize = buffer->BufferSize();
+
+   //blocks don't line up with buffers, so everything comes out one block late
+   int done = 0;
+   while (done < bufferSize)
+   {
+      int numSamples = MIN(bufferSize - done, kBlockSize - mBlockPos);
+      for (int ch=0; ch<numChannels; ++ch)
+      {
+         float* channel = buffer->GetChannel(ch) + done;
+         const float* output = mOutputBlock[ch].data() + mBlockPos;
+         BufferCopy(mInputBlock[ch].data() + mBlockPos, channel, numSamples);
+         for (int i=0; i<numSamples; ++i)
+            channel[i] = channel[i] * dry + output[i] * wet;
+      }
+
+      done += numSamples;
+      mBlockPos += numSamples;
+      if (mBlockPos == kBlockSize)
+      {
+         ProcessBlock(numChannels);
+         mBlockPos = 0;
+      }
+   }
+}
+
+void ConvolutionEngine::ProcessBlock(int numChannels)
+{
+   int64 tailBlock = mBlockCount / kBlocksPerTailBlock;
+   int blockInTail = int(mBlockCount % kBlocksPerTailBlock);
+   int slot = int(tailBlock % 2);
+   bool hasTail = mTails.size() > 0;
+
+   if (hasTail && blockInTail == 0)
+   {
+      //the worker should have had plenty of time, but if it's still going it's using this slot, so leave it alone:
+      //the tail drops out for this tail block, and this block's input goes to the tail as silence
+      mTailLate = tailBlock >= 2 && mTailFinished.load(std::memory_order_acquire) < tailBlock-2;
+      if (mTailLate)
+         mNumLateTailBlocks.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   for (int ch=0; ch<ChannelBuffer::kMaxNumChannels; ++ch)
+   {
+      float* output = mOutputBlock[ch].data();
+      if (ch >= numChannels)
+      {
+         Clear(output, kBlockSize);
+         continue;
+      }
+
+      mHeads[ch]->Process(mInputBlock[ch].data(), output);
+      if (hasTail && !mTailLate)
+      {
+         Add(output, mTailOutput[slot][ch].data() + blockInTail * kBlockSize, kBlockSize);
+         BufferCopy(mTailInput[slot][ch].data() + blockInTail * kBlockSize, mInputBlock[ch].data(), kBlockSize);
+      }
+   }
+
+   if (hasTail && blockInTail == kBlocksPerTailBlock-1)
+   {
+      //this tail block's input is complete. its output is due two tail blocks from now, once the head has run out
+      mTailNumChannels.store(numChannels, std::memory_order_relaxed);
+      if (mTailLate)
+         mSkippedTail[slot].store(tailBlock, std::memory_order_relaxed);
+      mTailRequested.store(tailBlock, std::memory_order_release);
+      mTailWake.signal();
+   }
+
+   ++mBlockCount;
+}
+
+void ConvolutionEngine::run()
+{
+   while (!threadShouldExit())
+   {
+      int64 next = mTailFinished.load(std::memory_order_relaxed) + 1;
+      if (next > mTailRequested.load(std::memory_order_acquire))
+      {
+         mTailWake.wait(50);
+         continue;
+      }
+
+      int slot = int(next % 2);
+      int numChannels = mTailNumChannels.load(std::memory_order_relaxed);
+      bool skipped = mSkippedTail[slot].load(std::memory_order_relaxed) == next;
+      for (int ch=0; ch<mTails.size(); ++ch)
+      {
+         if (ch < numChannels)
+            mTails[ch]->Process(skipped ? mSilence.data() : mTailInput[slot][ch].data(), mTailOutput[slot][ch].data());
+         else
+            Clear(mTailOutput[slot][ch].data(), kTailBlockSize);
+      }
+
+      mTailFinished.store(next, std::memory_order_release);
+   }
+}
+
+ConvolutionEngine::Stage::Stage(int blockSize, const float* ir, int irLength)
+: mBlockSize(blockSize)
+, mNumBins(blockSize + 1)
+, mNumPartitions(MAX(1, (irLength + blockSize - 1) / blockSize))
+, mFFT(blockSize * 2)
+, mPartitionsRe(mNumPartitions * mNumBins)
+, mPartitionsIm(mNumPartitions * mNumBins)
+, mDelayLineRe(mNumPartitions * mNumBins)
+, mDelayLineIm(mNumPartitions * mNumBins)
+, mDelayLinePos(0)
+, mInput(blockSize * 2)
+, mAccumRe(mNumBins)
+, mAccumIm(mNumBins)
+, mTimeDomain(blockSize * 2)
+{
+   //each partition is zero padded to twice its length. the inverse fft's scaling gets folded in here too
+   float scale = 1.0f / (blockSize * 2);
+   for (int p=0; p<mNumPartitions; ++p)
+   {
+      Clear(mTimeDomain.data(), blockSize * 2);
+      int start = p * blockSize;
+      int length = MAX(0, MIN(blockSize, irLength - start));
+      for (int i=0; i<length; ++i)
+         mTimeDomain[i] = ir[start + i] * scale;
+      mFFT.Forward(mTimeDomain.data(), &mPartitionsRe[p * mNumBins], &mPartitionsIm[p * mNumBins]);
+   }
+}
+
+void ConvolutionEngine::Stage::Process(const float* input, float* output)
+{
+   //overlap-save: transform the last two blocks, and keep the second half of the circular convolution
+   BufferCopy(mInput.data(), mInput.data() + mBlockSize, mBlockSize);
+   BufferCopy(mInput.data() + mBlockSize, input, mBlockSize);
+   mFFT.Forward(mInput.data(), &mDelayLineRe[mDelayLinePos * mNumBins], &mDelayLineIm[mDelayLinePos * mNumBins]);
+
+   float* accumRe = mAccumRe.data();
+   float* accumIm = mAccumIm.data();
+   Clear(accumRe, mNumBins);
+   Clear(accumIm, mNumBins);
+   for (int p=0; p<mNumPartitions; ++p)
+   {
+      int block = (mDelayLinePos - p + mNumPartitions) % mNumPartitions;
+      const float* xRe = &mDelayLineRe[block * mNumBins];
+      const float* xIm = &mDelayLineIm[block * mNumBins];
+      const float* hRe = &mPartitionsRe[p * mNumBins];
+      const float* hIm = &mPartitionsIm[p * mNumBins];
+      for (int i=0; i<mNumBins; ++i)
+      {
+         accumRe[i] += xRe[i] * hRe[i] - xIm[i] * hIm[i];
+         accumIm[i] += xRe[i] * hIm[i] + xIm[i] * hRe[i];
+      }
+   }
+
+   mFFT.Inverse(accumRe, accumIm, mTimeDomain.data());
+   BufferCopy(output, mTimeDomain.data() + mBlockSize, mBlockSize);
+
+   mDelayLinePos = (mDelayLinePos + 1) % mNumPartitions;
+}
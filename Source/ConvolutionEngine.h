@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    ConvolutionEngine.h
+    Created: 17 Oct 2026 11:48:36pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include "ChannelBuffer.h"
+#include "FFT.h"
+#include <atomic>
+
+//convolves audio with an impulse response using partitioned FFT convolution.
+//the start of the response runs in small partitions on the audio thread, which sets the latency, and the rest runs in
+//large partitions on a worker thread. a tail block only has to be ready two blocks after its input arrives, so the
+//worker always has a whole block's worth of time to get it done. if it still doesn't, the tail drops out rather than
+//holding up the audio thread
+class ConvolutionEngine : private juce::Thread
+{
+public:
+   ConvolutionEngine(const float* const* ir, int numIRChannels, int irLength);   //the response is copied, in any thread but the audio one
+   ~ConvolutionEngine();
+
+   void Process(ChannelBuffer* buffer, float dry, float wet);   //audio thread, replaces the buffer with the mix
+
+   int GetIRLength() const { return mIRLength; }
+   int GetLatency() const { return kBlockSize; }
+   int GetNumLateTailBlocks() const { return mNumLateTailBlocks.load(std::memory_order_relaxed); }
+
+   static const int kBlockSize = 128;
+   static const int kTailBlockSize = 2048;   //must be a multiple of kBlockSize
+   static const int kHeadLength = kTailBlockSize * 2;   //how much of the response the audio thread handles
+
+private:
+   //one uniformly partitioned overlap-save convolution, with a delay line of past input spectra
+   class Stage
+   {
+   public:
+      Stage(int blockSize, const float* ir, int irLength);
+      void Process(const float* input, float* output);   //one block in, that block's output out
+   private:
+      int mBlockSize;
+      int mNumBins;
+      int mNumPartitions;
+      ::FFT mFFT;
+      vector<float> mPartitionsRe;   //spectrum of each partition of the response, one after another
+      vector<float> mPartitionsIm;
+      vector<float> mDelayLineRe;   //spectra of the last mNumPartitions input blocks
+      vector<float> mDelayLineIm;
+      int mDelayLinePos;
+      vector<float> mInput;   //the previous block and this one
+      vector<float> mAccumRe;
+      vector<float> mAccumIm;
+      vector<float> mTimeDomain;
+   };
+
+   void ProcessBlock(int numChannels);
+   void run() override;
+
+   int mIRLength;
+   int mBlockPos;
+   int64 mBlockCount;
+   vector<float> mInputBlock[ChannelBuffer::kMaxNumChannels];
+   vector<float> mOutputBlock[ChannelBuffer::kMaxNumChannels];
+   OwnedArray<Stage> mHeads;
+
+   OwnedArray<Stage> mTails;
+   vector<float> mTailInput[2][ChannelBuffer::kMaxNumChannels];   //alternates every tail block, the worker reads one while the next one fills
+   vector<float> mTailOutput[2][ChannelBuffer::kMaxNumChannels];
+   std::atomic<int> mTailNumChannels;
+   std::atomic<int64> mTailRequested;
+   std::atomic<int64> mTailFinished;
+   std::atomic<int> mNumLateTailBlocks;
+   bool mTailLate;   //the worker hadn't finished with this tail block's slot when it started
+   std::atomic<int64> mSkippedTail[2];   //the last tail block in each slot whose input never got written
+   vector<float> mSilence;
+   WaitableEvent mTailWake;
+};
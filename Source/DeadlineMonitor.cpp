@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    DeadlineMonitor.cpp
+    Created: 17 Oct 2026 6:12:48pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "DeadlineMonitor.h"
+#include "Profiler.h"
+#include "ModularSynth.h"
+
+DeadlineMonitor* TheDeadlineMonitor = nullptr;
+
+static_assert(DeadlineMonitor::kMaxScopes == Profiler::kMaxNames, "overrun counts are indexed by profiler scope");
+
+namespace
+{
+   const float kNearMissFraction = .7f;  //same margin Profiler::GetSafeFrameLengthMicroseconds() uses
+}
+
+DeadlineMonitor::DeadlineMonitor()
+: mLastStartTicks(0)
+, mNumCallbacks(0)
+, mNumOverruns(0)
+, mNumNearMisses(0)
+, mWorstDuration(0)
+, mWorstDurationScope(-1)
+, mResetRequested(false)
+{
+   for (int i=0; i<kMaxScopes; ++i)
+      mOverrunScopeCounts[i] = 0;
+}
+
+void DeadlineMonitor::RecordCallback(int64 startTicks, int64 endTicks, int heaviestScope)
+{
+   if (mResetRequested.exchange(false))
+   {
+      mDuration.Clear();
+      mJitter.Clear();
+      mLastStartTicks = 0;
+      mNumCallbacks = 0;
+      mNumOverruns = 0;
+      mNumNearMisses = 0;
+      mWorstDuration = 0;
+      mWorstDurationScope = -1;
+      for (int i=0; i<kMaxScopes; ++i)
+         mOverrunScopeCounts[i] = 0;
+   }
+   
+   double budgetTicks = Time::getHighResolutionTicksPerSecond() * double(gBufferSize) / gSampleRate;
+   float duration = float((endTicks - startTicks) / budgetTicks);
+   
+   mDuration.Add(duration);
+   if (mLastStartTicks != 0)
+      mJitter.Add(fabsf(float((startTicks - mLastStartTicks) / budgetTicks) - 1));
+   mLastStartTicks = startTicks;
+   
+   ++mNumCallbacks;
+   if (duration > 1)
+   {
+      ++mNumOverruns;
+      if (heaviestScope >= 0 && heaviestScope < kMaxScopes)
+         ++mOverrunScopeCounts[heaviestScope];
+   }
+   else if (duration > kNearMissFraction)
+   {
+      ++mNumNearMisses;
+   }
+   
+   if (duration > mWorstDuration)
+   {
+      mWorstDuration = duration;
+      mWorstDurationScope = heaviestScope;
+   }
+}
+
+vector<string> DeadlineMonitor::GetReport() const
+{
+   vector<string> report;
+   float budgetMs = gBufferSize * 1000.0f / gSampleRate;
+   
+   report.push_back("audio deadline: " + ofToString(budgetMs, 2) + "ms (" + ofToString(gBufferSize) + " samples at " + ofToString(gSampleRate) + "hz), " +
+                    ofToString((long)mNumCallbacks) + " callbacks");
+   report.push_back("callback time, % of budget over the last " + ofToString(int(kWindowLength)) + ": p50 " + ofToString(mDuration.GetPercentile(.5f)*100, 0) +
+                    "  p90 " + ofToString(mDuration.GetPercentile(.9f)*100, 0) +
+                    "  p99 " + ofToString(mDuration.GetPercentile(.99f)*100, 0) +
+                    "  p99.9 " + ofToString(mDuration.GetPercentile(.999f)*100, 0) +
+                    "  max " + ofToString(mDuration.GetMax()*100, 0));
+   report.push_back("callback jitter, % of budget: p50 " + ofToString(mJitter.GetPercentile(.5f)*100, 0) +
+                    "  p99 " + ofToString(mJitter.GetPercentile(.99f)*100, 0) +
+                    "  max " + ofToString(mJitter.GetMax()*100, 0));
+   
+   string overruns = "overruns: " + ofToString((long)mNumOverruns) + ", near misses (>" + ofToString(int(kNearMissFraction*100)) + "%): " + ofToString((long)mNumNearMisses);
+   AudioIODevice* device = TheSynth ? TheSynth->GetGlobalManagers()->mDeviceManager.getCurrentAudioDevice() : nullptr;
+   if (device != nullptr && device->getXRunCount() >= 0)
+      overruns += ", device xruns: " + ofToString(device->getXRunCount());
+   report.push_back(overruns);
+   
+   const char* worstScope = Profiler::GetScopeName(mWorstDurationScope);
+   report.push_back("worst callback: " + ofToString(mWorstDuration*100, 0) + "% of budget" +
+                    (worstScope ? string(", heaviest scope ") + worstScope : ""));
+   
+   if (!Profiler::IsEnabled())
+      report.push_back("scopes are only timed while the profiler is on, toggle it with 'profiler' to see which ones overran");
+   
+   vector< pair<int, string> > blame;
+   for (int i=0; i<kMaxScopes; ++i)
+   {
+      int count = mOverrunScopeCounts[i];
+      const char* name = Profiler::GetScopeName(i);
+      if (count > 0 && name != nullptr)
+         blame.push_back(make_pair(count, string(name)));
+   }
+   if (!blame.empty())
+   {
+      sort(blame.rbegin(), blame.rend());
+      string blameLine = "heaviest scope during overruns:";
+      for (int i=0; i<MIN((int)blame.size(), 5); ++i)
+         blameLine += " " + blame[i].second + " (" + ofToString(blame[i].first) + ")";
+      report.push_back(blameLine);
+   }
+   
+   return report;
+}
+
+DeadlineMonitor::RollingHistogram::RollingHistogram()
+{
+   Clear();
+}
+
+void DeadlineMonitor::RollingHistogram::Add(float fractionOfBudget)
+{
+   int bucket = int(ofClamp(fractionOfBudget * 100, 0, kNumBuckets-1));
+   
+   if (mNumValues == kWindowLength)
+      --mCounts[mWindow[mWindowPos]];
+   else
+      ++mNumValues;
+   
+   mWindow[mWindowPos] = bucket;
+   ++mCounts[bucket];
+   mWindowPos = (mWindowPos + 1) % kWindowLength;
+}
+
+void DeadlineMonitor::RollingHistogram::Clear()
+{
+   for (int i=0; i<kNumBuckets; ++i)
+      mCounts[i] = 0;
+   mNumValues = 0;
+   mWindowPos = 0;
+}
+
+//reads the counts while the audio thread may still be adding to them, so it's only as exact as a ui needs
+float DeadlineMonitor::RollingHistogram::GetPercentile(float percentile) const
+{
+   int numValues = mNumValues;
+   if (numValues == 0)
+      return 0;
+   
+   int target = int(percentile * numValues);
+   int seen = 0;
+   for (int i=0; i<kNumBuckets; ++i)
+   {
+      seen += mCounts[i];
+      if (seen > target)
+         return (i + 1) / 100.0f;   //upper edge of the bucket
+   }
+   return kNumBuckets / 100.0f;
+}
+
+float DeadlineMonitor::RollingHistogram::GetMax() const
+{
+   for (int i=kNumBuckets-1; i>=0; --i)
+   {
+      if (mCounts[i] > 0)
+         return (i + 1) / 100.0f;
+   }
+   return 0;
+}
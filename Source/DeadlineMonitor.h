@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    DeadlineMonitor.h
+    Created: 17 Oct 2026 6:12:48pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SynthGlobals.h"
+#include <atomic>
+
+//always-on record of how long each audio callback took against its deadline (gBufferSize / gSampleRate),
+//fed by the master Profiler scope in ModularSynth::AudioOut(). keeps rolling histograms of callback time
+//and callback spacing, counts overruns, and (while the profiler is on) remembers which scope was heaviest when one happened
+class DeadlineMonitor
+{
+public:
+   DeadlineMonitor();
+   
+   void RecordCallback(int64 startTicks, int64 endTicks, int heaviestScope);  //audio thread only
+   void Reset() { mResetRequested = true; }
+   
+   float GetPercentile(float percentile) const { return mDuration.GetPercentile(percentile); }  //fraction of budget
+   int64 GetNumOverruns() const { return mNumOverruns; }
+   vector<string> GetReport() const;
+   
+   static const int kWindowLength = 8192;  //callbacks
+   static const int kNumBuckets = 256;     //one percent of the budget each, the last one catches everything over
+   static const int kMaxScopes = 256;
+   
+private:
+   struct RollingHistogram
+   {
+      RollingHistogram();
+      void Add(float fractionOfBudget);
+      void Clear();
+      float GetPercentile(float percentile) const;
+      float GetMax() const;
+      
+      std::atomic<int> mCounts[kNumBuckets];
+      std::atomic<int> mNumValues;
+      unsigned char mWindow[kWindowLength];  //bucket of each value still in the window, so it can be taken back out
+      int mWindowPos;
+   };
+   
+   RollingHistogram mDuration;   //how long each callback took
+   RollingHistogram mJitter;     //how far the time between callbacks strayed from the buffer length
+   int64 mLastStartTicks;
+   std::atomic<int64> mNumCallbacks;
+   std::atomic<int64> mNumOverruns;
+   std::atomic<int64> mNumNearMisses;
+   std::atomic<float> mWorstDuration;
+   std::atomic<int> mWorstDurationScope;
+   std::atomic<int> mOverrunScopeCounts[kMaxScopes];
+   std::atomic<bool> mResetRequested;
+};
+
+extern DeadlineMonitor* TheDeadlineMonitor;
@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    DiskRecorder.cpp
+    Created: 17 Oct 2026 8:14:05pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "DiskRecorder.h"
+#include "SynthGlobals.h"
+
+DiskRecorder::DiskRecorder()
+: juce::Thread("disk recorder")
+, mRing(kRingLength)
+, mNumChannels(0)
+, mSampleRate(gSampleRate)
+, mCapturing(false)
+, mNumWritersInside(0)
+, mWritePos(0)
+, mReadPos(0)
+, mFramesWritten(0)
+, mNumDroppedBlocks(0)
+{
+}
+
+DiskRecorder::~DiskRecorder()
+{
+   Stop();
+}
+
+bool DiskRecorder::Start(string path, int numChannels)
+{
+   Stop();
+
+   File outputFile(ofToDataPath(path));
+   outputFile.getParentDirectory().createDirectory();
+   outputFile.deleteFile();
+   FileOutputStream* outputTo = outputFile.createOutputStream();
+   if (outputTo == nullptr)
+      return false;
+
+   numChannels = MIN(numChannels, int(ChannelBuffer::kMaxNumChannels));
+   WavAudioFormat wavFormat;
+   mWriter = wavFormat.createWriterFor(outputTo, gSampleRate, numChannels, 16, StringPairArray(), 0);
+   if (mWriter == nullptr)
+   {
+      delete outputTo;
+      return false;
+   }
+
+   mPath = path;
+   mNumChannels = numChannels;
+   mSampleRate = gSampleRate;
+   mRing.SetNumActiveChannels(numChannels);
+   for (int ch=0; ch<numChannels; ++ch)
+      mRing.GetChannel(ch);   //channels get allocated on first use, get that out of the way before the audio thread touches them
+   mWritePos.store(0, std::memory_order_relaxed);
+   mReadPos.store(0, std::memory_order_relaxed);
+   mFramesWritten.store(0, std::memory_order_relaxed);
+   mNumDroppedBlocks.store(0, std::memory_order_relaxed);
+
+   startThread(4);
+   mCapturing.store(true, std::memory_order_release);
+   return true;
+}
+
+void DiskRecorder::Stop()
+{
+   if (mWriter == nullptr)
+      return;
+
+   //these, and the pair in Write(), are each a store then a load of the other variable, so they need to be seq_cst:
+   //either we see the writer inside, or it sees that we've stopped
+   mCapturing.store(false, std::memory_order_seq_cst);
+   while (mNumWritersInside.load(std::memory_order_seq_cst) > 0)
+      juce::Thread::yield();   //the audio thread is mid-block, it'll be done in a moment
+
+   signalThreadShouldExit();
+   mWake.signal();
+   stopThread(-1);
+
+   while (Drain()) {}   //the writer thread is gone, so the rest of the ring is ours
+   mWriter = nullptr;   //deleting the writer fills in the wav header and closes the file
+}
+
+void DiskRecorder::Write(float* const* data, int numChannels, int numFrames)
+{
+   if (!mCapturing.load(std::memory_order_acquire))
+      return;
+
+   mNumWritersInside.fetch_add(1, std::memory_order_seq_cst);
+   if (mCapturing.load(std::memory_order_seq_cst))
+   {
+      int64 writePos = mWritePos.load(std::memory_order_relaxed);
+      int64 readPos = mReadPos.load(std::memory_order_acquire);
+      if (writePos + numFrames - readPos > kRingLength)
+      {
+         //the disk has fallen too far behind. drop this block rather than wait on it
+         mNumDroppedBlocks.fetch_add(1, std::memory_order_relaxed);
+      }
+      else
+      {
+         int ringPos = int(writePos & (kRingLength-1));
+         int firstPart = MIN(numFrames, kRingLength - ringPos);
+         for (int ch=0; ch<mNumChannels; ++ch)
+         {
+            const float* src = data[MIN(ch, numChannels-1)];
+            BufferCopy(mRing.GetChannel(ch) + ringPos, src, firstPart);
+            if (firstPart < numFrames)
+               BufferCopy(mRing.GetChannel(ch), src + firstPart, numFrames - firstPart);
+         }
+         mWritePos.store(writePos + numFrames, std::memory_order_release);
+      }
+   }
+   mNumWritersInside.fetch_sub(1, std::memory_order_release);
+}
+
+void DiskRecorder::run()
+{
+   while (!threadShouldExit())
+   {
+      if (!Drain())
+         mWake.wait(20);
+   }
+}
+
+bool DiskRecorder::Drain()
+{
+   int64 readPos = mReadPos.load(std::memory_order_relaxed);
+   int64 available = mWritePos.load(std::memory_order_acquire) - readPos;
+   if (available <= 0)
+      return false;
+
+   //write up to the end of the ring, a wrap gets picked up by the next call
+   int ringPos = int(readPos & (kRingLength-1));
+   int numFrames = (int)MIN(available, int64(kWriteBlock));
+   numFrames = MIN(numFrames, kRingLength - ringPos);
+
+   const float* channels[ChannelBuffer::kMaxNumChannels];
+   for (int ch=0; ch<mNumChannels; ++ch)
+      channels[ch] = mRing.GetChannel(ch) + ringPos;
+   mWriter->writeFromFloatArrays(channels, mNumChannels, numFrames);
+
+   mReadPos.store(readPos + numFrames, std::memory_order_release);
+   mFramesWritten.fetch_add(numFrames, std::memory_order_relaxed);
+   return true;
+}
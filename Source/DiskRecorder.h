@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    DiskRecorder.h
+    Created: 17 Oct 2026 8:14:05pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include "ChannelBuffer.h"
+#include <atomic>
+
+//streams audio to a wav file as it comes in.
+//the audio thread drops blocks into a ring without ever locking, and a writer thread empties the ring to disk,
+//so a recording can run for as long as there's disk space without holding it all in memory
+class DiskRecorder : private juce::Thread
+{
+public:
+   DiskRecorder();
+   ~DiskRecorder();
+
+   bool Start(string path, int numChannels);   //main thread
+   void Stop();   //main thread, writes out whatever is still in the ring and closes the file
+   bool IsRecording() const { return mCapturing.load(std::memory_order_acquire); }
+   const string& GetPath() const { return mPath; }
+
+   void Write(float* const* data, int numChannels, int numFrames);   //audio thread, never blocks
+
+   float GetRecordedSeconds() const { return float(mFramesWritten.load(std::memory_order_relaxed) / mSampleRate); }
+   int GetNumDroppedBlocks() const { return mNumDroppedBlocks.load(std::memory_order_relaxed); }
+
+   static const int kRingLength = 1 << 18;   //about six seconds of slack if the disk stalls
+   static const int kWriteBlock = 8192;
+
+private:
+   void run() override;
+   bool Drain();
+
+   ChannelBuffer mRing;
+   int mNumChannels;
+   double mSampleRate;
+   string mPath;
+   ScopedPointer<AudioFormatWriter> mWriter;
+   WaitableEvent mWake;
+
+   std::atomic<bool> mCapturing;
+   std::atomic<int> mNumWritersInside;   //audio thread calls to Write() in progress, so Stop() knows when it has the ring to itself
+   std::atomic<int64> mWritePos;   //only moved by the audio thread
+   std::atomic<int64> mReadPos;   //only moved by the writer
+   std::atomic<int64> mFramesWritten;
+   std::atomic<int> mNumDroppedBlocks;
+};
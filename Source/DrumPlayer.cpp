@@ -131,7 +131,7 @@ void DrumPlayer::LoadKit(int kit)
       mLoadingSamples = true;
       for (int i=0; i<NUM_DRUM_HITS; ++i)
       {
-         mDrumHits[i].mSample.Read(mKits[kit].mSampleFiles[i].c_str());
+         mDrumHits[i].mSample.ReadAsync(mKits[kit].mSampleFiles[i].c_str());
          mDrumHits[i].mLinkId = mKits[kit].mLinkIds[i];
          mDrumHits[i].mVol = mKits[kit].mVols[i];
          mDrumHits[i].mSpeed = mKits[kit].mSpeeds[i];
@@ -351,7 +351,7 @@ void DrumPlayer::FilesDropped(vector<string> files, int x, int y)
             {
                mLoadSamplesMutex.lock();
                mLoadingSamples = true;
-               mDrumHits[sampleIdx].mSample.Read(files[i].c_str());
+               mDrumHits[sampleIdx].mSample.ReadAsync(files[i].c_str());
                mLoadingSamples = false;
                mLoadSamplesMutex.unlock();
                mDrumHits[sampleIdx].mLinkId = sLoadId;
@@ -474,6 +474,12 @@ DrumSynth::DrumSynthHit::DrumSynthHit(DrumSynth* parent, int index, int x, int y
 , mX(x)
 , mY(y)
 {
+   mFreqAdsrBuffer = new float[kWorkBufferSize];
+}
+
+DrumSynth::DrumSynthHit::~DrumSynthHit()
+{
+   delete[] mFreqAdsrBuffer;
 }
 
 void DrumSynth::DrumSynthHit::CreateUIControls()
@@ -514,9 +520,12 @@ void DrumSynth::DrumSynthHit::Process(double time, float* out, int bufferSize)
       return;
    }
    
+   assert(bufferSize <= kWorkBufferSize);
+   mData.mFreqAdsr.Render(time, mFreqAdsrBuffer, bufferSize);
+   
    for (int i=0; i<bufferSize; ++i)
    {
-      float freq = mData.mFreqAdsr.Value(time) * mData.mFreq;
+      float freq = mFreqAdsrBuffer[i] * mData.mFreq;
       float phaseInc = GetPhaseInc(freq);
       
       float sample = mData.mTone.Audio(time, mPhase) * mData.mVol * mData.mVol;
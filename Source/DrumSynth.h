@@ -83,6 +83,7 @@ private:
    {
    public:
       DrumSynthHit(DrumSynth* parent, int index, int x, int y);
+      ~DrumSynthHit();
       
       void CreateUIControls();
       void Play(double time, float velocity);
@@ -92,6 +93,7 @@ private:
       
       DrumSynthHitSerialData mData;
       float mPhase;
+      float* mFreqAdsrBuffer;
       ADSRDisplay* mToneAdsrDisplay;
       ADSRDisplay* mFreqAdsrDisplay;
       ADSRDisplay* mNoiseAdsrDisplay;
@@ -152,6 +152,22 @@ void EffectChain::Poll()
    }
 }
 
+//hand the files to whichever effect they landed on
+void EffectChain::FilesDropped(vector<string> files, int x, int y)
+{
+   for (auto* effect : mEffects)
+   {
+      int effectX, effectY, w, h;
+      effect->GetPosition(effectX, effectY, true);
+      effect->GetDimensions(w, h);
+      if (x >= effectX && x < effectX + w && y >= effectY && y < effectY + h)
+      {
+         effect->FilesDropped(files, x - effectX, y - effectY);
+         break;
+      }
+   }
+}
+
 void EffectChain::DrawModule()
 {
 
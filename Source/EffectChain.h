@@ -43,6 +43,7 @@ public:
    
    void KeyPressed(int key, bool isRepeat) override;
    void KeyReleased(int key) override;
+   void FilesDropped(vector<string> files, int x, int y) override;
 
    void ButtonClicked(ClickButton* button) override;
    void CheckboxUpdated(Checkbox* checkbox) override;
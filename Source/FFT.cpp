@@ -7,20 +7,233 @@
 //
 
 #include "FFT.h"
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <cassert>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <xmmintrin.h>
+#define FFT_USE_SSE 1
+#else
+#define FFT_USE_SSE 0
+#endif
+
+// Twiddle factors for one size. Built once and never modified afterwards,
+// so any number of FFTs on any threads can read from the same plan
+struct FFTPlan
+{
+   FFTPlan(int nfft);
+
+   int mHalfSize;                  // the real transform runs as a complex one of half the size
+   std::vector<float> mStageRe;    // twiddles for each radix-4 pass, one pass after another
+   std::vector<float> mStageIm;
+   std::vector<float> mSplitRe;    // e^(-2*pi*i*k/nfft), to pull the real spectrum out of the half size one
+   std::vector<float> mSplitIm;
+};
+
+FFTPlan::FFTPlan(int nfft)
+: mHalfSize(nfft/2)
+{
+   const double kTwoPi = 6.283185307179586476925286766559;
+
+   // radix-4 passes take w^p, w^2p and w^3p, a trailing radix-2 pass (odd powers of two) doesn't need any
+   for (int len = mHalfSize; len >= 4; len /= 4)
+   {
+      for (int power=1; power<=3; ++power)
+      {
+         for (int p=0; p<len/4; ++p)
+         {
+            double angle = -kTwoPi * power * p / len;
+            mStageRe.push_back((float)cos(angle));
+            mStageIm.push_back((float)sin(angle));
+         }
+      }
+   }
+
+   for (int k=0; k<mHalfSize; ++k)
+   {
+      double angle = -kTwoPi * k / nfft;
+      mSplitRe.push_back((float)cos(angle));
+      mSplitIm.push_back((float)sin(angle));
+   }
+}
+
+namespace
+{
+   std::mutex sPlansMutex;
+   std::map<int, std::unique_ptr<FFTPlan> > sPlans;
+
+   const FFTPlan* GetPlan(int nfft)
+   {
+      std::lock_guard<std::mutex> lock(sPlansMutex);
+      std::unique_ptr<FFTPlan>& plan = sPlans[nfft];
+      if (plan == nullptr)
+         plan.reset(new FFTPlan(nfft));
+      return plan.get();
+   }
+
+   // Stockham autosort passes over split complex data, no bit reversal needed.
+   // Each pass reads x and writes y, then they trade places, so the result ends up in x.
+   // The inner loops run over contiguous memory so the compiler can vectorize them
+   void ComplexForward(const FFTPlan* plan, float*& xr, float*& xi, float*& yr, float*& yi)
+   {
+      const float* twiddleRe = plan->mStageRe.data();
+      const float* twiddleIm = plan->mStageIm.data();
+
+      int len = plan->mHalfSize;
+      int s = 1;
+      for (; len >= 4; len /= 4, s *= 4)
+      {
+         const int m = len/4;
+         const float* w1Re = twiddleRe;
+         const float* w1Im = twiddleIm;
+         const float* w2Re = twiddleRe + m;
+         const float* w2Im = twiddleIm + m;
+         const float* w3Re = twiddleRe + 2*m;
+         const float* w3Im = twiddleIm + 2*m;
+
+         if (s == 1)
+         {
+            // first pass, run along p instead so there's still something to vectorize
+            for (int p=0; p<m; ++p)
+            {
+               float apcRe = xr[p] + xr[p+2*m], apcIm = xi[p] + xi[p+2*m];
+               float amcRe = xr[p] - xr[p+2*m], amcIm = xi[p] - xi[p+2*m];
+               float bpdRe = xr[p+m] + xr[p+3*m], bpdIm = xi[p+m] + xi[p+3*m];
+               float jbmdRe = xi[p+3*m] - xi[p+m], jbmdIm = xr[p+m] - xr[p+3*m];
+
+               float t1Re = amcRe - jbmdRe, t1Im = amcIm - jbmdIm;
+               float t2Re = apcRe - bpdRe, t2Im = apcIm - bpdIm;
+               float t3Re = amcRe + jbmdRe, t3Im = amcIm + jbmdIm;
+
+               yr[4*p] = apcRe + bpdRe;
+               yi[4*p] = apcIm + bpdIm;
+               yr[4*p+1] = t1Re * w1Re[p] - t1Im * w1Im[p];
+               yi[4*p+1] = t1Re * w1Im[p] + t1Im * w1Re[p];
+               yr[4*p+2] = t2Re * w2Re[p] - t2Im * w2Im[p];
+               yi[4*p+2] = t2Re * w2Im[p] + t2Im * w2Re[p];
+               yr[4*p+3] = t3Re * w3Re[p] - t3Im * w3Im[p];
+               yi[4*p+3] = t3Re * w3Im[p] + t3Im * w3Re[p];
+            }
+         }
+         else for (int p=0; p<m; ++p)
+         {
+            const float* aRe = xr + s*p;
+            const float* aIm = xi + s*p;
+            const float* bRe = xr + s*(p+m);
+            const float* bIm = xi + s*(p+m);
+            const float* cRe = xr + s*(p+2*m);
+            const float* cIm = xi + s*(p+2*m);
+            const float* dRe = xr + s*(p+3*m);
+            const float* dIm = xi + s*(p+3*m);
+            float* y0Re = yr + s*(4*p);
+            float* y0Im = yi + s*(4*p);
+            float* y1Re = yr + s*(4*p+1);
+            float* y1Im = yi + s*(4*p+1);
+            float* y2Re = yr + s*(4*p+2);
+            float* y2Im = yi + s*(4*p+2);
+            float* y3Re = yr + s*(4*p+3);
+            float* y3Im = yi + s*(4*p+3);
+#if FFT_USE_SSE
+            // s is a power of four from here on, so it always fills whole vectors
+            const __m128 vw1Re = _mm_set1_ps(w1Re[p]), vw1Im = _mm_set1_ps(w1Im[p]);
+            const __m128 vw2Re = _mm_set1_ps(w2Re[p]), vw2Im = _mm_set1_ps(w2Im[p]);
+            const __m128 vw3Re = _mm_set1_ps(w3Re[p]), vw3Im = _mm_set1_ps(w3Im[p]);
+            for (int q=0; q<s; q+=4)
+            {
+               __m128 a_re = _mm_loadu_ps(aRe+q), a_im = _mm_loadu_ps(aIm+q);
+               __m128 b_re = _mm_loadu_ps(bRe+q), b_im = _mm_loadu_ps(bIm+q);
+               __m128 c_re = _mm_loadu_ps(cRe+q), c_im = _mm_loadu_ps(cIm+q);
+               __m128 d_re = _mm_loadu_ps(dRe+q), d_im = _mm_loadu_ps(dIm+q);
+
+               __m128 apcRe = _mm_add_ps(a_re, c_re), apcIm = _mm_add_ps(a_im, c_im);
+               __m128 amcRe = _mm_sub_ps(a_re, c_re), amcIm = _mm_sub_ps(a_im, c_im);
+               __m128 bpdRe = _mm_add_ps(b_re, d_re), bpdIm = _mm_add_ps(b_im, d_im);
+               __m128 jbmdRe = _mm_sub_ps(d_im, b_im), jbmdIm = _mm_sub_ps(b_re, d_re);
+
+               __m128 t1Re = _mm_sub_ps(amcRe, jbmdRe), t1Im = _mm_sub_ps(amcIm, jbmdIm);
+               __m128 t2Re = _mm_sub_ps(apcRe, bpdRe), t2Im = _mm_sub_ps(apcIm, bpdIm);
+               __m128 t3Re = _mm_add_ps(amcRe, jbmdRe), t3Im = _mm_add_ps(amcIm, jbmdIm);
+
+               _mm_storeu_ps(y0Re+q, _mm_add_ps(apcRe, bpdRe));
+               _mm_storeu_ps(y0Im+q, _mm_add_ps(apcIm, bpdIm));
+               _mm_storeu_ps(y1Re+q, _mm_sub_ps(_mm_mul_ps(t1Re, vw1Re), _mm_mul_ps(t1Im, vw1Im)));
+               _mm_storeu_ps(y1Im+q, _mm_add_ps(_mm_mul_ps(t1Re, vw1Im), _mm_mul_ps(t1Im, vw1Re)));
+               _mm_storeu_ps(y2Re+q, _mm_sub_ps(_mm_mul_ps(t2Re, vw2Re), _mm_mul_ps(t2Im, vw2Im)));
+               _mm_storeu_ps(y2Im+q, _mm_add_ps(_mm_mul_ps(t2Re, vw2Im), _mm_mul_ps(t2Im, vw2Re)));
+               _mm_storeu_ps(y3Re+q, _mm_sub_ps(_mm_mul_ps(t3Re, vw3Re), _mm_mul_ps(t3Im, vw3Im)));
+               _mm_storeu_ps(y3Im+q, _mm_add_ps(_mm_mul_ps(t3Re, vw3Im), _mm_mul_ps(t3Im, vw3Re)));
+            }
+#else
+            for (int q=0; q<s; ++q)
+            {
+               float apcRe = aRe[q] + cRe[q], apcIm = aIm[q] + cIm[q];
+               float amcRe = aRe[q] - cRe[q], amcIm = aIm[q] - cIm[q];
+               float bpdRe = bRe[q] + dRe[q], bpdIm = bIm[q] + dIm[q];
+               float jbmdRe = dIm[q] - bIm[q], jbmdIm = bRe[q] - dRe[q];   // i*(b-d)
+
+               float t1Re = amcRe - jbmdRe, t1Im = amcIm - jbmdIm;
+               float t2Re = apcRe - bpdRe, t2Im = apcIm - bpdIm;
+               float t3Re = amcRe + jbmdRe, t3Im = amcIm + jbmdIm;
+
+               y0Re[q] = apcRe + bpdRe;
+               y0Im[q] = apcIm + bpdIm;
+               y1Re[q] = t1Re * w1Re[p] - t1Im * w1Im[p];
+               y1Im[q] = t1Re * w1Im[p] + t1Im * w1Re[p];
+               y2Re[q] = t2Re * w2Re[p] - t2Im * w2Im[p];
+               y2Im[q] = t2Re * w2Im[p] + t2Im * w2Re[p];
+               y3Re[q] = t3Re * w3Re[p] - t3Im * w3Im[p];
+               y3Im[q] = t3Re * w3Im[p] + t3Im * w3Re[p];
+            }
+#endif
+         }
+
+         twiddleRe += 3*m;
+         twiddleIm += 3*m;
+         std::swap(xr, yr);
+         std::swap(xi, yi);
+      }
+
+      if (len == 2)
+      {
+         // odd power of two, finish with a radix-2 pass. its only twiddle is 1
+         for (int q=0; q<s; ++q)
+         {
+            float aRe = xr[q], aIm = xi[q];
+            float bRe = xr[q+s], bIm = xi[q+s];
+            yr[q] = aRe + bRe;
+            yi[q] = aIm + bIm;
+            yr[q+s] = aRe - bRe;
+            yi[q+s] = aIm - bIm;
+         }
+         std::swap(xr, yr);
+         std::swap(xi, yi);
+      }
+   }
+}
 
 // Constructor for FFT routine
 FFT::FFT(int nfft)
 {
+   assert(nfft >= 2 && (nfft & (nfft-1)) == 0);
+
    mNfft = nfft;
    mNumfreqs = nfft/2 + 1;
+   mPlan = GetPlan(nfft);
 
-   mFft_data = (float*) calloc(nfft, sizeof(float));
+   for (int i=0; i<2; ++i)
+   {
+      mWorkRe[i].resize(nfft/2);
+      mWorkIm[i].resize(nfft/2);
+   }
 }
 
 // Destructor for FFT routine
 FFT::~FFT()
 {
-   free(mFft_data);
 }
 
 // Perform forward FFT of real data
@@ -33,20 +246,39 @@ FFT::~FFT()
 void FFT::Forward(float* input, float* output_re, float* output_im)
 {
    int hnfft = mNfft/2;
+   float* xr = mWorkRe[0].data();
+   float* xi = mWorkIm[0].data();
+   float* yr = mWorkRe[1].data();
+   float* yi = mWorkIm[1].data();
 
-   for (int ti=0; ti<mNfft; ti++) {
-      mFft_data[ti] = input[ti];
+   // even samples go in the real part and odd samples in the imaginary part
+   for (int ti=0; ti<hnfft; ti++)
+   {
+      xr[ti] = input[2*ti];
+      xi[ti] = input[2*ti+1];
    }
 
-   mayer_realfft(mNfft, mFft_data);
+   ComplexForward(mPlan, xr, xi, yr, yi);
 
+   // Z is the spectrum of the packed signal, X[k] = (Z[k] + conj(Z[n-k]))/2 + W^k * (Z[k] - conj(Z[n-k]))/2i
+   output_re[0] = xr[0] + xi[0];
    output_im[0] = 0;
-   for (int ti=0; ti<hnfft; ti++) {
-      output_re[ti] = mFft_data[ti];
-      output_im[ti] = mFft_data[mNfft-1-ti];
-   }
-   output_re[hnfft] = mFft_data[hnfft];
+   output_re[hnfft] = xr[0] - xi[0];
    output_im[hnfft] = 0;
+
+   const float* splitRe = mPlan->mSplitRe.data();
+   const float* splitIm = mPlan->mSplitIm.data();
+   for (int ti=1; ti<hnfft; ti++)
+   {
+      float zRe = xr[ti], zIm = xi[ti];
+      float cRe = xr[hnfft-ti], cIm = -xi[hnfft-ti];
+      float evenRe = .5f * (zRe + cRe);
+      float evenIm = .5f * (zIm + cIm);
+      float oddRe = .5f * (zIm - cIm);
+      float oddIm = -.5f * (zRe - cRe);
+      output_re[ti] = evenRe + oddRe * splitRe[ti] - oddIm * splitIm[ti];
+      output_im[ti] = evenIm + oddRe * splitIm[ti] + oddIm * splitRe[ti];
+   }
 }
 
 // Perform inverse FFT, returning real data
@@ -54,24 +286,43 @@ void FFT::Forward(float* input, float* output_re, float* output_im)
 //   input_re - pointer to an array of the real part of the output,
 //     size nfft/2 + 1
 //   input_im - pointer to an array of the imaginary part of the output,
-//     size nfft/2 + 1
+//     size nfft/2 + 1 (the first and last are taken to be zero)
 //   output - pointer to an array of (real) input values, size nfft
 void FFT::Inverse(float* input_re, float* input_im, float* output)
 {
-   int hnfft;
-
-   hnfft = mNfft/2;
-
-   for (int ti=0; ti<hnfft; ti++) {
-      mFft_data[ti] = input_re[ti];
-      mFft_data[mNfft-1-ti] = input_im[ti];
+   int hnfft = mNfft/2;
+   float* xr = mWorkRe[0].data();
+   float* xi = mWorkIm[0].data();
+   float* yr = mWorkRe[1].data();
+   float* yi = mWorkIm[1].data();
+
+   // fold back into the half size spectrum the forward transform split apart, scaled by 2 to keep nfft * x overall
+   xr[0] = input_re[0] + input_re[hnfft];
+   xi[0] = input_re[0] - input_re[hnfft];
+
+   const float* splitRe = mPlan->mSplitRe.data();
+   const float* splitIm = mPlan->mSplitIm.data();
+   for (int ti=1; ti<hnfft; ti++)
+   {
+      float re = input_re[ti], im = input_im[ti];
+      float cRe = input_re[hnfft-ti], cIm = -input_im[hnfft-ti];
+      float evenRe = re + cRe;
+      float evenIm = im + cIm;
+      float diffRe = re - cRe;
+      float diffIm = im - cIm;
+      float oddRe = diffRe * splitRe[ti] + diffIm * splitIm[ti];
+      float oddIm = diffIm * splitRe[ti] - diffRe * splitIm[ti];
+      xr[ti] = evenRe - oddIm;
+      xi[ti] = evenIm + oddRe;
    }
-   mFft_data[hnfft] = input_re[hnfft];
 
-   mayer_realifft(mNfft, mFft_data);
+   // swapping real and imaginary turns the forward transform into the inverse
+   ComplexForward(mPlan, xi, xr, yi, yr);
 
-   for (int ti=0; ti<mNfft; ti++) {
-      output[ti] = mFft_data[ti];
+   for (int ti=0; ti<hnfft; ti++)
+   {
+      output[2*ti] = xr[ti];
+      output[2*ti+1] = xi[ti];
    }
 }
 
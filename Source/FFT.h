@@ -10,8 +10,12 @@
 #define __modularSynth__FFT__
 
 #include <iostream>
+#include <vector>
 
-// Variables for FFT routine
+struct FFTPlan;
+
+// Real FFT of a power-of-two size. Spectra are split complex, nfft/2 + 1 bins,
+// and neither direction is normalized, so Inverse(Forward(x)) gives back nfft * x
 class FFT
 {
 public:
@@ -22,7 +26,9 @@ public:
 private:
    int mNfft;        // size of FFT
    int mNumfreqs;    // number of frequencies represented (nfft/2 + 1)
-   float* mFft_data; // array for writing/reading to/from FFT function
+   const FFTPlan* mPlan;   // twiddle factors, shared by every FFT of the same size
+   std::vector<float> mWorkRe[2];   // ping-pong buffers for the half size complex transform
+   std::vector<float> mWorkIm[2];
 };
 
 
@@ -32,6 +38,7 @@ private:
 
 #define REAL float
 
+// the previous implementation, still around to benchmark against
 void mayer_realfft(int n, REAL *real);
 void mayer_realifft(int n, REAL *real);
 
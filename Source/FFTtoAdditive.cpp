@@ -13,21 +13,19 @@
 namespace
 {
    const int fftWindowSize = 1024;
+   const int fftHopSize = fftWindowSize/4;
    const int fftFreqDomainSize = fftWindowSize/2 + 1;
 
    const int numPartials = fftFreqDomainSize-1;
-
-   
-   double sineBuffer[514]={0,0.012268,0.024536,0.036804,0.049042,0.06131,0.073547,0.085785,0.097992,0.1102,0.12241,0.13455,0.1467,0.15884,0.17093,0.18301,0.19507,0.20709,0.21909,0.23105,0.24295,0.25485,0.26669,0.2785,0.29025,0.30197,0.31366,0.32529,0.33685,0.34839,0.35986,0.37128,0.38266,0.39395,0.40521,0.41641,0.42752,0.4386,0.44958,0.46051,0.47137,0.48215,0.49286,0.50351,0.51407,0.52457,0.53497,0.54529,0.55554,0.5657,0.57578,0.58575,0.59567,0.60547,0.6152,0.62482,0.63437,0.6438,0.65314,0.66238,0.67151,0.68057,0.68951,0.69833,0.70706,0.7157,0.72421,0.7326,0.74091,0.74908,0.75717,0.76514,0.77298,0.7807,0.7883,0.79581,0.80316,0.81042,0.81754,0.82455,0.83142,0.8382,0.84482,0.85132,0.8577,0.86392,0.87006,0.87604,0.88187,0.8876,0.89319,0.89862,0.90396,0.90912,0.91415,0.91907,0.92383,0.92847,0.93295,0.93729,0.9415,0.94556,0.94949,0.95325,0.95691,0.96039,0.96375,0.96692,0.97,0.9729,0.97565,0.97827,0.98074,0.98306,0.98523,0.98724,0.98914,0.99084,0.99243,0.99387,0.99515,0.99628,0.99725,0.99808,0.99875,0.99927,0.99966,0.99988,0.99997,0.99988,0.99966,0.99927,0.99875,0.99808,0.99725,0.99628,0.99515,0.99387,0.99243,0.99084,0.98914,0.98724,0.98523,0.98306,0.98074,0.97827,0.97565,0.9729,0.97,0.96692,0.96375,0.96039,0.95691,0.95325,0.94949,0.94556,0.9415,0.93729,0.93295,0.92847,0.92383,0.91907,0.91415,0.90912,0.90396,0.89862,0.89319,0.8876,0.88187,0.87604,0.87006,0.86392,0.8577,0.85132,0.84482,0.8382,0.83142,0.82455,0.81754,0.81042,0.80316,0.79581,0.7883,0.7807,0.77298,0.76514,0.75717,0.74908,0.74091,0.7326,0.72421,0.7157,0.70706,0.69833,0.68951,0.68057,0.67151,0.66238,0.65314,0.6438,0.63437,0.62482,0.6152,0.60547,0.59567,0.58575,0.57578,0.5657,0.55554,0.54529,0.53497,0.52457,0.51407,0.50351,0.49286,0.48215,0.47137,0.46051,0.44958,0.4386,0.42752,0.41641,0.40521,0.39395,0.38266,0.37128,0.35986,0.34839,0.33685,0.32529,0.31366,0.30197,0.29025,0.2785,0.26669,0.25485,0.24295,0.23105,0.21909,0.20709,0.19507,0.18301,0.17093,0.15884,0.1467,0.13455,0.12241,0.1102,0.097992,0.085785,0.073547,0.06131,0.049042,0.036804,0.024536,0.012268,0,-0.012268,-0.024536,-0.036804,-0.049042,-0.06131,-0.073547,-0.085785,-0.097992,-0.1102,-0.12241,-0.13455,-0.1467,-0.15884,-0.17093,-0.18301,-0.19507,-0.20709,-0.21909,-0.23105,-0.24295,-0.25485,-0.26669,-0.2785,-0.29025,-0.30197,-0.31366,-0.32529,-0.33685,-0.34839,-0.35986,-0.37128,-0.38266,-0.39395,-0.40521,-0.41641,-0.42752,-0.4386,-0.44958,-0.46051,-0.47137,-0.48215,-0.49286,-0.50351,-0.51407,-0.52457,-0.53497,-0.54529,-0.55554,-0.5657,-0.57578,-0.58575,-0.59567,-0.60547,-0.6152,-0.62482,-0.63437,-0.6438,-0.65314,-0.66238,-0.67151,-0.68057,-0.68951,-0.69833,-0.70706,-0.7157,-0.72421,-0.7326,-0.74091,-0.74908,-0.75717,-0.76514,-0.77298,-0.7807,-0.7883,-0.79581,-0.80316,-0.81042,-0.81754,-0.82455,-0.83142,-0.8382,-0.84482,-0.85132,-0.8577,-0.86392,-0.87006,-0.87604,-0.88187,-0.8876,-0.89319,-0.89862,-0.90396,-0.90912,-0.91415,-0.91907,-0.92383,-0.92847,-0.93295,-0.93729,-0.9415,-0.94556,-0.94949,-0.95325,-0.95691,-0.96039,-0.96375,-0.96692,-0.97,-0.9729,-0.97565,-0.97827,-0.98074,-0.98306,-0.98523,-0.98724,-0.98914,-0.99084,-0.99243,-0.99387,-0.99515,-0.99628,-0.99725,-0.99808,-0.99875,-0.99927,-0.99966,-0.99988,-0.99997,-0.99988,-0.99966,-0.99927,-0.99875,-0.99808,-0.99725,-0.99628,-0.99515,-0.99387,-0.99243,-0.99084,-0.98914,-0.98724,-0.98523,-0.98306,-0.98074,-0.97827,-0.97565,-0.9729,-0.97,-0.96692,-0.96375,-0.96039,-0.95691,-0.95325,-0.94949,-0.94556,-0.9415,-0.93729,-0.93295,-0.92847,-0.92383,-0.91907,-0.91415,-0.90912,-0.90396,-0.89862,-0.89319,-0.8876,-0.88187,-0.87604,-0.87006,-0.86392,-0.8577,-0.85132,-0.84482,-0.8382,-0.83142,-0.82455,-0.81754,-0.81042,-0.80316,-0.79581,-0.7883,-0.7807,-0.77298,-0.76514,-0.75717,-0.74908,-0.74091,-0.7326,-0.72421,-0.7157,-0.70706,-0.69833,-0.68951,-0.68057,-0.67151,-0.66238,-0.65314,-0.6438,-0.63437,-0.62482,-0.6152,-0.60547,-0.59567,-0.58575,-0.57578,-0.5657,-0.55554,-0.54529,-0.53497,-0.52457,-0.51407,-0.50351,-0.49286,-0.48215,-0.47137,-0.46051,-0.44958,-0.4386,-0.42752,-0.41641,-0.40521,-0.39395,-0.38266,-0.37128,-0.35986,-0.34839,-0.33685,-0.32529,-0.31366,-0.30197,-0.29025,-0.2785,-0.26669,-0.25485,-0.24295,-0.23105,-0.21909,-0.20709,-0.19507,-0.18301,-0.17093,-0.15884,-0.1467,-0.13455,-0.12241,-0.1102,-0.097992,-0.085785,-0.073547,-0.06131,-0.049042,-0.036804,-0.024536,-0.012268,0,0.012268
-   };
 }
 
 FFTtoAdditive::FFTtoAdditive()
 : IAudioProcessor(gBufferSize)
-, mFFT(fftWindowSize)
-, mRollingInputBuffer(fftWindowSize)
-, mRollingOutputBuffer(fftWindowSize)
-, mFFTData(fftWindowSize, fftFreqDomainSize)
+, mSTFT(fftWindowSize, fftHopSize)
+, mAmplitudes(fftFreqDomainSize)
+, mPhases(fftFreqDomainSize)
+, mOutputBuffer(nullptr)
+, mRenderedUpTo(0)
 , mInputPreamp(1)
 , mValue1(1)
 , mVolume(1)
@@ -43,11 +41,9 @@ FFTtoAdditive::FFTtoAdditive()
 , mPhaseOffset(0)
 , mPhaseOffsetSlider(nullptr)
 , mHistoryPtr(0)
+, mPartials(numPartials)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[fftWindowSize];
-   for (int i=0; i<fftWindowSize; ++i)
-      mWindower[i] = -.5*cos(FTWO_PI*i/fftWindowSize)+.5;
+   mSTFT.SetListener(this);
 
    mPhaseInc = new float[numPartials];
    for (int i=0; i<numPartials; ++i)
@@ -55,12 +51,6 @@ FFTtoAdditive::FFTtoAdditive()
       float freq = i/float(fftFreqDomainSize) * (gNyquistLimit/2);
       mPhaseInc[i] = GetPhaseInc(freq);
    }
-
-   for (int i=0; i<fftFreqDomainSize; ++i)
-   {
-      mFFTData.mRealValues[i] = 0;
-      mFFTData.mImaginaryValues[i] = 0;
-   }
 }
 
 void FFTtoAdditive::CreateUIControls()
@@ -77,7 +67,7 @@ void FFTtoAdditive::CreateUIControls()
 
 FFTtoAdditive::~FFTtoAdditive()
 {
-   delete[] mWindower;
+   delete[] mPhaseInc;
 }
 
 void FFTtoAdditive::Process(double time)
@@ -90,64 +80,54 @@ void FFTtoAdditive::Process(double time)
    ComputeSliders(0);
    SyncBuffers();
 
-   float inputPreampSq = mInputPreamp * mInputPreamp;
-   float volSq = mVolume * mVolume;
-
    int bufferSize = GetBuffer()->BufferSize();
 
-   mRollingInputBuffer.WriteChunk(GetBuffer()->GetChannel(0), bufferSize, 0);
+   //the partials are rendered in pieces, each frame that lands partway through the block retunes them from there on
+   Clear(gWorkBuffer, bufferSize);
+   mOutputBuffer = gWorkBuffer;
+   mRenderedUpTo = 0;
+   const float* input = GetBuffer()->GetChannel(0);
+   mSTFT.Process(&input, nullptr, bufferSize);
+   if (mRenderedUpTo < bufferSize)
+      mPartials.Process(gWorkBuffer + mRenderedUpTo, bufferSize - mRenderedUpTo);
+
+   float* out = GetTarget()->GetBuffer()->GetChannel(0);
+   GetVizBuffer()->WriteChunk(gWorkBuffer, bufferSize, 0);
+   Add(out, gWorkBuffer, bufferSize);
+
+   GetBuffer()->Reset();
+}
 
-   //copy rolling input buffer into working buffer and window it
-   mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, fftWindowSize, 0, 0);
-   Mult(mFFTData.mTimeDomain, mWindower, fftWindowSize);
-   Mult(mFFTData.mTimeDomain, inputPreampSq, fftWindowSize);
+void FFTtoAdditive::ProcessFrame(STFT* stft, int offset)
+{
+   float inputPreampSq = mInputPreamp * mInputPreamp;
+   float volSq = mVolume * mVolume;
 
-   mFFT.Forward(mFFTData.mTimeDomain,
-                mFFTData.mRealValues,
-                mFFTData.mImaginaryValues);
+   if (offset > mRenderedUpTo)
+      mPartials.Process(mOutputBuffer + mRenderedUpTo, offset - mRenderedUpTo);
+   mRenderedUpTo = offset;
 
+   const float* realValues = stft->GetReal(0);
+   const float* imaginaryValues = stft->GetImag(0);
    for (int i=0; i<fftFreqDomainSize; ++i)
    {
-      float real = mFFTData.mRealValues[i];
-      float imag = mFFTData.mImaginaryValues[i];
+      float real = realValues[i];
+      float imag = imaginaryValues[i];
 
       //cartesian to polar
-      float amp = 2.*sqrtf(real*real + imag*imag);
+      float amp = 2.*sqrtf(real*real + imag*imag) * inputPreampSq;
       float phase = atan2(imag,real);
 
-      mFFTData.mRealValues[i] = amp / (fftWindowSize/2);
-      mFFTData.mImaginaryValues[i] = phase;
+      mAmplitudes[i] = amp / (fftWindowSize/2);
+      mPhases[i] = phase;
    }
 
-   float* out = GetTarget()->GetBuffer()->GetChannel(0);
-   for (int i=0; i<bufferSize; ++i)
+   //each frame restarts the partials at the analyzed phases, amplitudes ramp from the last analysis
+   for (int j=1; j<numPartials; ++j)
    {
-      float write = 0;
-      for (int j=1; j<numPartials; ++j)
-      {
-         float phase = ((mFFTData.mImaginaryValues[j+1] + i*mPhaseInc[j]) / FTWO_PI) * 512;
-         float sample = SinSample(phase) * mFFTData.mRealValues[j+1] * volSq * .4f;
-         write += sample;
-      }
-
-      GetVizBuffer()->Write(write, 0);
-
-      out[i] += write;
-
-      time += gInvSampleRateMs;
+      mPartials.SetPhase(j, mPhases[j+1] - mPhaseInc[j]);
+      mPartials.SetPartial(j, mPhaseInc[j], mAmplitudes[j+1] * volSq * .4f);
    }
-
-   GetBuffer()->Reset();
-}
-
-float FFTtoAdditive::SinSample(float phase)
-{
-   int intPhase = int(phase) % 512;
-   if (intPhase < 0)
-      intPhase += 512;
-   float remainder = phase - int(phase);
-   float retVal = ((1-remainder) * sineBuffer[intPhase] + remainder * sineBuffer[1+intPhase]);
-   return retVal;
 }
 
 void FFTtoAdditive::DrawModule()
@@ -202,7 +182,7 @@ void FFTtoAdditive::DrawViz()
    bzero(mPeakHistory[mHistoryPtr], sizeof(float) * VIZ_WIDTH);
    for (int i=1; i<=numPartials; ++i)
    {
-      float height = mFFTData.mRealValues[i-1];
+      float height = mAmplitudes[i-1];
       int intHeight = int(height*100.0f);
       if (intHeight == 0)
       {
@@ -13,16 +13,16 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Checkbox.h"
-#include "FFT.h"
-#include "RollingBuffer.h"
+#include "STFT.h"
 #include "Slider.h"
 #include "GateEffect.h"
 #include "BiquadFilterEffect.h"
+#include "PartialBank.h"
 
 #define VIZ_WIDTH 1000
 #define RAZOR_HISTORY 100
 
-class FFTtoAdditive : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener
+class FFTtoAdditive : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public ISTFTListener
 {
 public:
    FFTtoAdditive();
@@ -43,45 +43,26 @@ public:
    //IFloatSliderListener
    void FloatSliderUpdated(FloatSlider* slider, float oldVal) override {}
    
+   //ISTFTListener
+   void ProcessFrame(STFT* stft, int offset) override;
+   
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
    virtual void SetUpFromSaveData() override;
    
    
 private:
-   struct FFTData
-   {
-      FFTData(int windowSize, int freqDomainSize)
-      {
-         mRealValues = new float[freqDomainSize];
-         mImaginaryValues = new float[freqDomainSize];
-         mTimeDomain = new float[windowSize];
-      }
-      ~FFTData()
-      {
-         delete[] mRealValues;
-         delete[] mImaginaryValues;
-         delete[] mTimeDomain;
-      }
-      float* mRealValues;
-      float* mImaginaryValues;
-      float* mTimeDomain;
-   };
-
    void DrawViz();
-   float SinSample(float phase);
 
    //IDrawableModule
    void DrawModule() override;
    void GetModuleDimensions(int& w, int&h) override { w=235; h=170; }
    bool Enabled() const override { return mEnabled; }
 
-   FFTData mFFTData;
-   
-   float* mWindower;
-
-   ::FFT mFFT;
-   RollingBuffer mRollingInputBuffer;
-   RollingBuffer mRollingOutputBuffer;
+   STFT mSTFT;
+   vector<float> mAmplitudes;
+   vector<float> mPhases;
+   float* mOutputBuffer;   //where the partials are being rendered this block
+   int mRenderedUpTo;
 
    float mInputPreamp;
    float mValue1;
@@ -101,6 +82,7 @@ private:
    float mPeakHistory[RAZOR_HISTORY][VIZ_WIDTH+1];
    int mHistoryPtr;
    float* mPhaseInc;
+   PartialBank mPartials;
 };
 
 #endif /* defined(__modularSynth__FFTtoAdditive__) */
@@ -128,14 +128,16 @@ void FMSynth::Process(double time)
    if (!mEnabled || GetTarget() == nullptr)
       return;
    
-   ComputeSliders(0);
-   
    int bufferSize = GetTarget()->GetBuffer()->BufferSize();
    assert(bufferSize == gBufferSize);
    
+   BeginSliderBlock(bufferSize);
+   
    mWriteBuffer.Clear();
    mPolyMgr.Process(time, &mWriteBuffer, bufferSize);
    
+   EndSliderBlock();
+   
    SyncOutputBuffer(mWriteBuffer.NumActiveChannels());
    for (int ch=0; ch<mWriteBuffer.NumActiveChannels(); ++ch)
    {
@@ -221,6 +223,8 @@ void FMSynth::FloatSliderUpdated(FloatSlider* slider, float oldVal)
 void FMSynth::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("target", moduleInfo);
+   mModuleSaveData.LoadInt("voicelimit", moduleInfo, kNumVoices, 1, PolyphonyMgr::kMaxVoices, true);
+   mModuleSaveData.LoadBool("parallel_voices", moduleInfo, false);
 
    SetUpFromSaveData();
 }
@@ -228,6 +232,8 @@ void FMSynth::LoadLayout(const ofxJSONElement& moduleInfo)
 void FMSynth::SetUpFromSaveData()
 {
    SetTarget(TheSynth->FindModule(mModuleSaveData.GetString("target")));
+   mPolyMgr.SetVoiceLimit(mModuleSaveData.GetInt("voicelimit"));
+   mPolyMgr.SetRenderInParallel(mModuleSaveData.GetBool("parallel_voices"));
 }
 
 
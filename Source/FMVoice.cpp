@@ -12,6 +12,7 @@
 #include "Scale.h"
 #include "Profiler.h"
 #include "ChannelBuffer.h"
+#include "IDrawableModule.h"
 
 FMVoice::FMVoice(IDrawableModule* owner)
 : mOscPhase(0)
@@ -40,11 +41,16 @@ bool FMVoice::Process(double time, ChannelBuffer* out)
    if (IsDone(time))
       return false;
 
+   //read modulated sliders per sample from the owner's slider block, the sliders themselves don't move under us
+   SliderBlockValues modIdx(mOwner, &mVoiceParams->mModIdx);
+   SliderBlockValues modIdx2(mOwner, &mVoiceParams->mModIdx2);
+   SliderBlockValues phaseOffset0(mOwner, &mVoiceParams->mPhaseOffset0);
+   SliderBlockValues phaseOffset1(mOwner, &mVoiceParams->mPhaseOffset1);
+   SliderBlockValues phaseOffset2(mOwner, &mVoiceParams->mPhaseOffset2);
+   SliderBlockValues vol(mOwner, &mVoiceParams->mVol);
+   
    for (int pos=0; pos<out->BufferSize(); ++pos)
    {
-      if (mOwner)
-         mOwner->ComputeSliders(pos);
-      
       float oscFreq = TheScale->PitchToFreq(GetPitch(pos));
       float harmFreq = oscFreq * mHarm.GetADSR()->Value(time) * mVoiceParams->mHarmRatio;
       float harmFreq2 = harmFreq * mHarm2.GetADSR()->Value(time) * mVoiceParams->mHarmRatio2;
@@ -54,20 +60,20 @@ bool FMVoice::Process(double time, ChannelBuffer* out)
       mHarmPhase2 += harmPhaseInc2;
       while (mHarmPhase2 > FTWO_PI) { mHarmPhase2 -= FTWO_PI; }
       
-      float modHarmFreq = harmFreq + mHarm2.Audio(time, mHarmPhase2 + mVoiceParams->mPhaseOffset2) * harmFreq2 * mModIdx2.Value(time) * mVoiceParams->mModIdx2;
+      float modHarmFreq = harmFreq + mHarm2.Audio(time, mHarmPhase2 + phaseOffset2[pos]) * harmFreq2 * mModIdx2.Value(time) * modIdx2[pos];
       
       float harmPhaseInc = GetPhaseInc(modHarmFreq);
       
       mHarmPhase += harmPhaseInc;
       while (mHarmPhase > FTWO_PI) { mHarmPhase -= FTWO_PI; }
 
-      float modOscFreq = oscFreq + mHarm.Audio(time, mHarmPhase + mVoiceParams->mPhaseOffset1) * harmFreq * mModIdx.Value(time) * mVoiceParams->mModIdx;
+      float modOscFreq = oscFreq + mHarm.Audio(time, mHarmPhase + phaseOffset1[pos]) * harmFreq * mModIdx.Value(time) * modIdx[pos];
       float oscPhaseInc = GetPhaseInc(modOscFreq);
 
       mOscPhase += oscPhaseInc;
       while (mOscPhase > FTWO_PI) { mOscPhase -= FTWO_PI; }
 
-      float sample = mOsc.Audio(time, mOscPhase + mVoiceParams->mPhaseOffset0) * mVoiceParams->mVol/20.0f;
+      float sample = mOsc.Audio(time, mOscPhase + phaseOffset0[pos]) * vol[pos]/20.0f;
       if (out->NumActiveChannels() == 1)
       {
          out->GetChannel(0)[pos] += sample;
@@ -9,123 +9,174 @@
 #include "FileStream.h"
 
 FileStreamOut::FileStreamOut(const char* file)
-: mStream(File(file))
 {
-   mStream.setPosition(0);
-   mStream.truncate();
+   FileOutputStream* stream = new FileOutputStream(File(file));
+   stream->setPosition(0);
+   stream->truncate();
+   mStream = stream;
+   mBufferRefs = nullptr;
+}
+
+FileStreamOut::FileStreamOut(MemoryBlock& block)
+: mStream(new MemoryOutputStream(block, false))
+, mBufferRefs(nullptr)
+{
+}
+
+FileStreamOut::FileStreamOut(MemoryBlock& block, vector<BufferRef>& bufferRefs)
+: mStream(new MemoryOutputStream(block, false))
+, mBufferRefs(&bufferRefs)
+{
+}
+
+//static
+void FileStreamOut::ResolveBufferRefs(MemoryBlock& block, vector<BufferRef>& bufferRefs)
+{
+   if (bufferRefs.empty())
+      return;
+   
+   size_t totalSize = block.getSize();
+   for (auto& ref : bufferRefs)
+      totalSize += sizeof(float) * ref.mSize;
+   
+   MemoryBlock resolved(totalSize);
+   char* dest = (char*)resolved.getData();
+   const char* src = (const char*)block.getData();
+   size_t srcPos = 0;
+   for (auto& ref : bufferRefs)
+   {
+      memcpy(dest, src + srcPos, ref.mOffset - srcPos);
+      dest += ref.mOffset - srcPos;
+      srcPos = ref.mOffset;
+      memcpy(dest, ref.mData, sizeof(float) * ref.mSize);
+      dest += sizeof(float) * ref.mSize;
+   }
+   memcpy(dest, src + srcPos, block.getSize() - srcPos);
+   
+   block.swapWith(resolved);
+   bufferRefs.clear();
 }
 
 FileStreamIn::FileStreamIn(const char* file)
-: mStream(File(file))
+: mStream(new FileInputStream(File(file)))
+{
+}
+
+FileStreamIn::FileStreamIn(const void* data, size_t size)
+: mStream(new MemoryInputStream(data, size, false))
 {
 }
 
 FileStreamOut& FileStreamOut::operator<<(const int &var)
 {
-   mStream.write((const void*)&var, sizeof(int));
+   mStream->write((const void*)&var, sizeof(int));
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const uint32_t &var)
 {
-   mStream.write((const void*)&var, sizeof(uint32_t));
+   mStream->write((const void*)&var, sizeof(uint32_t));
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const bool &var)
 {
-   mStream.write((const void*)&var, sizeof(bool));
+   mStream->write((const void*)&var, sizeof(bool));
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const float &var)
 {
-   mStream.write((const void*)&var, sizeof(float));
+   mStream->write((const void*)&var, sizeof(float));
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const string &var)
 {
    size_t len = var.length();
-   mStream.write((const void*)&len, sizeof(size_t));
-   for (int i=0; i<len; ++i)
-      mStream.write((const void*)&var[i], sizeof(char));
+   mStream->write((const void*)&len, sizeof(size_t));
+   mStream->write((const void*)var.data(), len);
    return *this;
 }
 
 FileStreamOut& FileStreamOut::operator<<(const char &var)
 {
-   mStream.write(&var, sizeof(char));
+   mStream->write(&var, sizeof(char));
    return *this;
 }
 
 void FileStreamOut::Write(const float* buffer, int size)
 {
-   mStream.write((const void*)buffer, sizeof(float)*size);
+   if (mBufferRefs != nullptr && size >= kMinBufferRefSize)
+   {
+      mBufferRefs->push_back(BufferRef{ (size_t)mStream->getPosition(), buffer, size });
+      return;
+   }
+   mStream->write((const void*)buffer, sizeof(float)*size);
 }
 
 void FileStreamOut::WriteGeneric(const void* buffer, int size)
 {
-   mStream.write((const void*)buffer, size);
+   mStream->write((const void*)buffer, size);
 }
 
 FileStreamIn& FileStreamIn::operator>>(int &var)
 {
-   mStream.read((void*)&var, sizeof(int));
+   mStream->read((void*)&var, sizeof(int));
    return *this;
 }
 
 FileStreamIn& FileStreamIn::operator>>(uint32_t &var)
 {
-   mStream.read((void*)&var, sizeof(uint32_t));
+   mStream->read((void*)&var, sizeof(uint32_t));
    return *this;
 }
 
 FileStreamIn& FileStreamIn::operator>>(bool &var)
 {
-   mStream.read((void*)&var, sizeof(bool));
+   mStream->read((void*)&var, sizeof(bool));
    return *this;
 }
 
 FileStreamIn& FileStreamIn::operator>>(float &var)
 {
-   mStream.read((void*)&var, sizeof(float));
+   mStream->read((void*)&var, sizeof(float));
    return *this;
 }
 
 FileStreamIn& FileStreamIn::operator>>(string &var)
 {
    size_t len;
-   mStream.read((void*)&len, sizeof(size_t));
+   mStream->read((void*)&len, sizeof(size_t));
    assert(len < 9999);   //probably garbage beyond this point
    var.resize(len);
-   for (int i=0; i<len; ++i)
-      mStream.read((void*)&var[i], sizeof(char));
+   if (len > 0)
+      mStream->read((void*)&var[0], (int)len);
    return *this;
 }
 
 FileStreamIn& FileStreamIn::operator>>(char &var)
 {
-   mStream.read(&var, sizeof(char));
+   mStream->read(&var, sizeof(char));
    return *this;
 }
 
 void FileStreamIn::Read(float* buffer, int size)
 {
-   mStream.read((void*)buffer, sizeof(float)*size);
+   mStream->read((void*)buffer, sizeof(float)*size);
 }
 
 void FileStreamIn::ReadGeneric(void* buffer, int size)
 {
-   mStream.read((void*)buffer, size);
+   mStream->read((void*)buffer, size);
 }
 
 bool FileStreamIn::Eof()
 {
-   return mStream.isExhausted();
+   return mStream->isExhausted();
 }
 
 int FileStreamIn::GetFilePosition()
 {
-   return mStream.getPosition();
+   return mStream->getPosition();
 }
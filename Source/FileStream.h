@@ -15,7 +15,18 @@
 class FileStreamOut
 {
 public:
+   //a large float buffer that was only pointed at rather than copied, to be spliced in at mOffset later
+   struct BufferRef
+   {
+      size_t mOffset;
+      const float* mData;
+      int mSize;
+   };
+   
    FileStreamOut(const char* file);
+   FileStreamOut(MemoryBlock& block);  //for building up a save in memory, to write out later
+   FileStreamOut(MemoryBlock& block, vector<BufferRef>& bufferRefs);  //same, but large buffers are only referenced until ResolveBufferRefs()
+   static void ResolveBufferRefs(MemoryBlock& block, vector<BufferRef>& bufferRefs);  //copies the referenced buffers into place
    FileStreamOut& operator<<(const int& var);
    FileStreamOut& operator<<(const uint32_t &var);
    FileStreamOut& operator<<(const bool& var);
@@ -24,14 +35,18 @@ public:
    FileStreamOut& operator<<(const char& var);
    void Write(const float* buffer, int size);
    void WriteGeneric(const void* buffer, int size);
+   
+   static const int kMinBufferRefSize = 4096;
 private:
-   FileOutputStream mStream;
+   ScopedPointer<OutputStream> mStream;
+   vector<BufferRef>* mBufferRefs;
 };
 
 class FileStreamIn
 {
 public:
    FileStreamIn(const char* file);
+   FileStreamIn(const void* data, size_t size);  //reads straight out of memory that the caller keeps alive
    FileStreamIn& operator>>(int& var);
    FileStreamIn& operator>>(uint32_t &var);
    FileStreamIn& operator>>(bool& var);
@@ -44,7 +59,7 @@ public:
    
    bool Eof();
 private:
-   FileInputStream mStream;
+   ScopedPointer<InputStream> mStream;
 };
 
 #endif /* defined(__Bespoke__FileStream__) */
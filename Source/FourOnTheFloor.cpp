@@ -44,7 +44,7 @@ void FourOnTheFloor::OnTimeEvent(int samplesTo)
       return;
    
    int kick = 0;
-   PlayNoteOutput(gTime, kick, 127, -1);
+   PlayNoteOutput(gTime + samplesTo * gInvSampleRateMs, kick, 127, -1);
 }
 
 void FourOnTheFloor::CheckboxUpdated(Checkbox* checkbox)
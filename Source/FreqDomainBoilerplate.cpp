@@ -12,15 +12,12 @@
 namespace
 {
    const int fftWindowSize = 1024;
-   const int fftFreqDomainSize = fftWindowSize/2 + 1;
+   const int fftHopSize = fftWindowSize/4;
 }
 
 FreqDomainBoilerplate::FreqDomainBoilerplate()
 : IAudioProcessor(gBufferSize)
-, mFFT(fftWindowSize)
-, mRollingInputBuffer(fftWindowSize)
-, mRollingOutputBuffer(fftWindowSize)
-, mFFTData(fftWindowSize, fftFreqDomainSize)
+, mSTFT(fftWindowSize, fftHopSize)
 , mInputPreamp(1)
 , mValue1(1)
 , mVolume(1)
@@ -36,10 +33,7 @@ FreqDomainBoilerplate::FreqDomainBoilerplate()
 , mPhaseOffset(0)
 , mPhaseOffsetSlider(nullptr)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[fftWindowSize];
-   for (int i=0; i<fftWindowSize; ++i)
-      mWindower[i] = -.5*cos(FTWO_PI*i/fftWindowSize)+.5;
+   mSTFT.SetListener(this);
 }
 
 void FreqDomainBoilerplate::CreateUIControls()
@@ -56,7 +50,6 @@ void FreqDomainBoilerplate::CreateUIControls()
 
 FreqDomainBoilerplate::~FreqDomainBoilerplate()
 {
-   delete[] mWindower;
 }
 
 void FreqDomainBoilerplate::Process(double time)
@@ -74,24 +67,33 @@ void FreqDomainBoilerplate::Process(double time)
 
    int bufferSize = GetBuffer()->BufferSize();
 
-   mRollingInputBuffer.WriteChunk(GetBuffer()->GetChannel(0), bufferSize, 0);
+   float* wet = gWorkBuffer;
+   const float* input = GetBuffer()->GetChannel(0);
+   mSTFT.Process(&input, wet, bufferSize);
 
-   //copy rolling input buffer into working buffer and window it
-   mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, fftWindowSize, 0, 0);
-   Mult(mFFTData.mTimeDomain, mWindower, fftWindowSize);
-   Mult(mFFTData.mTimeDomain, inputPreampSq, fftWindowSize);
+   Mult(GetBuffer()->GetChannel(0), (1-mDryWet)*inputPreampSq, GetBuffer()->BufferSize());
+
+   for (int i=0; i<bufferSize; ++i)
+      GetBuffer()->GetChannel(0)[i] += wet[i] * inputPreampSq * volSq * mDryWet;
+
+   Add(GetTarget()->GetBuffer()->GetChannel(0), GetBuffer()->GetChannel(0), bufferSize);
+
+   GetVizBuffer()->WriteChunk(GetBuffer()->GetChannel(0),bufferSize, 0);
 
-   mFFT.Forward(mFFTData.mTimeDomain,
-                mFFTData.mRealValues,
-                mFFTData.mImaginaryValues);
+   GetBuffer()->Reset();
+}
 
-   for (int i=0; i<fftFreqDomainSize; ++i)
+void FreqDomainBoilerplate::ProcessFrame(STFT* stft, int offset)
+{
+   float* realValues = stft->GetReal(0);
+   float* imaginaryValues = stft->GetImag(0);
+   for (int i=0; i<stft->GetNumBins(); ++i)
    {
-      float real = mFFTData.mRealValues[i];
-      float imag = mFFTData.mImaginaryValues[i];
+      float real = realValues[i];
+      float imag = imaginaryValues[i];
 
       //cartesian to polar
-      float amp = 2.*sqrtf(real*real + imag*imag);
+      float amp = sqrtf(real*real + imag*imag);
       float phase = atan2(imag,real);
 
       phase += mPhaseOffset;
@@ -101,31 +103,9 @@ void FreqDomainBoilerplate::Process(double time)
       real = amp*cos(phase);
       imag = amp*sin(phase);
 
-      mFFTData.mRealValues[i] = real;
-      mFFTData.mImaginaryValues[i] = imag;
+      realValues[i] = real;
+      imaginaryValues[i] = imag;
    }
-
-   mFFT.Inverse(mFFTData.mRealValues,
-                mFFTData.mImaginaryValues,
-                mFFTData.mTimeDomain);
-
-   for (int i=0; i<bufferSize; ++i)
-      mRollingOutputBuffer.Write(0, 0);
-
-   //copy rolling input buffer into working buffer and window it
-   for (int i=0; i<fftWindowSize; ++i)
-      mRollingOutputBuffer.Accum(fftWindowSize-i-1, mFFTData.mTimeDomain[i] * mWindower[i] * .0001f, 0);
-
-   Mult(GetBuffer()->GetChannel(0), (1-mDryWet)*inputPreampSq, GetBuffer()->BufferSize());
-
-   for (int i=0; i<bufferSize; ++i)
-      GetBuffer()->GetChannel(0)[i] += mRollingOutputBuffer.GetSample(fftWindowSize-i-1, 0) * volSq * mDryWet;
-
-   Add(GetTarget()->GetBuffer()->GetChannel(0), GetBuffer()->GetChannel(0), bufferSize);
-
-   GetVizBuffer()->WriteChunk(GetBuffer()->GetChannel(0),bufferSize, 0);
-
-   GetBuffer()->Reset();
 }
 
 void FreqDomainBoilerplate::DrawModule()
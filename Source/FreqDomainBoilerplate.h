@@ -13,13 +13,12 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Checkbox.h"
-#include "FFT.h"
-#include "RollingBuffer.h"
+#include "STFT.h"
 #include "Slider.h"
 #include "GateEffect.h"
 #include "BiquadFilterEffect.h"
 
-class FreqDomainBoilerplate : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener
+class FreqDomainBoilerplate : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public ISTFTListener
 {
 public:
    FreqDomainBoilerplate();
@@ -41,39 +40,17 @@ public:
    void CheckboxUpdated(Checkbox* checkbox) override;
    //IFloatSliderListener
    void FloatSliderUpdated(FloatSlider* slider, float oldVal) override {}
+   
+   //ISTFTListener
+   void ProcessFrame(STFT* stft, int offset) override;
 
 private:
-   struct FFTData
-   {
-      FFTData(int windowSize, int freqDomainSize)
-      {
-         mRealValues = new float[freqDomainSize];
-         mImaginaryValues = new float[freqDomainSize];
-         mTimeDomain = new float[windowSize];
-      }
-      ~FFTData()
-      {
-         delete[] mRealValues;
-         delete[] mImaginaryValues;
-         delete[] mTimeDomain;
-      }
-      float* mRealValues;
-      float* mImaginaryValues;
-      float* mTimeDomain;
-   };
-
    //IDrawableModule
    void DrawModule() override;
    void GetModuleDimensions(int& w, int&h) override { w=235; h=170; }
    bool Enabled() const override { return mEnabled; }
 
-   FFTData mFFTData;
-   
-   float* mWindower;
-
-   ::FFT mFFT;
-   RollingBuffer mRollingInputBuffer;
-   RollingBuffer mRollingOutputBuffer;
+   STFT mSTFT;
 
    float mInputPreamp;
    float mValue1;
@@ -48,6 +48,7 @@ IDrawableModule::IDrawableModule()
 , mMainPatchCableSource(nullptr)
 , mOwningContainer(nullptr)
 , mTitleLabelWidth(0)
+, mSliderBlockSize(0)
 {
 }
 
@@ -667,6 +668,7 @@ void IDrawableModule::AddUIControl(IUIControl* control)
    {
       mSliderMutex.lock();
       mFloatSliders.push_back(slider);
+      mBlockModulatedSliders.reserve(mFloatSliders.size());   //so BeginSliderBlock() never allocates
       mSliderMutex.unlock();
    }
 }
@@ -685,12 +687,82 @@ void IDrawableModule::RemoveUIControl(IUIControl* control)
 
 void IDrawableModule::ComputeSliders(int samplesIn)
 {
+   if (mSliderBlockSize > 0)
+   {
+      //values were already computed by BeginSliderBlock(), unmodulated sliders don't need touching
+      for (int i=0; i<mBlockModulatedSliders.size(); ++i)
+         mBlockModulatedSliders[i]->ApplyBlockValue(samplesIn);
+      return;
+   }
+   
    //mSliderMutex.lock(); TODO(Ryan) mutex acquisition is slow, how can I do this faster?
    for (int i=0; i<mFloatSliders.size(); ++i)
       mFloatSliders[i]->Compute(samplesIn);
    //mSliderMutex.unlock();
 }
 
+//evaluates modulated sliders once for the whole block. voices read the values through SliderBlockValues, and the
+//sliders themselves hold their first value until EndSliderBlock()
+void IDrawableModule::BeginSliderBlock(int blockSize)
+{
+   mSliderBlockSize = 0;
+   mBlockModulatedSliders.clear();
+   for (int i=0; i<mFloatSliders.size(); ++i)
+   {
+      if (mFloatSliders[i]->IsModulated())
+      {
+         mFloatSliders[i]->ComputeBlock(blockSize);
+         mBlockModulatedSliders.push_back(mFloatSliders[i]);
+      }
+      else
+      {
+         mFloatSliders[i]->Compute(0);
+      }
+   }
+   mSliderBlockSize = blockSize;
+   ComputeSliders(0);
+}
+
+void IDrawableModule::EndSliderBlock()
+{
+   if (mSliderBlockSize > 0)
+   {
+      for (int i=0; i<mBlockModulatedSliders.size(); ++i)
+         mBlockModulatedSliders[i]->ApplyBlockValue(mSliderBlockSize-1);
+   }
+   mSliderBlockSize = 0;
+}
+
+const float* IDrawableModule::GetSliderBlockValues(const float* var, int& length) const
+{
+   if (mSliderBlockSize > 0)
+   {
+      for (int i=0; i<mBlockModulatedSliders.size(); ++i)
+      {
+         if (mBlockModulatedSliders[i]->GetVar() == var)
+         {
+            length = mBlockModulatedSliders[i]->GetBlockSize();
+            return mBlockModulatedSliders[i]->GetBlockValues();
+         }
+      }
+   }
+   length = 0;
+   return nullptr;
+}
+
+SliderBlockValues::SliderBlockValues(const IDrawableModule* owner, const float* var)
+: mValues(var)
+, mLast(0)
+{
+   int length = 0;
+   const float* values = owner ? owner->GetSliderBlockValues(var, length) : nullptr;
+   if (values != nullptr && length > 0)
+   {
+      mValues = values;
+      mLast = length - 1;
+   }
+}
+
 PatchCableOld IDrawableModule::GetPatchCableOld(IClickable* target)
 {
    int wThis,hThis,xThis,yThis,wThat,hThat,xThat,yThat;
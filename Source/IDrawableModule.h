@@ -97,6 +97,10 @@ public:
    ModuleType GetModuleType() const { return mType; }
    virtual bool IsSingleton() const { return false; }
    void ComputeSliders(int samplesIn);
+   void BeginSliderBlock(int blockSize);
+   void EndSliderBlock();
+   bool IsInSliderBlock() const { return mSliderBlockSize > 0; }
+   const float* GetSliderBlockValues(const float* var, int& length) const;   //per-sample values of a modulated slider's variable for the current block, null otherwise
    void SetOwningContainer(ModuleContainer* container) { mOwningContainer = container; }
    ModuleContainer* GetOwningContainer() const { return mOwningContainer; }
    virtual ModuleContainer* GetContainer() { return nullptr; }
@@ -150,6 +154,8 @@ private:
    vector<IUIControl*> mUIControls;
    vector<IDrawableModule*> mChildren;
    vector<FloatSlider*> mFloatSliders;
+   vector<FloatSlider*> mBlockModulatedSliders;
+   int mSliderBlockSize;
    int mWidth;
    int mHeight;
    static const int mTitleBarHeight = 12;
@@ -171,4 +177,17 @@ private:
    vector<PatchCableSource*> mPatchCableSources;
 };
 
+//a parameter over the owner's current slider block, for voices to read per sample without touching the slider.
+//modulated parameters read the values the slider computed for the block, anything else reads the parameter itself,
+//which doesn't change until the block is over
+class SliderBlockValues
+{
+public:
+   SliderBlockValues(const IDrawableModule* owner, const float* var);
+   float operator[](int pos) const { return mValues[MIN(pos, mLast)]; }
+private:
+   const float* mValues;
+   int mLast;
+};
+
 #endif
@@ -30,7 +30,7 @@ class NoteHistory
 {
 public:
    void AddEvent(double time, bool on);
-   void Lock(string name) { mHistoryMutex.Lock(name); }
+   void Lock(const char* name) { mHistoryMutex.Lock(name); }
    void Unlock() { mHistoryMutex.Unlock(); }
    NoteHistoryList& GetHistory() { return mHistory; }
    bool CurrentlyOn();
@@ -74,14 +74,17 @@ void KarplusStrong::Process(double time)
    if (!mEnabled || GetTarget() == nullptr)
       return;
 
-   ComputeSliders(0);
-
    int bufferSize = GetTarget()->GetBuffer()->BufferSize();
    assert(bufferSize == gBufferSize);
 
+   //voices render 4x the samples when stretching, see KarplusStrongVoice::Process()
+   BeginSliderBlock(mVoiceParams.mStretch ? bufferSize * 4 : bufferSize);
+
    mWriteBuffer.Clear();
    mPolyMgr.Process(time, &mWriteBuffer, bufferSize);
 
+   EndSliderBlock();
+
    mBiquad.ProcessAudio(time, &mWriteBuffer);
 
    SyncOutputBuffer(mWriteBuffer.NumActiveChannels());
@@ -136,6 +139,8 @@ void KarplusStrong::FloatSliderUpdated(FloatSlider* slider, float oldVal)
 void KarplusStrong::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("target", moduleInfo);
+   mModuleSaveData.LoadInt("voicelimit", moduleInfo, kNumVoices, 1, PolyphonyMgr::kMaxVoices, true);
+   mModuleSaveData.LoadBool("parallel_voices", moduleInfo, false);
 
    SetUpFromSaveData();
 }
@@ -143,6 +148,8 @@ void KarplusStrong::LoadLayout(const ofxJSONElement& moduleInfo)
 void KarplusStrong::SetUpFromSaveData()
 {
    SetTarget(TheSynth->FindModule(mModuleSaveData.GetString("target")));
+   mPolyMgr.SetVoiceLimit(mModuleSaveData.GetInt("voicelimit"));
+   mPolyMgr.SetRenderInParallel(mModuleSaveData.GetBool("parallel_voices"));
 }
 
 
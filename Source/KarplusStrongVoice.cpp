@@ -12,6 +12,13 @@
 #include "Scale.h"
 #include "Profiler.h"
 #include "ChannelBuffer.h"
+#include "IDrawableModule.h"
+#include <atomic>
+
+namespace
+{
+   std::atomic<uint32> sNextNoiseSeed(1);   //so voices started together don't pluck with the same noise
+}
 
 KarplusStrongVoice::KarplusStrongVoice(IDrawableModule* owner)
 : mOscPhase(0)
@@ -57,14 +64,18 @@ bool KarplusStrongVoice::Process(double time, ChannelBuffer* out)
    
    int renderSize = bufferSize/renderRatio;
    
+   //read modulated sliders per sample from the owner's slider block, which covers the whole render when stretching
+   SliderBlockValues filterAmount(mOwner, &mVoiceParams->mFilter);
+   SliderBlockValues exciterFreq(mOwner, &mVoiceParams->mExciterFreq);
+   SliderBlockValues feedback(mOwner, &mVoiceParams->mFeedback);
+   SliderBlockValues vol(mOwner, &mVoiceParams->mVol);
+   std::uniform_real_distribution<float> noise(-1, 1);
+   
    for (int pos=0; pos<renderSize; ++pos)
    {
-      if (mOwner)
-         mOwner->ComputeSliders(pos);
-      
       float pitch = GetPitch(pos) + pitchAdjust;
       
-      float filter = ofClamp(ofMap(TheScale->PitchToFreq(pitch),0,880,mVoiceParams->mFilter,0), 0, 1);
+      float filter = ofClamp(ofMap(TheScale->PitchToFreq(pitch),0,880,filterAmount[pos],0), 0, 1);
       float freq = TheScale->PitchToFreq(pitch);
       
       float oscPhaseInc = 0;
@@ -75,13 +86,13 @@ bool KarplusStrongVoice::Process(double time, ChannelBuffer* out)
       }
       else
       {
-         oscPhaseInc = GetPhaseInc(mVoiceParams->mExciterFreq);
+         oscPhaseInc = GetPhaseInc(exciterFreq[pos]);
          mOsc.SetType(kOsc_Sin);
       }
       mOscPhase += oscPhaseInc;
       float sample = 0;
       float sinSample = mOsc.Audio(time, mOscPhase);
-      float noiseSample = RandomSample();
+      float noiseSample = noise(mNoiseGenerator);
       float pitchBlend = ofClamp((pitch - 40) / 60.0f,0,1);
       pitchBlend *= pitchBlend;
       if (mVoiceParams->mSourceType == kSourceTypeSin)
@@ -117,12 +128,12 @@ bool KarplusStrongVoice::Process(double time, ChannelBuffer* out)
       //AssertIfDenormal(feedbackSample);
       mFilterSample = feedbackSample;
       //sample += mFeedbackRamp.Value(time) * feedbackSample;
-      sample += feedbackSample * sqrtf(mVoiceParams->mFeedback) * mMuteRamp.Value(time);
+      sample += feedbackSample * sqrtf(feedback[pos]) * mMuteRamp.Value(time);
       FIX_DENORMAL(sample);
 
       mBuffer.Write(sample, 0);
 
-      float output = sample * mVoiceParams->mVol/10.0f * (1 + GetPressure(pos*renderRatio));
+      float output = sample * vol[pos]/10.0f * (1 + GetPressure(pos*renderRatio));
       AssertIfDenormal(output);
       
       gWorkBuffer[pos] = output;
@@ -164,6 +175,7 @@ bool KarplusStrongVoice::Process(double time, ChannelBuffer* out)
 void KarplusStrongVoice::Start(double time, float target)
 {
    mOscPhase = FPI/2;   //magic number that seems to keep things DC centered ok
+   mNoiseGenerator.seed(sNextNoiseSeed++);
    mEnv.Clear();
    mEnv.GetStageData(0).time = mVoiceParams->mExciterAttack;
    mEnv.GetStageData(1).time = mVoiceParams->mExciterDecay;
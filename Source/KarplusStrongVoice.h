@@ -17,6 +17,7 @@
 #include "EnvOscillator.h"
 #include "RollingBuffer.h"
 #include "Ramp.h"
+#include <random>
 
 class IDrawableModule;
 
@@ -79,6 +80,7 @@ private:
    float mLastBufferSample;
    bool mActive;
    IDrawableModule* mOwner;
+   std::minstd_rand mNoiseGenerator;   //each voice has its own, since voices can render on different threads at once
 };
 
 #endif /* defined(__modularSynth__KarplusStrongVoice__) */
@@ -11,78 +11,225 @@
 #ifndef LOCKFREEQUEUE_H_INCLUDED
 #define LOCKFREEQUEUE_H_INCLUDED
 
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace LockFreeQueueDetail
+{
+    const int kCacheLineSize = 64;
+    
+    inline uint32_t roundUpToPowerOfTwo (int capacity)
+    {
+        uint32_t size = 2;
+        while (size < (uint32_t) capacity)
+            size <<= 1;
+        return size;
+    }
+    
+    /**
+     * Counts items that didn't fit, and the fullest the queue has been.
+     * Both are only approximate when read from another thread.
+     */
+    class OverflowStats
+    {
+    public:
+        OverflowStats() : numOverflows (0), highWaterMark (0) {}
+        
+        int getNumOverflows() const   { return numOverflows.load (std::memory_order_relaxed); }
+        int getHighWaterMark() const  { return highWaterMark.load (std::memory_order_relaxed); }
+        void resetStats()             { numOverflows = 0; highWaterMark = 0; }
+        
+    protected:
+        void noteOverflow()           { numOverflows.fetch_add (1, std::memory_order_relaxed); }
+        void noteFill (int numItems)
+        {
+            int mark = highWaterMark.load (std::memory_order_relaxed);
+            while (numItems > mark && ! highWaterMark.compare_exchange_weak (mark, numItems, std::memory_order_relaxed))
+                ;
+        }
+        
+    private:
+        std::atomic<int> numOverflows;
+        std::atomic<int> highWaterMark;
+    };
+}
+
 /**
- * A simple single producer & consumer lock free queue, based on Herb Sutter's code:
- * http://www.drdobbs.com/parallel/writing-lock-free-code-a-corrected-queue/
- * 
- * This is a linked list, which can expand arbitrarily without losing old data,
- * but which has poor cache locality (I plan to write a ring buffer version soon).
+ * A fixed capacity single producer & single consumer wait-free queue.
+ *
+ * All storage is allocated up front, so produce() and consume() never touch the heap
+ * and are safe to call from the audio thread. The read and write positions live on
+ * separate cache lines so the two threads don't keep stealing the line from each other.
+ *
+ * When the queue is full, produce() drops the item, returns false and counts an overflow.
+ * The capacity is rounded up to a power of two.
  */
 template<typename T>
-class LockFreeQueue
+class LockFreeQueue : public LockFreeQueueDetail::OverflowStats
 {
 public:
-    LockFreeQueue()
+    explicit LockFreeQueue (int capacity = 1024)
+    : buffer (LockFreeQueueDetail::roundUpToPowerOfTwo (capacity))
+    , mask ((uint32_t) buffer.size() - 1)
+    , writePos (0)
+    , readPos (0)
     {
-        first = new Node (T()); // Dummy seperator.
-        
-        last.set (first);
-        divider.set (first);
     }
     
-    ~LockFreeQueue()
+    /**
+     * Add an item to the queue. Should only be called from producer's thread.
+     * Returns false if the queue was full and the item was dropped.
+     */
+    bool produce (const T& t)
     {
-        while (first != nullptr)
+        const uint32_t write = writePos.load (std::memory_order_relaxed);
+        const uint32_t numItems = write - readPos.load (std::memory_order_acquire);
+        
+        if (numItems > mask)
         {
-            Node* toDel = first;
-            first = toDel->next;
-            delete toDel;
+            noteOverflow();
+            return false;
         }
+        
+        buffer[write & mask] = t;
+        writePos.store (write + 1, std::memory_order_release);
+        noteFill ((int) numItems + 1);
+        return true;
     }
     
     /**
-     * Add an item to the queue. Obviously, should only be called from producer's thread.
+     * Consume an item in the queue. Returns false if no items left to consume.
+     * Should only be called from consumer's thread.
      */
-    void produce (const T& t)
+    bool consume (T& result)
     {
-        last.get()->next = new Node (t);
+        const uint32_t read = readPos.load (std::memory_order_relaxed);
+        
+        if (read == writePos.load (std::memory_order_acquire))
+            return false;
         
-        last.set (last.get()->next);
+        result = buffer[read & mask];
+        readPos.store (read + 1, std::memory_order_release);
+        return true;
+    }
+    
+    int getNumReady() const   { return (int) (writePos.load (std::memory_order_acquire) - readPos.load (std::memory_order_acquire)); }
+    int getCapacity() const   { return (int) buffer.size(); }
+    
+private:
+    std::vector<T> buffer;
+    const uint32_t mask;
+    
+    char padding1[LockFreeQueueDetail::kCacheLineSize];
+    std::atomic<uint32_t> writePos;
+    char padding2[LockFreeQueueDetail::kCacheLineSize];
+    std::atomic<uint32_t> readPos;
+    char padding3[LockFreeQueueDetail::kCacheLineSize];
+    
+    LockFreeQueue (const LockFreeQueue&);
+    LockFreeQueue& operator= (const LockFreeQueue&);
+};
+
+/**
+ * A fixed capacity multiple producer & single consumer queue, for when several threads
+ * (UI, MIDI devices, OSC) all feed the audio thread.
+ *
+ * Based on Dmitry Vyukov's bounded queue: each slot carries a sequence number, so
+ * producers only contend on claiming a slot and the consumer never waits on anybody.
+ * Like LockFreeQueue, it never allocates after construction and drops (and counts)
+ * items when full.
+ */
+template<typename T>
+class LockFreeMPSCQueue : public LockFreeQueueDetail::OverflowStats
+{
+public:
+    explicit LockFreeMPSCQueue (int capacity = 1024)
+    : cells (LockFreeQueueDetail::roundUpToPowerOfTwo (capacity))
+    , mask ((uint32_t) cells.size() - 1)
+    , writePos (0)
+    , readPos (0)
+    {
+        for (uint32_t i = 0; i < cells.size(); ++i)
+            cells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+    
+    /**
+     * Add an item to the queue. Can be called from any number of threads.
+     * Returns false if the queue was full and the item was dropped.
+     */
+    bool produce (const T& t)
+    {
+        uint32_t write = writePos.load (std::memory_order_relaxed);
         
-        while (first != divider.get() ) { // trim unused nodes
-            Node* tmp = first;
-            first = first->next;
-            delete tmp;
+        for (;;)
+        {
+            Cell& cell = cells[write & mask];
+            const int32_t diff = (int32_t) (cell.sequence.load (std::memory_order_acquire) - write);
+            
+            if (diff == 0)
+            {
+                if (writePos.compare_exchange_weak (write, write + 1, std::memory_order_relaxed))
+                {
+                    cell.value = t;
+                    cell.sequence.store (write + 1, std::memory_order_release);
+                    noteFill ((int) (write + 1 - readPos.load (std::memory_order_relaxed)));
+                    return true;
+                }
+            }
+            else if (diff < 0)
+            {
+                noteOverflow();
+                return false;
+            }
+            else
+            {
+                write = writePos.load (std::memory_order_relaxed);
+            }
         }
     }
     
     /**
      * Consume an item in the queue. Returns false if no items left to consume.
+     * Should only be called from consumer's thread.
      */
     bool consume (T& result)
     {
-        Node* div = divider.get();
+        const uint32_t read = readPos.load (std::memory_order_relaxed);
+        Cell& cell = cells[read & mask];
         
-        if (div != last.get() ) {             // if queue is nonempty
-            result = div->next->value;       // copy requested value
-            divider.set(div->next);         // publish that we took it
-            return true;
-        }
+        if ((int32_t) (cell.sequence.load (std::memory_order_acquire) - (read + 1)) < 0)
+            return false;   // empty, or the producer that claimed this slot hasn't finished writing it
         
-        return false;
+        result = cell.value;
+        cell.sequence.store (read + mask + 1, std::memory_order_release);
+        readPos.store (read + 1, std::memory_order_relaxed);
+        return true;
     }
     
+    int getCapacity() const   { return (int) cells.size(); }
+    
 private:
-    struct Node
+    struct Cell
     {
-        Node (const T& val) : value(val), next(nullptr) {}
+        Cell() : sequence (0) {}
+        Cell (const Cell& other) : sequence (other.sequence.load()), value (other.value) {}
         
+        std::atomic<uint32_t> sequence;
         T value;
-        Node* next;
     };
     
-    Node* first;
-    Atomic<Node*> divider, last;
+    std::vector<Cell> cells;
+    const uint32_t mask;
+    
+    char padding1[LockFreeQueueDetail::kCacheLineSize];
+    std::atomic<uint32_t> writePos;
+    char padding2[LockFreeQueueDetail::kCacheLineSize];
+    std::atomic<uint32_t> readPos;
+    char padding3[LockFreeQueueDetail::kCacheLineSize];
+    
+    LockFreeMPSCQueue (const LockFreeMPSCQueue&);
+    LockFreeMPSCQueue& operator= (const LockFreeMPSCQueue&);
 };
 
 
@@ -340,6 +340,9 @@ void Looper::Process(double time)
    int latencyOffset = 0;
    if (mPitchShift != 1)
       latencyOffset = mPitchShifter[0]->GetLatency();
+   
+   float writeMin = FLT_MAX;
+   float writeMax = -FLT_MAX;
 
    for (int i=0; i<bufferSize; ++i)
    {
@@ -383,7 +386,11 @@ void Looper::Process(double time)
          //write one sample the past so we don't end up feeding into the next output
          float writeAmount = mWriteInputRamp.Value(time);
          if (writeAmount > 0)
+         {
             WriteInterpolatedSample(offset-1, mBuffer->GetChannel(ch), mLoopLength, mLastInputSample[ch] * writeAmount);
+            writeMin = MIN(writeMin, offset-1);
+            writeMax = MAX(writeMax, offset-1);
+         }
          mLastInputSample[ch] = GetBuffer()->GetChannel(ch)[i];
 
          output[ch] *= volSq;
@@ -396,6 +403,15 @@ void Looper::Process(double time)
       time += gInvSampleRateMs;
    }
    
+   if (writeMin <= writeMax)
+   {
+      //let the waveform display know what we recorded over
+      if (writeMin < 0 || writeMax + 2 > mLoopLength)
+         mPeaks.Invalidate();
+      else
+         mPeaks.MarkDirty(int(writeMin), int(writeMax) + 2);
+   }
+   
    if (mPitchShift != 1)
    {
       for (int ch=0; ch<mBuffer->NumActiveChannels(); ++ch)
@@ -475,6 +491,8 @@ void Looper::DoCommit()
          }
       }
    }
+   
+   mPeaks.Invalidate();
 
    mClearCommitBuffer = true;
 }
@@ -482,6 +500,7 @@ void Looper::DoCommit()
 void Looper::Fill(ChannelBuffer* buffer, int length)
 {
    mBuffer->CopyFrom(buffer, length);
+   mPeaks.Invalidate();
 }
 
 void Looper::DoUndo()
@@ -643,6 +662,7 @@ void Looper::ResampleForNewSpeed()
       }
       delete[] oldBuffer;
    }
+   mPeaks.Invalidate();
    
    if (mKeepPitch)
    {
@@ -679,7 +699,8 @@ void Looper::DrawModule()
    
    float displayPos = GetActualLoopPos(0);
    mBufferMutex.lock();
-   DrawAudioBuffer(BUFFER_W, BUFFER_H, mBuffer, 0, mLoopLength, displayPos, mVol);
+   mPeaks.Update(mBuffer, mLoopLength);
+   DrawAudioBuffer(BUFFER_W, BUFFER_H, &mPeaks, 0, mLoopLength, displayPos, mVol);
    mBufferMutex.unlock();
    ofSetColor(255,255,0,gModuleDrawAlpha);
    for (int i=1; i<mNumBars; ++i)
@@ -898,6 +919,7 @@ void Looper::DrawBeatwheel()
 void Looper::Clear()
 {
    mBuffer->Clear();
+   mPeaks.Invalidate();
    mLastCommitTime = gTime;
    mVol = 1;
    mFourTet = 0;
@@ -916,6 +938,7 @@ void Looper::BakeVolume()
    mUndoBuffer->CopyFrom(mBuffer);
    for (int ch=0; ch<mBuffer->NumActiveChannels(); ++ch)
       Mult(mBuffer->GetChannel(ch), mVol*mVol, mLoopLength);
+   mPeaks.Invalidate();
    mVol = 1;
    mSmoothedVol = 1;
    mWantBakeVolume = false;
@@ -938,6 +961,7 @@ void Looper::UpdateNumBars(int oldNumBars)
          for (int ch=0; ch<mBuffer->NumActiveChannels(); ++ch)
             BufferCopy(mBuffer->GetChannel(ch)+oldLoopLength*i, mBuffer->GetChannel(ch), oldLoopLength);
       }
+      mPeaks.Invalidate();
    }
 }
 
@@ -970,6 +994,7 @@ void Looper::MergeIn(Looper* otherLooper)
       mBuffer->CopyFrom(otherLooper->mBuffer, mLoopLength);
       mVol = 1;
    }
+   mPeaks.Invalidate();
 
    otherLooper->Clear();
 
@@ -998,6 +1023,7 @@ void Looper::CopyBuffer(Looper* sourceLooper)
 {
    assert(sourceLooper);
    mBuffer->CopyFrom(sourceLooper->mBuffer);
+   mPeaks.Invalidate();
    SetLoopLength(sourceLooper->mLoopLength);
    mNumBars = sourceLooper->mNumBars;
 }
@@ -1062,6 +1088,7 @@ void Looper::SampleDropped(int x, int y, Sample* sample)
       for (int ch=0; ch<sample->NumChannels(); ++ch)
          mBuffer->GetChannel(ch)[i] = GetInterpolatedSample(offset, sample->Data()->GetChannel(ch), numSamples);
    }
+   mPeaks.Invalidate();
 }
 
 void Looper::GetModuleDimensions(int& width, int& height)
@@ -1256,6 +1283,7 @@ void Looper::DoShiftMeasure()
       mBuffer->SetChannelPointer(newBuffer, ch, true);
       mBufferMutex.unlock();
    }
+   mPeaks.Invalidate();
    mWantShiftMeasure = false;
 }
 
@@ -1271,6 +1299,7 @@ void Looper::DoHalfShift()
       mBuffer->SetChannelPointer(newBuffer, ch, true);
       mBufferMutex.unlock();
    }
+   mPeaks.Invalidate();
    mWantHalfShift = false;
 }
 
@@ -1286,6 +1315,7 @@ void Looper::DoShiftDownbeat()
       mBuffer->SetChannelPointer(newBuffer, ch, true);
       mBufferMutex.unlock();
    }
+   mPeaks.Invalidate();
    mWantShiftDownbeat = false;
 }
 
@@ -1301,6 +1331,7 @@ void Looper::DoShiftOffset()
       mBuffer->SetChannelPointer(newBuffer, ch, true);
       mBufferMutex.unlock();
    }
+   mPeaks.Invalidate();
    mWantShiftOffset = false;
    mLoopPosOffset = 0;
 }
@@ -1382,6 +1413,7 @@ void Looper::LoadState(FileStreamIn& in)
    in >> mLoopLength;
    int readLength;
    mBuffer->Load(in, readLength);
+   mPeaks.Invalidate();
    assert(mLoopLength == readLength);
 }
 
@@ -23,6 +23,7 @@
 #include "JumpBlender.h"
 #include "PitchShifter.h"
 #include "INoteReceiver.h"
+#include "PeakCache.h"
 
 class LooperRecorder;
 class Rewriter;
@@ -129,6 +130,7 @@ private:
    static const int BUFFER_H = 93;
 
    ChannelBuffer* mBuffer;
+   PeakCache mPeaks;
    ChannelBuffer mWorkBuffer;
    int mLoopLength;
    float mLoopPos;
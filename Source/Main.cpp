@@ -9,6 +9,8 @@
  */
 
 #include "../JuceLibraryCode/JuceHeader.h"
+#include "OfflineRenderer.h"
+#include "ModuleBenchmark.h"
 
 Component* createMainContentComponent();
 
@@ -28,6 +30,20 @@ public:
    {
       // This method is where you should put your application's initialisation code..
       
+      if (OfflineRenderer::IsRenderCommandLine(commandLine))
+      {
+         setApplicationReturnValue(OfflineRenderer::RunFromCommandLine(commandLine));
+         quit();
+         return;
+      }
+      
+      if (ModuleBenchmark::IsBenchmarkCommandLine(commandLine))
+      {
+         setApplicationReturnValue(ModuleBenchmark::RunFromCommandLine(commandLine));
+         quit();
+         return;
+      }
+      
       mainWindow = new MainWindow (getApplicationName());
    }
    
@@ -58,21 +58,22 @@ void Metronome::Process(double time)
 
 void Metronome::OnTimeEvent(int samplesTo)
 {
+   double time = gTime + samplesTo * gInvSampleRateMs;
    int step = TheTransport->GetQuantized(0,kInterval_4n);
    if (step == 0)
    {
       mPhaseInc = GetPhaseInc(880);
-      mOsc.Start(gTime,1,0,100,0,0);
+      mOsc.Start(time,1,0,100,0,0);
    }
    else if (step == 2)
    {
       mPhaseInc = GetPhaseInc(480);
-      mOsc.Start(gTime,1,0,70,0,0);
+      mOsc.Start(time,1,0,70,0,0);
    }
    else
    {
       mPhaseInc = GetPhaseInc(440);
-      mOsc.Start(gTime,.8f,0,50,0,0);
+      mOsc.Start(time,.8f,0,50,0,0);
    }
 }
 
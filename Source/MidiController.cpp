@@ -59,6 +59,8 @@ MidiController::MidiController()
 , mHighlightedLayoutElement(-1)
 , mLayoutWidth(0)
 , mLayoutHeight(0)
+, mQueuedMessages(1024)
+, mLastDrainTimeMs(0)
 {
    mListeners.resize(MAX_MIDI_PAGES);
    
@@ -242,44 +244,61 @@ void MidiController::OnTransportAdvanced(float amount)
 {
    Profiler profiler("MidiController");
    
-   mQueuedMessageMutex.lock();
+   //messages that arrived while the last block played are spread over the next one at the same
+   //relative position, trading a fixed block of latency for no jitter
+   double blockStartMs = mLastDrainTimeMs;
+   double blockEndMs = Time::getMillisecondCounterHiRes();
+   mLastDrainTimeMs = blockEndMs;
    
-   for (auto note = mQueuedNotes.begin(); note != mQueuedNotes.end(); ++note)
+   QueuedMidiMessage message;
+   while (mQueuedMessages.consume(message))
    {
-      int voiceIdx = -1;
-      
-      if (mUseChannelAsVoice)
-         voiceIdx = note->mChannel - 1;
-      
-      PlayNoteOutput(gTime, note->mPitch + mNoteOffset, MIN(127,note->mVelocity*mVelocityMult), voiceIdx, ModulationParameters(mModulation.GetPitchBend(voiceIdx), mModulation.GetModWheel(voiceIdx), mModulation.GetPressure(voiceIdx), 0));
-      
-      for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiNote(*note);
-   }
-   mQueuedNotes.clear();
-   
-   for (auto note = mQueuedControls.begin(); note != mQueuedControls.end(); ++note)
-   {
-      for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiControl(*note);
-   }
-   mQueuedControls.clear();
-   
-   for (auto note = mQueuedProgramChanges.begin(); note != mQueuedProgramChanges.end(); ++note)
-   {
-      for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiProgramChange(*note);
-   }
-   mQueuedProgramChanges.clear();
-   
-   for (auto note = mQueuedPitchBends.begin(); note != mQueuedPitchBends.end(); ++note)
-   {
-      for (auto i = mListeners[mControllerPage].begin(); i != mListeners[mControllerPage].end(); ++i)
-         (*i)->OnMidiPitchBend(*note);
+      auto& listeners = mListeners[mControllerPage];
+      switch (message.mType)
+      {
+         case kMidiMessage_Note:
+         {
+            int voiceIdx = -1;
+            
+            if (mUseChannelAsVoice)
+               voiceIdx = message.mNote.mChannel - 1;
+            
+            double time = gTime + GetSampleOffset(message.mArrivalTimeMs, blockStartMs, blockEndMs) * gInvSampleRateMs;
+            PlayNoteOutput(time, message.mNote.mPitch + mNoteOffset, MIN(127,message.mNote.mVelocity*mVelocityMult), voiceIdx, ModulationParameters(mModulation.GetPitchBend(voiceIdx), mModulation.GetModWheel(voiceIdx), mModulation.GetPressure(voiceIdx), 0));
+            
+            for (auto i = listeners.begin(); i != listeners.end(); ++i)
+               (*i)->OnMidiNote(message.mNote);
+            break;
+         }
+         case kMidiMessage_Control:
+            for (auto i = listeners.begin(); i != listeners.end(); ++i)
+               (*i)->OnMidiControl(message.mControl);
+            break;
+         case kMidiMessage_Program:
+            for (auto i = listeners.begin(); i != listeners.end(); ++i)
+               (*i)->OnMidiProgramChange(message.mProgramChange);
+            break;
+         case kMidiMessage_PitchBend:
+            for (auto i = listeners.begin(); i != listeners.end(); ++i)
+               (*i)->OnMidiPitchBend(message.mPitchBend);
+            break;
+      }
    }
-   mQueuedPitchBends.clear();
-   
-   mQueuedMessageMutex.unlock();
+}
+
+void MidiController::QueueMessage(QueuedMidiMessage& message)
+{
+   message.mArrivalTimeMs = Time::getMillisecondCounterHiRes();
+   if (!mQueuedMessages.produce(message) && mPrintInput)
+      ofLog() << Name() << " dropped a midi message, " << mQueuedMessages.getNumOverflows() << " dropped so far";
+}
+
+int MidiController::GetSampleOffset(double arrivalTimeMs, double blockStartMs, double blockEndMs) const
+{
+   if (blockEndMs <= blockStartMs || blockStartMs == 0)
+      return 0;
+   float blockPos = (arrivalTimeMs - blockStartMs) / (blockEndMs - blockStartMs);
+   return ofClamp(int(blockPos * gBufferSize), 0, gBufferSize-1);
 }
 
 void MidiController::OnMidiNote(MidiNote& note)
@@ -289,9 +308,10 @@ void MidiController::OnMidiNote(MidiNote& note)
    
    MidiReceived(kMidiMessage_Note, note.mPitch, note.mVelocity/127.0f, note.mChannel);
    
-   mQueuedMessageMutex.lock();
-   mQueuedNotes.push_back(note);
-   mQueuedMessageMutex.unlock();
+   QueuedMidiMessage message;
+   message.mType = kMidiMessage_Note;
+   message.mNote = note;
+   QueueMessage(message);
    
    if (mPrintInput)
       ofLog() << Name() << " note: " << note.mPitch << ", " << note.mVelocity;
@@ -317,9 +337,10 @@ void MidiController::OnMidiControl(MidiControl& control)
    
    MidiReceived(kMidiMessage_Control, control.mControl, control.mValue/127.0f, control.mChannel);
    
-   mQueuedMessageMutex.lock();
-   mQueuedControls.push_back(control);
-   mQueuedMessageMutex.unlock();
+   QueuedMidiMessage message;
+   message.mType = kMidiMessage_Control;
+   message.mControl = control;
+   QueueMessage(message);
    
    if (mPrintInput)
       ofLog() << Name() << " control: " << control.mControl << ", " << control.mValue;
@@ -347,9 +368,10 @@ void MidiController::OnMidiProgramChange(MidiProgramChange& program)
    
    MidiReceived(kMidiMessage_Program, program.mProgram, program.mChannel);
    
-   mQueuedMessageMutex.lock();
-   mQueuedProgramChanges.push_back(program);
-   mQueuedMessageMutex.unlock();
+   QueuedMidiMessage message;
+   message.mType = kMidiMessage_Program;
+   message.mProgramChange = program;
+   QueueMessage(message);
    
    if (mPrintInput)
       ofLog() << Name() << " program change: " << program.mProgram;
@@ -373,9 +395,10 @@ void MidiController::OnMidiPitchBend(MidiPitchBend& pitchBend)
    
    MidiReceived(kMidiMessage_PitchBend, MIDI_PITCH_BEND_CONTROL_NUM, pitchBend.mValue/16383.0f, pitchBend.mChannel);   //16383 = max pitch bend
  
-   mQueuedMessageMutex.lock();
-   mQueuedPitchBends.push_back(pitchBend);
-   mQueuedMessageMutex.unlock();
+   QueuedMidiMessage message;
+   message.mType = kMidiMessage_PitchBend;
+   message.mPitchBend = pitchBend;
+   QueueMessage(message);
    
    if (mPrintInput)
       ofLog() << Name() << " pitch bend: " << pitchBend.mValue;
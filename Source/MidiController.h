@@ -22,6 +22,7 @@
 #include "TextEntry.h"
 #include "ModulationChain.h"
 #include "INoteSource.h"
+#include "LockFreeQueue.h"
 
 #define MIDI_PITCH_BEND_CONTROL_NUM 999
 #define MIDI_PAGE_WIDTH 1000
@@ -337,10 +338,6 @@ private:
    Checkbox* mBindCheckbox;
    bool mTwoWay;
    ClickButton* mAddConnectionButton;
-   std::list<MidiNote> mQueuedNotes;
-   std::list<MidiControl> mQueuedControls;
-   std::list<MidiProgramChange> mQueuedProgramChanges;
-   std::list<MidiPitchBend> mQueuedPitchBends;
    DropdownList* mControllerList;
    Checkbox* mDrawCablesCheckbox;
    MappingDisplayMode mMappingDisplayMode;
@@ -366,7 +363,25 @@ private:
    int mLayoutHeight;
    list<GridLayout*> mGrids;
    
-   ofMutex mQueuedMessageMutex;
+   //incoming midi is handed to the audio thread through a preallocated queue, so a burst from
+   //a controller never blocks audio. arrival times let us spread the messages across the block
+   struct QueuedMidiMessage
+   {
+      MidiMessageType mType;
+      double mArrivalTimeMs;
+      union
+      {
+         MidiNote mNote;
+         MidiControl mControl;
+         MidiProgramChange mProgramChange;
+         MidiPitchBend mPitchBend;
+      };
+   };
+   void QueueMessage(QueuedMidiMessage& message);
+   int GetSampleOffset(double arrivalTimeMs, double blockStartMs, double blockEndMs) const;
+   
+   LockFreeMPSCQueue<QueuedMidiMessage> mQueuedMessages;
+   double mLastDrainTimeMs;
 };
 
 #endif /* defined(__modularSynth__MidiController__) */
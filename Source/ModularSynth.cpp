@@ -41,7 +41,16 @@ void AtExit()
 ModularSynth::ModularSynth()
 : mMoveModule(nullptr)
 , mOutputBuffer(RECORDING_LENGTH)
+, mGraphEditDepth(0)
+, mSourcesChanged(false)
+, mAudioSuspendDepth(0)
+, mAudioSuspended(false)
 , mAudioPaused(false)
+, mInAudioBlock(false)
+, mAudioBlocksDone(0)
+, mAudioBlockWaiters(0)
+, mAudioThreadTask(nullptr)
+, mAudioThreadTaskDone(false)
 , mClickStartX(INT_MAX)
 , mClickStartY(INT_MAX)
 , mHeldSample(nullptr)
@@ -49,6 +58,7 @@ ModularSynth::ModularSynth()
 , mLastClickedModule(nullptr)
 , mInitialized(false)
 , mRecordingLength(0)
+, mOutputFramesWritten(0)
 , mGroupSelectContext(nullptr)
 , mResizeModule(nullptr)
 , mShowLoadStatePopup(false)
@@ -57,23 +67,36 @@ ModularSynth::ModularSynth()
 , mQuickSpawn(nullptr)
 , mScheduledEnvelopeEditorSpawnDisplay(nullptr)
 , mIsLoadingModule(false)
+, mNumPendingSaves(0)
+, mSavesDone(true)
+, mSaveStatePool(1)
 {
    mConsoleText[0] = 0;
    assert(TheSynth == nullptr);
    TheSynth = this;
+   TheDeadlineMonitor = &mDeadlineMonitor;
+   TheSampleCache = &mSampleCache;
+   TheVoiceRenderPool = &mVoiceRenderPool;
    
-   mSaveOutputBuffer[0] = new float[RECORDING_LENGTH];
-   mSaveOutputBuffer[1] = new float[RECORDING_LENGTH];
+   for (int i=0; i<MAX_INPUT_CHANNELS; ++i)
+      mInput[i] = nullptr;
+   for (int i=0; i<MAX_OUTPUT_CHANNELS; ++i)
+      mOutput[i] = nullptr;
    
    mOutputBuffer.SetNumChannels(2);
 }
 
 ModularSynth::~ModularSynth()
 {
+   WaitForPendingSaves();
+   
    DeleteAllModules();
    
    SetMemoryTrackingEnabled(false); //avoid crashes when the tracking lists themselves are deleted
    
+   TheDeadlineMonitor = nullptr;
+   TheSampleCache = nullptr;
+   TheVoiceRenderPool = nullptr;
    assert(TheSynth == this);
    TheSynth = nullptr;
 }
@@ -88,12 +111,19 @@ void ModularSynth::Setup(GlobalManagers* globalManagers, juce::Component* mainCo
    mGlobalManagers = globalManagers;
    mMainComponent = mainComponent;
    
+   Profiler::RegisterThread();
+   Profiler::ReserveThreads(2);  //the audio device's input and output threads, which might not be the same one
+   
    bool loaded = mUserPrefs.open(ofToDataPath("userprefs.json"));
    if (loaded)
    {
       SetGlobalBufferSize(mUserPrefs["buffersize"].asInt());
       mIOBufferSize = gBufferSize;
       gSampleRate = mUserPrefs["samplerate"].asInt();
+      if (mUserPrefs.isMember("audio_threads"))
+         mAudioGraph.SetNumWorkers(mUserPrefs["audio_threads"].asInt() - 1);
+      if (mUserPrefs.isMember("voice_threads"))
+         mVoiceRenderPool.SetNumWorkers(mUserPrefs["voice_threads"].asInt());
       int width = mUserPrefs["width"].asInt();
       int height = mUserPrefs["height"].asInt();
       if (width > 1 && height > 1)
@@ -147,6 +177,8 @@ void ModularSynth::Poll()
    
    mZoomer.Update();
    mModuleContainer.Poll();
+   mAudioGraph.FreeRetiredPlan();
+   TheTransport->ApplyAudioThreadEdits();
    
    if (mShowLoadStatePopup)
    {
@@ -165,6 +197,8 @@ void ModularSynth::Poll()
 
 void ModularSynth::DeleteAllModules()
 {
+   SuspendAudio();
+   
    mModuleContainer.Clear();
    
    for (int i=0; i<mDeletedModules.size(); ++i)
@@ -177,6 +211,8 @@ void ModularSynth::DeleteAllModules()
    TheTransport = nullptr;
    delete mConsoleListener;
    mConsoleListener = nullptr;
+   
+   ResumeAudio();
 }
 
 bool SortPointsByY(ofVec2f a, ofVec2f b)
@@ -287,6 +323,7 @@ void ModularSynth::Draw(void* vg)
    ofPopMatrix();
    
    Profiler::Draw();
+   mAudioGraph.Draw();
    
    DrawConsole();
    
@@ -364,10 +401,11 @@ void ModularSynth::DrawConsole()
 
 void ModularSynth::Exit()
 {
-   mAudioThreadMutex.Lock("exiting");
+   SuspendAudio();
    mAudioPaused = true;
-   mAudioThreadMutex.Unlock();
+   ResumeAudio();
    mSoundStream.stop();
+   mOutputRecorder.Stop();
    mModuleContainer.Exit();
    DeleteAllModules();
    ofExit();
@@ -875,10 +913,9 @@ void ModularSynth::OnModuleDeleted(IDrawableModule* module)
    if (module->IsSingleton())
       return;
    
+   //not deleted until the layout is reset, so the audio thread can finish a block that's still using it
    mDeletedModules.push_back(module);
    
-   mAudioThreadMutex.Lock("delete");
-   
    list<PatchCable*> cablesToRemove;
    for (auto* cable : mPatchCables)
    {
@@ -889,6 +926,7 @@ void ModularSynth::OnModuleDeleted(IDrawableModule* module)
       RemoveFromVector(cable, mPatchCables);
    
    RemoveFromVector(dynamic_cast<IAudioSource*>(module),mSources);
+   PublishSources();
    RemoveFromVector(module,mLissajousDrawers);
    TheTransport->RemoveAudioPoller(dynamic_cast<IAudioPoller*>(module));
    //delete module; TODO(Ryan) deleting is hard... need to clear out everything with a reference to this, or switch to smart pointers
@@ -902,17 +940,15 @@ void ModularSynth::OnModuleDeleted(IDrawableModule* module)
    
    for (int i=0; i<MAX_INPUT_CHANNELS; ++i)
    {
-      if (module == mInput[i])
+      if (module == mInput[i].load())
          mInput[i] = nullptr;
    }
    
    for (int i=0; i<MAX_OUTPUT_CHANNELS; ++i)
    {
-      if (module == mOutput[i])
+      if (module == mOutput[i].load())
          mOutput[i] = nullptr;
    }
-   
-   mAudioThreadMutex.Unlock();
 }
 
 void ModularSynth::MouseReleased(int intX, int intY, int button)
@@ -971,53 +1007,62 @@ void ModularSynth::AudioOut(float** output, int bufferSize, int nChannels)
 {
    Profiler profiler("audioOut() total", true);
    
-   if (mAudioPaused)
-      return;
+   //the ui thread never holds us up. it publishes its changes for us to pick up here, between blocks
+   mInAudioBlock.store(true);
+   RunAudioThreadTask();
    
-   ScopedMutex mutex(&mAudioThreadMutex, "audioOut()");
+   if (mAudioPaused || mAudioSuspended)
+   {
+      for (int ch=0; ch<nChannels; ++ch)
+         Clear(output[ch], bufferSize);
+      FinishAudioBlock();
+      return;
+   }
    
    assert(nChannels <= MAX_OUTPUT_CHANNELS);
    
    /////////// AUDIO PROCESSING STARTS HERE /////////////
    float* outBuffer[MAX_OUTPUT_CHANNELS];
+   OutputChannel* outputs[MAX_OUTPUT_CHANNELS];
    assert(bufferSize == mIOBufferSize);
    assert(mIOBufferSize == gBufferSize);  //need to be the same for now
                                           //if we want these different, need to fix outBuffer here, and also fix audioIn()
    for (int ioOffset = 0; ioOffset < mIOBufferSize; ioOffset += gBufferSize)
    {
-      if (TheVinylTempoControl &&
-          mInput[TheVinylTempoControl->GetLeftChannel()-1] &&
-          mInput[TheVinylTempoControl->GetRightChannel()-1])
+      VinylTempoControl* vinylTempoControl = TheVinylTempoControl;
+      if (vinylTempoControl)
       {
-         TheVinylTempoControl->SetVinylControlInput(
-               mInput[TheVinylTempoControl->GetLeftChannel()-1]->GetBuffer()->GetChannel(0),
-               mInput[TheVinylTempoControl->GetRightChannel()-1]->GetBuffer()->GetChannel(0), gBufferSize);
+         InputChannel* left = mInput[vinylTempoControl->GetLeftChannel()-1];
+         InputChannel* right = mInput[vinylTempoControl->GetRightChannel()-1];
+         if (left && right)
+            vinylTempoControl->SetVinylControlInput(left->GetBuffer()->GetChannel(0), right->GetBuffer()->GetChannel(0), gBufferSize);
       }
 
       for (int i=0; i<nChannels; ++i)
       {
-         if (mOutput[i])
-            mOutput[i]->ClearBuffer();
+         outputs[i] = mOutput[i];
+         if (outputs[i])
+            outputs[i]->ClearBuffer();
       }
       
       //get audio from sources
-      for (int i=0; i<mSources.size(); ++i)
-         mSources[i]->Process(gTime);
+      mAudioGraph.Process(gTime);
       
       //put it into speakers
       for (int i=0; i<MAX_OUTPUT_CHANNELS; ++i)
          outBuffer[i] = gZeroBuffer;
       for (int i=0; i<nChannels; ++i)
       {
-         if (mOutput[i])
+         if (outputs[i])
          {
-            mOutput[i]->Process();
-            outBuffer[i] = mOutput[i]->GetBuffer()->GetChannel(0);
+            outputs[i]->Process();
+            outBuffer[i] = outputs[i]->GetBuffer()->GetChannel(0);
          }
       }
       
-      if (TheMultitrackRecorder)
-         TheMultitrackRecorder->Process(gTime, outBuffer[0], outBuffer[1], gBufferSize);
+      MultitrackRecorder* multitrackRecorder = TheMultitrackRecorder;
+      if (multitrackRecorder)
+         multitrackRecorder->Process(gTime, outBuffer[0], outBuffer[1], gBufferSize);
       
       for (int ch=0; ch<nChannels; ++ch)
          BufferCopy(output[ch]+ioOffset, outBuffer[ch]+ioOffset, gBufferSize);
@@ -1032,25 +1077,125 @@ void ModularSynth::AudioOut(float** output, int bufferSize, int nChannels)
    mOutputBuffer.WriteChunk(outBuffer[1], bufferSize, 1);
    mRecordingLength += bufferSize;
    mRecordingLength = MIN(mRecordingLength, RECORDING_LENGTH);
+   mOutputFramesWritten.store(mOutputFramesWritten.load(std::memory_order_relaxed) + bufferSize, std::memory_order_release);
+   mOutputRecorder.Write(outBuffer, 2, bufferSize);
    
-   Profiler::PrintCounters();
+   FinishAudioBlock();
 }
 
 void ModularSynth::AudioIn(const float** input, int bufferSize, int nChannels)
 {
-   if (mAudioPaused)
+   mInAudioBlock.store(true);   //the block starts here, AudioOut() finishes it
+   if (mAudioPaused || mAudioSuspended)
       return;
-   
-   ScopedMutex mutex(&mAudioThreadMutex, "audioIn()");
 
    assert(bufferSize == mIOBufferSize);
    assert(nChannels <= MAX_INPUT_CHANNELS);
    
    for (int i=0; i<nChannels; ++i)
    {
-      if (mInput[i])
-         BufferCopy(mInput[i]->GetBuffer()->GetChannel(0), input[i], bufferSize);
+      InputChannel* inputChannel = mInput[i];
+      if (inputChannel)
+         BufferCopy(inputChannel->GetBuffer()->GetChannel(0), input[i], bufferSize);
+   }
+}
+
+void ModularSynth::BeginGraphEdit()
+{
+   if (mGraphEditDepth++ == 0 && TheTransport)
+      TheTransport->SetHoldingNewListeners(true);
+}
+
+void ModularSynth::EndGraphEdit()
+{
+   assert(mGraphEditDepth > 0);
+   if (--mGraphEditDepth > 0)
+      return;
+   
+   if (mSourcesChanged)
+   {
+      mSourcesChanged = false;
+      mAudioGraph.SetSources(mSources);
    }
+   if (TheTransport)
+      TheTransport->SetHoldingNewListeners(false);
+}
+
+void ModularSynth::PublishSources()
+{
+   if (mGraphEditDepth > 0)
+      mSourcesChanged = true;
+   else
+      mAudioGraph.SetSources(mSources);
+}
+
+//for tearing down modules. blocks that start before ResumeAudio() put out silence without touching anything
+void ModularSynth::SuspendAudio()
+{
+   if (mAudioSuspendDepth++ > 0)
+      return;
+   mAudioSuspended.store(true);
+   WaitForAudioBlock();
+}
+
+void ModularSynth::ResumeAudio()
+{
+   assert(mAudioSuspendDepth > 0);
+   if (--mAudioSuspendDepth == 0)
+      mAudioSuspended.store(false);
+}
+
+//returns once the block that was running when we got here (if there was one) has finished
+void ModularSynth::WaitForAudioBlock()
+{
+   int64 blocksDone = mAudioBlocksDone.load();
+   ++mAudioBlockWaiters;
+   while (mInAudioBlock.load() && mAudioBlocksDone.load() == blocksDone)
+      mAudioBlockDone.wait(10);
+   --mAudioBlockWaiters;
+}
+
+void ModularSynth::RunOnAudioThread(std::function<void()> task)
+{
+   ScopedLock lock(mAudioThreadTaskMutex);
+   
+   mAudioThreadTaskDone.store(false);
+   mAudioThreadTask.store(&task);
+   ++mAudioBlockWaiters;
+   while (!mAudioThreadTaskDone.load())
+   {
+      if (!mAudioBlockDone.wait(100))
+      {
+         //nothing has come through the audio callback in a while, so the device is probably stopped
+         std::function<void()>* expected = &task;
+         if (mAudioThreadTask.compare_exchange_strong(expected, nullptr))
+         {
+            SuspendAudio();
+            task();
+            ResumeAudio();
+            break;
+         }
+      }
+   }
+   --mAudioBlockWaiters;
+}
+
+void ModularSynth::RunAudioThreadTask()
+{
+   std::function<void()>* task = mAudioThreadTask.exchange(nullptr);
+   if (task != nullptr)
+   {
+      (*task)();
+      mAudioThreadTaskDone.store(true);
+   }
+}
+
+void ModularSynth::FinishAudioBlock()
+{
+   mInAudioBlock.store(false);
+   ++mAudioBlocksDone;
+   if (mAudioBlockWaiters.load() > 0)
+      mAudioBlockDone.signal();
 }
 
 void ModularSynth::FilesDropped(vector<string> files, int intX, int intY)
@@ -1154,10 +1299,14 @@ void ModularSynth::ArrangeAudioSourceDependencies()
    /*ofLog() << "new ordering:";
    for (int i=0; i<mSources.size(); ++i)
       ofLog() << dynamic_cast<IDrawableModule*>(mSources[i])->Name();*/
+   
+   PublishSources();
 }
 
 void ModularSynth::ResetLayout()
 {
+   SuspendAudio();   //everything is about to be deleted out from under the audio thread
+   
    mModuleContainer.Clear();
    
    for (int i=0; i<mDeletedModules.size(); ++i)
@@ -1170,6 +1319,7 @@ void ModularSynth::ResetLayout()
 
    mDeletedModules.clear();
    mSources.clear();
+   mAudioGraph.SetSources(mSources);   //right away, even during a graph edit, so nothing deleted is left in the plan
    mLissajousDrawers.clear();
    mMoveModule = nullptr;
    LFOPool::Shutdown();
@@ -1216,14 +1366,14 @@ void ModularSynth::ResetLayout()
    
    mDrawOffset.set(0,0);
    mZoomer.Init();
+   
+   ResumeAudio();
 }
 
 bool ModularSynth::SetInputChannel(int channel, InputChannel* input)
 {
    assert(channel > 0 && channel <= MAX_INPUT_CHANNELS);
    
-   //ScopedMutex mutex(&mAudioThreadMutex, "SetInputChannel()");
-   
    for (int i=0; i<MAX_INPUT_CHANNELS; ++i)  //remove if we're changing an already assigned channel
    {
       if (mInput[channel-1] == input)
@@ -1243,7 +1393,6 @@ bool ModularSynth::SetOutputChannel(int channel, OutputChannel* output)
 {
    assert(channel > 0 && channel <= MAX_OUTPUT_CHANNELS);
    
-   //ScopedMutex mutex(&mAudioThreadMutex, "SetOutputChannel()");
    if (mOutput[channel-1] == nullptr)
    {
       mOutput[channel-1] = output;
@@ -1292,7 +1441,7 @@ void ModularSynth::LoadLayout(ofxJSONElement json)
 {
    //ofLoadURLAsync("http://bespoke.com/telemetry/"+jsonFile);
    
-   ScopedMutex mutex(&mAudioThreadMutex, "LoadLayout()");
+   ScopedGraphEdit edit;
    ScopedLock renderLock(mRenderLock);
    
    ResetLayout();
@@ -1368,7 +1517,10 @@ void ModularSynth::OnModuleAdded(IDrawableModule* module)
 {
    IAudioSource* source = dynamic_cast<IAudioSource*>(module);
    if (source)
+   {
       mSources.push_back(source);
+      PublishSources();
+   }
 }
 
 void ModularSynth::AddDynamicModule(IDrawableModule* module)
@@ -1469,6 +1621,8 @@ void ModularSynth::LogEvent(string event, LogEventType type)
 
 IDrawableModule* ModularSynth::DuplicateModule(IDrawableModule* module)
 {
+   ScopedGraphEdit edit;   //the copy only starts running once it has the original's state
+   
    {
       FileStreamOut out(ofToDataPath("tmp").c_str());
       module->SaveState(out);
@@ -1555,35 +1709,80 @@ void ModularSynth::LoadStatePopupImp()
 
 void ModularSynth::SaveState(string file)
 {
-   mAudioThreadMutex.Lock("SaveState()");
+   bool compress = mUserPrefs.isMember("compress_save_state") && mUserPrefs["compress_save_state"].asBool();
+   SaveStateJob* job = new SaveStateJob(this, ofToDataPath(file), compress);
    
-   FileStreamOut out(ofToDataPath(file).c_str());
+   job->mLayout = GetLayout().getRawString(true);
    
-   out << GetLayout().getRawString(true);
-   mModuleContainer.SaveState(out);
+   //the modules' settings get taken with the audio suspended, so nothing changes while they're read. their big
+   //buffers are only pointed at then, and get copied out afterwards while the audio keeps running, the same way
+   //they're read for drawing. the audio thread can swap out channel data in the meantime (looper shifts do), so
+   //anything it lets go of is held onto until we're done
+   ChannelBuffer::HoldFrees(true);
+   SuspendAudio();
+   mModuleContainer.SaveState(job->mChunks);
+   ResumeAudio();
+   for (auto& chunk : job->mChunks)
+      FileStreamOut::ResolveBufferRefs(chunk.mData, chunk.mBufferRefs);
+   ChannelBuffer::HoldFrees(false);
    
-   mAudioThreadMutex.Unlock();
+   //compressing and writing happens on mSaveStatePool
+   ++mNumPendingSaves;
+   mSavesDone.reset();
+   mSaveStatePool.addJob(job, true);
+}
+
+ThreadPoolJob::JobStatus ModularSynth::SaveStateJob::runJob()
+{
+   //goes through a temporary file, so a crash partway through doesn't take out the last save
+   if (!SaveStateFile::Write(File(mPath), mLayout, mChunks, mCompress))
+      ofLog() << "error: couldn't write save state to " << mPath;
+   if (--mOwner->mNumPendingSaves == 0)
+      mOwner->mSavesDone.signal();
+   return jobHasFinished;
+}
+
+void ModularSynth::WaitForPendingSaves()
+{
+   while (mNumPendingSaves > 0)
+      mSavesDone.wait();
 }
 
 void ModularSynth::LoadState(string file)
 {
-   mAudioThreadMutex.Lock("LoadState()");
-   LockRender(true);
+   WaitForPendingSaves();  //in case we're loading something that's still being written
    
-   FileStreamIn in(ofToDataPath(file).c_str());
+   //map the file and start checking its chunks before we touch the layout
+   SaveStateFile stateFile(File(ofToDataPath(file)));
    
-   string jsonString;
-   in >> jsonString;
-   LoadLayoutFromString(jsonString);
+   BeginGraphEdit();   //so the audio thread doesn't pick up the new modules until their state is loaded
+   LockRender(true);
    
-   mIsLoadingModule = true;
-   mModuleContainer.LoadState(in);
-   mIsLoadingModule = false;
+   if (stateFile.IsValid())
+   {
+      LoadLayoutFromString(stateFile.GetLayout());
+      
+      mIsLoadingModule = true;
+      mModuleContainer.LoadState(stateFile);
+      mIsLoadingModule = false;
+   }
+   else  //older flat format
+   {
+      FileStreamIn in(ofToDataPath(file).c_str());
+      
+      string jsonString;
+      in >> jsonString;
+      LoadLayoutFromString(jsonString);
+      
+      mIsLoadingModule = true;
+      mModuleContainer.LoadState(in);
+      mIsLoadingModule = false;
+   }
    
-   TheTransport->Reset();
-   
    LockRender(false);
-   mAudioThreadMutex.Unlock();
+   EndGraphEdit();
+   
+   RunOnAudioThread([]() { TheTransport->Reset(); });
 }
 
 IAudioReceiver* ModularSynth::FindAudioReceiver(string name, bool fail)
@@ -1650,10 +1849,8 @@ void ModularSynth::OnConsoleInput()
       }
       else if (tokens[0] == "clearall")
       {
-         mAudioThreadMutex.Lock("clearall");
          ScopedLock renderLock(mRenderLock);
          ResetLayout();
-         mAudioThreadMutex.Unlock();
       }
       else if (tokens[0] == "load")
       {
@@ -1670,13 +1867,55 @@ void ModularSynth::OnConsoleInput()
       {
          SaveOutput();
       }
+      else if (tokens[0] == "record")
+      {
+         SetRecordingOutput(!IsRecordingOutput());
+      }
       else if (tokens[0] == "reconnect")
       {
          ReconnectMidiDevices();
       }
       else if (tokens[0] == "profiler")
       {
-         Profiler::ToggleProfiler();
+         if (tokens.size() >= 2 && tokens[1] == "trace")
+         {
+            string path = tokens.size() >= 3 ? tokens[2] : ofGetTimestampString("recordings/trace_%Y-%m-%d_%H-%M-%S.json");
+            if (Profiler::SaveTrace(path))
+               LogEvent("saved profiler trace to "+path, kLogEventType_Normal);
+            else
+               LogEvent("couldn't save profiler trace to "+path, kLogEventType_Error);
+         }
+         else
+         {
+            Profiler::ToggleProfiler();
+         }
+      }
+      else if (tokens[0] == "deadline")
+      {
+         if (tokens.size() >= 2 && tokens[1] == "reset")
+         {
+            mDeadlineMonitor.Reset();
+         }
+         else
+         {
+            for (auto line : mDeadlineMonitor.GetReport())
+            {
+               ofLog() << line;
+               LogEvent(line, kLogEventType_Normal);
+            }
+         }
+      }
+      else if (tokens[0] == "audiothreads")
+      {
+         if (tokens.size() >= 2)
+            mAudioGraph.SetNumWorkers(atoi(tokens[1].c_str()) - 1);
+         LogEvent("processing audio on "+ofToString(mAudioGraph.GetNumWorkers() + 1)+" thread(s)", kLogEventType_Normal);
+      }
+      else if (tokens[0] == "voicethreads")
+      {
+         if (tokens.size() >= 2)
+            mVoiceRenderPool.SetNumWorkers(atoi(tokens[1].c_str()));
+         LogEvent("rendering parallel voices with "+ofToString(mVoiceRenderPool.GetNumWorkers())+" extra thread(s)", kLogEventType_Normal);
       }
       else if (tokens[0] == "clear")
       {
@@ -1743,6 +1982,13 @@ void ModularSynth::OnConsoleInput()
       {
          LoadState("savestate/quicksave.bsk");
       }
+#if JUCE_UNIT_TESTS
+      else if (tokens[0] == "runtests")
+      {
+         UnitTestRunner runner;
+         runner.runAllTests();
+      }
+#endif
       else
       {
          ofLog() << "Creating: " << mConsoleText;
@@ -1794,7 +2040,7 @@ IDrawableModule* ModularSynth::SpawnModuleOnTheFly(string moduleName, float x, f
    IDrawableModule* module = nullptr;
    try
    {
-      ScopedMutex mutex(&mAudioThreadMutex, "CreateModule");
+      ScopedGraphEdit edit;
       module = CreateModule(dummy);
       if (module != nullptr)
       {
@@ -1837,26 +2083,96 @@ void ModularSynth::ReconnectMidiDevices()
 
 void ModularSynth::SaveOutput()
 {
-   ScopedMutex mutex(&mAudioThreadMutex, "SaveOutput()");
-
    string filename = ofGetTimestampString("recordings/recording_%Y-%m-%d_%H-%M.wav");
    //string filenamePos = ofGetTimestampString("recordings/pos_%Y-%m-%d_%H-%M.wav");
 
-   assert(mRecordingLength <= RECORDING_LENGTH);
+   //only the extent of the recording is taken between audio blocks. the samples are read straight out of the
+   //rolling buffer while the audio keeps running, oldest first, staying ahead of the audio thread writing over them
+   int64 endFrame;
+   int length;
+   RunOnAudioThread([this, &endFrame, &length]()
+   {
+      assert(mRecordingLength <= RECORDING_LENGTH);
+      length = (int)mRecordingLength;
+      endFrame = mOutputFramesWritten.load(std::memory_order_relaxed);
+      mRecordingLength = 0;
+   });
+   
+   ScopedPointer<WavAudioFormat> wavFormat = new WavAudioFormat();
+   File outputFile(ofToDataPath(filename).c_str());
+   outputFile.create();
+   ScopedPointer<AudioFormatWriter> writer = wavFormat->createWriterFor(outputFile.createOutputStream(), gSampleRate, 2, 16, nullptr, 0);
+   if (writer == nullptr)
+   {
+      ofLog() << "couldn't write " << filename;
+      return;
+   }
    
-   for (int i=0; i<mRecordingLength; ++i)
+   const int kChunkSize = 65536;
+   const int64 kOverwriteMargin = gSampleRate;   //room for the block being written while we copy
+   ChannelBuffer chunk(kChunkSize);
+   chunk.SetNumActiveChannels(2);
+   const float* chunkData[2] = { chunk.GetChannel(0), chunk.GetChannel(1) };
+   int ringSize = mOutputBuffer.Size();
+   int64 skipped = 0;
+   int64 frame = endFrame - length;
+   while (frame < endFrame)
    {
-      mSaveOutputBuffer[0][i] = mOutputBuffer.GetSample(mRecordingLength-i-1, 0);
-      mSaveOutputBuffer[1][i] = mOutputBuffer.GetSample(mRecordingLength-i-1, 1);
+      int64 oldestSafe = mOutputFramesWritten.load(std::memory_order_acquire) + kOverwriteMargin - ringSize;
+      if (frame < oldestSafe)
+      {
+         int64 skip = MIN(oldestSafe, endFrame) - frame;
+         skipped += skip;
+         frame += skip;
+         continue;
+      }
+      
+      int numFrames = (int)MIN(int64(kChunkSize), endFrame - frame);
+      int ringPos = int(frame % ringSize);
+      int firstPart = MIN(numFrames, ringSize - ringPos);
+      for (int ch=0; ch<2; ++ch)
+      {
+         const float* ring = mOutputBuffer.GetRawBuffer()->GetChannel(ch);
+         BufferCopy(chunk.GetChannel(ch), ring + ringPos, firstPart);
+         BufferCopy(chunk.GetChannel(ch) + firstPart, ring, numFrames - firstPart);
+      }
+      
+      if (mOutputFramesWritten.load(std::memory_order_acquire) + kOverwriteMargin - ringSize > frame)
+         continue;   //written over while we were copying, go around and skip past it
+      
+      writer->writeFromFloatArrays(chunkData, 2, numFrames);
+      frame += numFrames;
    }
-
-   Sample::WriteDataToFile(filename.c_str(), mSaveOutputBuffer, mRecordingLength, 2);
+   
+   if (skipped > 0)
+      ofLog() << "dropped the oldest " << skipped / float(gSampleRate) << " seconds of " << filename << ", the output wrapped around before they were saved";
    
    //mOutputBufferMeasurePos.ReadChunk(mSaveOutputBuffer, mRecordingLength);
    //Sample::WriteDataToFile(filenamePos.c_str(), mSaveOutputBuffer, mRecordingLength, 1);
+}
+
+void ModularSynth::SetRecordingOutput(bool record)
+{
+   if (record == mOutputRecorder.IsRecording())
+      return;
    
-   mOutputBuffer.ClearBuffer();
-   mRecordingLength = 0;
+   if (record)
+   {
+      string filename = ofGetTimestampString("recordings/recording_%Y-%m-%d_%H-%M-%S.wav");
+      if (mOutputRecorder.Start(filename, 2))
+         LogEvent("recording output to "+filename, kLogEventType_Normal);
+      else
+         LogEvent("couldn't record output to "+filename, kLogEventType_Error);
+   }
+   else
+   {
+      mOutputRecorder.Stop();
+      string info = "recorded "+ofToString(mOutputRecorder.GetRecordedSeconds(), 1)+" seconds to "+mOutputRecorder.GetPath();
+      if (mOutputRecorder.GetNumDroppedBlocks() > 0)
+         LogEvent(info+" ("+ofToString(mOutputRecorder.GetNumDroppedBlocks())+" blocks dropped, disk couldn't keep up)", kLogEventType_Error);
+      else
+         LogEvent(info, kLogEventType_Normal);
+   }
 }
 
 void ConsoleListener::TextEntryActivated(TextEntry* entry)
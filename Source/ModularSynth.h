@@ -13,6 +13,13 @@
 #include "LocationZoomer.h"
 #include "EffectFactory.h"
 #include "ModuleContainer.h"
+#include "AudioGraphScheduler.h"
+#include "DeadlineMonitor.h"
+#include "SampleCache.h"
+#include "DiskRecorder.h"
+#include "VoiceRenderPool.h"
+#include <atomic>
+#include <functional>
 
 class IAudioSource;
 class InputChannel;
@@ -56,6 +63,7 @@ public:
    void Setup(GlobalManagers* globalManagers, juce::Component* mainComponent);
    void LoadResources(void* nanoVG, void* fontBoundsNanoVG);
    void Poll();
+   void SkipStartupLayout() { mInitialized = true; }   //when something other than the user's layout is loaded at startup
    void Draw(void* vg);
    
    void Exit();
@@ -138,13 +146,19 @@ public:
    void RegisterPatchCable(PatchCable* cable);
    void UnregisterPatchCable(PatchCable* cable);
    
+   //the audio thread never waits on any of these. changes made between BeginGraphEdit() and EndGraphEdit() reach
+   //it together when the outermost edit ends, so it never runs a module that's only half set up
+   void BeginGraphEdit();
+   void EndGraphEdit();
+   void RunOnAudioThread(std::function<void()> task);   //runs task between two audio blocks, returns once it has
+   
    template<class T> vector<string> GetModuleNames() { return mModuleContainer.GetModuleNames<T>(); }
    
    void LockRender(bool lock) { if (lock) { mRenderLock.enter(); } else { mRenderLock.exit(); } }
    void UpdateFrameRate(float fps) { mFrameRate = fps; }
    float GetFrameRate() const { return mFrameRate; }
    CriticalSection* GetRenderLock() { return &mRenderLock; }
-   NamedMutex* GetAudioMutex() { return &mAudioThreadMutex; }
+   AudioGraphScheduler* GetAudioGraphScheduler() { return &mAudioGraph; }
    
    IDrawableModule* CreateModule(const ofxJSONElement& moduleInfo);
    void SetUpModule(IDrawableModule* module, const ofxJSONElement& moduleInfo);
@@ -160,6 +174,8 @@ public:
    ofxJSONElement GetLayout();
    void SaveLayoutAsPopup();
    void SaveOutput();
+   void SetRecordingOutput(bool record);
+   bool IsRecordingOutput() const { return mOutputRecorder.IsRecording(); }
    void SaveState(string file);
    void LoadState(string file);
    void SaveStatePopup();
@@ -175,13 +191,23 @@ private:
    void LoadStatePopupImp();
    IDrawableModule* DuplicateModule(IDrawableModule* module);
    void DeleteAllModules();
+   void PublishSources();
+   void SuspendAudio();
+   void ResumeAudio();
+   void WaitForAudioBlock();
+   void RunAudioThreadTask();
+   void FinishAudioBlock();
    
    ofSoundStream mSoundStream;
    int mIOBufferSize;
    
    vector<IAudioSource*> mSources;
-   InputChannel* mInput[MAX_INPUT_CHANNELS];
-   OutputChannel* mOutput[MAX_OUTPUT_CHANNELS];
+   AudioGraphScheduler mAudioGraph;
+   DeadlineMonitor mDeadlineMonitor;
+   SampleCache mSampleCache;
+   VoiceRenderPool mVoiceRenderPool;
+   std::atomic<InputChannel*> mInput[MAX_INPUT_CHANNELS];
+   std::atomic<OutputChannel*> mOutput[MAX_OUTPUT_CHANNELS];
    vector<IDrawableModule*> mLissajousDrawers;
    vector<IDrawableModule*> mDeletedModules;
    
@@ -205,15 +231,26 @@ private:
 
    RollingBuffer mOutputBuffer;
    long long mRecordingLength;
+   std::atomic<int64> mOutputFramesWritten;   //everything that's gone into mOutputBuffer, so the frame at N is at N % size
+   DiskRecorder mOutputRecorder;
    
    std::vector< std::pair<string,double> > mEvents;
    std::vector<string> mErrors;
    
    ofVec2f mDrawOffset;
    
-   NamedMutex mAudioThreadMutex;
-   
-   bool mAudioPaused;
+   int mGraphEditDepth;
+   bool mSourcesChanged;   //during a graph edit, so the sources get published when it ends
+   int mAudioSuspendDepth;
+   std::atomic<bool> mAudioSuspended;   //the layout is being torn down, so the audio thread leaves the modules alone
+   std::atomic<bool> mAudioPaused;
+   std::atomic<bool> mInAudioBlock;
+   std::atomic<int64> mAudioBlocksDone;
+   std::atomic<int> mAudioBlockWaiters;
+   WaitableEvent mAudioBlockDone;   //only signalled while someone is waiting on it
+   std::atomic<std::function<void()>*> mAudioThreadTask;
+   std::atomic<bool> mAudioThreadTaskDone;
+   CriticalSection mAudioThreadTaskMutex;   //one task at a time
    
    ModuleFactory mModuleFactory;
    EffectFactory mEffectFactory;
@@ -225,7 +262,22 @@ private:
    
    Sample* mHeldSample;
    
-   float* mSaveOutputBuffer[2];
+   class SaveStateJob : public ThreadPoolJob
+   {
+   public:
+      SaveStateJob(ModularSynth* owner, string path, bool compress) : ThreadPoolJob("save state"), mOwner(owner), mPath(path), mCompress(compress) {}
+      JobStatus runJob() override;
+      string mLayout;
+      vector<SaveStateFile::Chunk> mChunks;
+   private:
+      ModularSynth* mOwner;
+      string mPath;
+      bool mCompress;
+   };
+   void WaitForPendingSaves();
+   std::atomic<int> mNumPendingSaves;
+   WaitableEvent mSavesDone;  //manual reset, signaled whenever the last pending save finishes
+   ThreadPool mSaveStatePool;  //one thread, so saves land on disk in the order they were made
    
    IDrawableModule* mLastClickedModule;
    
@@ -264,4 +316,11 @@ private:
 
 extern ModularSynth* TheSynth;
 
+class ScopedGraphEdit
+{
+public:
+   ScopedGraphEdit() { TheSynth->BeginGraphEdit(); }
+   ~ScopedGraphEdit() { TheSynth->EndGraphEdit(); }
+};
+
 #endif
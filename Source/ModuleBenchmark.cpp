@@ -0,0 +1,363 @@
+/*
+  ==============================================================================
+
+    ModuleBenchmark.cpp
+    Created: 17 Oct 2026 4:05:32pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "ModuleBenchmark.h"
+#include "IAudioSource.h"
+#include "IAudioReceiver.h"
+#include "INoteReceiver.h"
+#include "ModuleFactory.h"
+#include "ModuleContainer.h"
+#include "EffectFactory.h"
+#include "PatchCableSource.h"
+#include "Transport.h"
+#include "ofxJSONElement.h"
+#include "FFT.h"
+
+namespace
+{
+   const char* kBenchmarkFlag = "--benchmark";
+   const int kBufferSizes[] = { 64, 256, 1024 };
+   const double kWarmupMs = 500;
+   const double kMeasureMs = 4000;
+   const double kNoteIntervalMs = 120;
+   const double kNoteLengthMs = 90;
+   const int kNotePattern[] = { 48, 55, 60, 64, 67, 72, 76, 79 };
+   const char* kFFTModuleType = "fft";
+   const int kFFTSizes[] = { 256, 1024, 2048, 4096 };
+   
+   //what FFT::Forward()/Inverse() did before they had their own transform, kept to measure against
+   void MayerForward(int nfft, const float* input, float* work, float* outputRe, float* outputIm)
+   {
+      int hnfft = nfft/2;
+      BufferCopy(work, input, nfft);
+      mayer_realfft(nfft, work);
+      outputIm[0] = 0;
+      for (int i=0; i<hnfft; ++i)
+      {
+         outputRe[i] = work[i];
+         outputIm[i] = work[nfft-1-i];
+      }
+      outputRe[hnfft] = work[hnfft];
+      outputIm[hnfft] = 0;
+   }
+   
+   void MayerInverse(int nfft, const float* inputRe, const float* inputIm, float* work, float* output)
+   {
+      int hnfft = nfft/2;
+      for (int i=0; i<hnfft; ++i)
+      {
+         work[i] = inputRe[i];
+         work[nfft-1-i] = inputIm[i];
+      }
+      work[hnfft] = inputRe[hnfft];
+      mayer_realifft(nfft, work);
+      BufferCopy(output, work, nfft);
+   }
+}
+
+ModuleBenchmark::ModuleBenchmark()
+: mNoiseGenerator(0)
+, mNextNoteTime(0)
+, mNoteIndex(0)
+{
+   mHeadlessComponent.setSize(1280, 1024);
+}
+
+bool ModuleBenchmark::Run(string outputPath, vector<string> moduleTypes)
+{
+   mSynth.Setup(&mGlobalManagers, &mHeadlessComponent);
+   
+   if (GetAllocationCount() < 0)
+      ofLog() << "this build doesn't count allocations, define BESPOKE_COUNT_ALLOCATIONS to get them (reported as -1)";
+   
+   if (moduleTypes.empty())
+      moduleTypes = GetDefaultModuleTypes();
+   
+   auto fftEntry = std::find(moduleTypes.begin(), moduleTypes.end(), kFFTModuleType);
+   if (fftEntry != moduleTypes.end())
+   {
+      moduleTypes.erase(fftEntry);
+      for (int nfft : kFFTSizes)
+         BenchmarkFFT(nfft);
+   }
+   
+   for (int bufferSize : kBufferSizes)
+   {
+      for (auto moduleType : moduleTypes)
+      {
+         Result result;
+         if (BenchmarkModule(moduleType, bufferSize, result))
+         {
+            mResults.push_back(result);
+            ofLog() << result.mModule << " @" << bufferSize << ": " << result.mNsPerSample << " ns/sample, "
+                    << result.mAllocationsPerBlock << " allocs/block, " << result.mRealtimeFactor << "x realtime";
+         }
+      }
+   }
+   
+   return WriteResults(outputPath);
+}
+
+//everything that makes sound, plus an effect chain holding each effect
+vector<string> ModuleBenchmark::GetDefaultModuleTypes()
+{
+   vector<string> moduleTypes;
+   const ModuleType kAudioModuleTypes[] = { kModuleType_Synth, kModuleType_Audio, kModuleType_Processor };
+   for (ModuleType type : kAudioModuleTypes)
+   {
+      for (auto moduleType : mSynth.GetModuleFactory()->GetSpawnableModules(type))
+         moduleTypes.push_back(moduleType);
+   }
+   for (auto effect : mSynth.GetEffectFactory()->GetSpawnableEffects())
+      moduleTypes.push_back("effectchain " + effect);
+   moduleTypes.push_back(kFFTModuleType);
+   return moduleTypes;
+}
+
+//a forward and inverse transform of each size, against the old mayer transform.
+//"buffer size" is the transform size, and realtime factor is as if there were one transform pair per nfft samples
+void ModuleBenchmark::BenchmarkFFT(int nfft)
+{
+   std::uniform_real_distribution<float> noise(-.25f, .25f);
+   mNoiseGenerator.seed(0);
+   vector<float> input(nfft), output(nfft), work(nfft), re(nfft/2+1), im(nfft/2+1);
+   for (auto& sample : input)
+      sample = noise(mNoiseGenerator);
+   
+   FFT fft(nfft);
+   for (int mayer=0; mayer<2; ++mayer)
+   {
+      int64 ticks = 0;
+      int64 allocations = 0;
+      int64 transforms = 0;
+      double elapsedMs = 0;
+      while (elapsedMs < kWarmupMs + kMeasureMs)
+      {
+         int64 allocationsBefore = GetAllocationCount();
+         int64 start = Time::getHighResolutionTicks();
+         for (int i=0; i<16; ++i)
+         {
+            if (mayer)
+            {
+               MayerForward(nfft, input.data(), work.data(), re.data(), im.data());
+               MayerInverse(nfft, re.data(), im.data(), work.data(), output.data());
+            }
+            else
+            {
+               fft.Forward(input.data(), re.data(), im.data());
+               fft.Inverse(re.data(), im.data(), output.data());
+            }
+         }
+         int64 end = Time::getHighResolutionTicks();
+         if (elapsedMs >= kWarmupMs)
+         {
+            ticks += end - start;
+            allocations += GetAllocationCount() - allocationsBefore;
+            transforms += 16;
+         }
+         elapsedMs += Time::highResolutionTicksToSeconds(end - start) * 1000;
+      }
+      
+      double seconds = Time::highResolutionTicksToSeconds(ticks);
+      double samples = double(transforms) * nfft;
+      Result result;
+      result.mModule = mayer ? "fft (mayer)" : kFFTModuleType;
+      result.mBufferSize = nfft;
+      result.mNsPerSample = seconds * 1e9 / samples;
+      result.mAllocationsPerBlock = GetAllocationCount() >= 0 ? double(allocations) / transforms : -1;
+      result.mRealtimeFactor = seconds > 0 ? (samples / gSampleRate) / seconds : 0;
+      mResults.push_back(result);
+      ofLog() << result.mModule << " @" << nfft << ": " << result.mNsPerSample << " ns/sample, "
+              << result.mRealtimeFactor << "x realtime";
+   }
+}
+
+bool ModuleBenchmark::BenchmarkModule(string moduleType, int bufferSize, Result& result)
+{
+   //modules size their buffers when they're created, so this has to be set first
+   SetGlobalBufferSize(bufferSize);
+   
+   IDrawableModule* sink = mSynth.SpawnModuleOnTheFly("amplifier", 0, 0);
+   IDrawableModule* module = mSynth.SpawnModuleOnTheFly(moduleType, 0, 0);
+   IAudioSource* source = dynamic_cast<IAudioSource*>(module);
+   IAudioReceiver* sinkReceiver = dynamic_cast<IAudioReceiver*>(sink);
+   
+   bool ok = source != nullptr && sinkReceiver != nullptr && module->GetPatchCableSource() != nullptr;
+   if (ok)
+   {
+      module->GetPatchCableSource()->SetTarget(sink);
+      
+      IAudioReceiver* audioInput = dynamic_cast<IAudioReceiver*>(module);
+      INoteReceiver* noteInput = dynamic_cast<INoteReceiver*>(module);
+      mNoiseGenerator.seed(0);
+      mNextNoteTime = gTime;
+      mNoteIndex = 0;
+      mHeldNotes.clear();
+      
+      double blockMs = bufferSize * gInvSampleRateMs;
+      int warmupBlocks = int(kWarmupMs / blockMs) + 1;
+      int measureBlocks = int(kMeasureMs / blockMs) + 1;
+      int64 processTicks = 0;
+      int64 allocations = 0;
+      
+      for (int i=0; i<warmupBlocks+measureBlocks; ++i)
+      {
+         sinkReceiver->GetBuffer()->Clear();
+         if (audioInput)
+            FeedAudio(audioInput, bufferSize);
+         if (noteInput)
+            FeedNotes(noteInput, gTime + blockMs);
+         
+         int64 allocationsBefore = GetAllocationCount();
+         int64 start = Time::getHighResolutionTicks();
+         source->Process(gTime);
+         int64 end = Time::getHighResolutionTicks();
+         if (i >= warmupBlocks)
+         {
+            processTicks += end - start;
+            allocations += GetAllocationCount() - allocationsBefore;
+         }
+         
+         gTime += blockMs;
+         TheTransport->Advance((float)blockMs);
+      }
+      
+      if (noteInput)
+      {
+         for (const auto& note : mHeldNotes)
+            noteInput->PlayNote(gTime, note.mPitch, 0);
+         mHeldNotes.clear();
+      }
+      
+      double processSeconds = Time::highResolutionTicksToSeconds(processTicks);
+      double measuredSamples = double(measureBlocks) * bufferSize;
+      result.mModule = moduleType;
+      result.mBufferSize = bufferSize;
+      result.mNsPerSample = processSeconds * 1e9 / measuredSamples;
+      result.mAllocationsPerBlock = GetAllocationCount() >= 0 ? double(allocations) / measureBlocks : -1;
+      result.mRealtimeFactor = processSeconds > 0 ? (measuredSamples / gSampleRate) / processSeconds : 0;
+   }
+   else
+   {
+      ofLog() << "skipping " << moduleType << ", it doesn't make audio";
+   }
+   
+   if (module != nullptr)
+      module->GetOwningContainer()->DeleteModule(module);
+   if (sink != nullptr)
+      sink->GetOwningContainer()->DeleteModule(sink);
+   
+   return ok;
+}
+
+void ModuleBenchmark::FeedAudio(IAudioReceiver* receiver, int bufferSize)
+{
+   std::uniform_real_distribution<float> noise(-.25f, .25f);
+   ChannelBuffer* buffer = receiver->GetBuffer();
+   buffer->SetNumActiveChannels(2);
+   for (int ch=0; ch<buffer->NumActiveChannels(); ++ch)
+   {
+      float* channel = buffer->GetChannel(ch);
+      for (int i=0; i<bufferSize; ++i)
+         channel[i] = noise(mNoiseGenerator);
+   }
+}
+
+//a steady arpeggio of overlapping notes, so voices start, sustain and release during every run
+void ModuleBenchmark::FeedNotes(INoteReceiver* receiver, double blockEndTime)
+{
+   for (auto iter = mHeldNotes.begin(); iter != mHeldNotes.end();)
+   {
+      if (iter->mReleaseTime < blockEndTime)
+      {
+         receiver->PlayNote(iter->mReleaseTime, iter->mPitch, 0);
+         iter = mHeldNotes.erase(iter);
+      }
+      else
+      {
+         ++iter;
+      }
+   }
+   
+   const int kNumPatternNotes = sizeof(kNotePattern) / sizeof(kNotePattern[0]);
+   while (mNextNoteTime < blockEndTime)
+   {
+      HeldNote note;
+      note.mPitch = kNotePattern[mNoteIndex % kNumPatternNotes];
+      note.mReleaseTime = mNextNoteTime + kNoteLengthMs;
+      receiver->PlayNote(mNextNoteTime, note.mPitch, 100);
+      mHeldNotes.push_back(note);
+      
+      ++mNoteIndex;
+      mNextNoteTime += kNoteIntervalMs;
+   }
+}
+
+bool ModuleBenchmark::WriteResults(string outputPath)
+{
+   if (ofIsStringInString(outputPath, ".csv"))
+   {
+      File file(ofToDataPath(outputPath).c_str());
+      String csv = "module,buffer_size,ns_per_sample,allocations_per_block,realtime_factor\n";
+      for (const auto& result : mResults)
+      {
+         csv += String(result.mModule) + "," + String(result.mBufferSize) + "," + String(result.mNsPerSample) + "," +
+                String(result.mAllocationsPerBlock) + "," + String(result.mRealtimeFactor) + "\n";
+      }
+      return file.replaceWithText(csv);
+   }
+   
+   ofxJSONElement root;
+   root["samplerate"] = gSampleRate;
+   root["results"].resize(0);
+   for (const auto& result : mResults)
+   {
+      ofxJSONElement entry;
+      entry["module"] = result.mModule;
+      entry["buffer_size"] = result.mBufferSize;
+      entry["ns_per_sample"] = result.mNsPerSample;
+      entry["allocations_per_block"] = result.mAllocationsPerBlock;
+      entry["realtime_factor"] = result.mRealtimeFactor;
+      root["results"].append(entry);
+   }
+   return root.save(ofToDataPath(outputPath), true);
+}
+
+//static
+bool ModuleBenchmark::IsBenchmarkCommandLine(const String& commandLine)
+{
+   StringArray args = StringArray::fromTokens(commandLine, true);
+   return args.contains(kBenchmarkFlag);
+}
+
+//static
+int ModuleBenchmark::RunFromCommandLine(const String& commandLine)
+{
+   StringArray args = StringArray::fromTokens(commandLine, true);
+   args.trim();
+   args.removeEmptyStrings();
+   for (int i=0; i<args.size(); ++i)
+      args.set(i, args[i].unquoted());
+   
+   int flagIndex = args.indexOf(kBenchmarkFlag);
+   if (flagIndex < 0 || flagIndex+1 >= args.size())
+   {
+      ofLog() << "usage: " << kBenchmarkFlag << " <results.csv|results.json> [module types...]";
+      return 1;
+   }
+   
+   string outputPath = args[flagIndex+1].toStdString();
+   vector<string> moduleTypes;
+   for (int i=flagIndex+2; i<args.size(); ++i)
+      moduleTypes.push_back(args[i].replace(":", " ").toStdString());  //effectchain:delay -> "effectchain delay"
+   
+   ModuleBenchmark benchmark;
+   return benchmark.Run(outputPath, moduleTypes) ? 0 : 1;
+}
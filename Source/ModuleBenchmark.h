@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    ModuleBenchmark.h
+    Created: 17 Oct 2026 4:05:32pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SynthGlobals.h"
+#include "ModularSynth.h"
+
+class IDrawableModule;
+class IAudioReceiver;
+class INoteReceiver;
+
+//spawns modules one at a time without a window or audio device, feeds them noise and a note pattern,
+//and times their Process() at a few buffer sizes. results go to csv or json so builds can be compared.
+//started with "--benchmark <results.csv|results.json> [module types...]". "fft" as a module type times the FFT on its own
+class ModuleBenchmark
+{
+public:
+   ModuleBenchmark();
+   
+   bool Run(string outputPath, vector<string> moduleTypes);
+   
+   static bool IsBenchmarkCommandLine(const String& commandLine);
+   static int RunFromCommandLine(const String& commandLine);
+   
+private:
+   struct Result
+   {
+      string mModule;
+      int mBufferSize;
+      double mNsPerSample;
+      double mAllocationsPerBlock;
+      double mRealtimeFactor;
+   };
+   
+   struct HeldNote
+   {
+      double mReleaseTime;
+      int mPitch;
+   };
+   
+   vector<string> GetDefaultModuleTypes();
+   bool BenchmarkModule(string moduleType, int bufferSize, Result& result);
+   void BenchmarkFFT(int nfft);
+   void FeedAudio(IAudioReceiver* receiver, int bufferSize);
+   void FeedNotes(INoteReceiver* receiver, double blockEndTime);
+   bool WriteResults(string outputPath);
+   
+   GlobalManagers mGlobalManagers;
+   ModularSynth mSynth;
+   juce::Component mHeadlessComponent;
+   vector<Result> mResults;
+   
+   std::mt19937 mNoiseGenerator;
+   double mNextNoteTime;
+   int mNoteIndex;
+   vector<HeldNote> mHeldNotes;
+};
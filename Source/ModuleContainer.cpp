@@ -488,7 +488,11 @@ void ModuleContainer::LoadState(FileStreamIn& in)
 {
    int header;
    in >> header;
-   assert(header == kSaveStateRev);
+   if (header != kSaveStateRev)
+   {
+      TheSynth->LogEvent("Unrecognized save state revision "+ofToString(header), kLogEventType_Error);
+      return;
+   }
    
    int savedModules;
    in >> savedModules;
@@ -549,3 +553,54 @@ void ModuleContainer::LoadState(FileStreamIn& in)
    for (auto module : mModules)
       module->PostLoadState();
 }
+
+void ModuleContainer::SaveState(vector<SaveStateFile::Chunk>& chunks)
+{
+   chunks.reserve(chunks.size() + mModules.size());
+   for (auto* module : mModules)
+   {
+      if (module != TheSaveDataPanel && module != TheTitleBar)
+      {
+         chunks.push_back(SaveStateFile::Chunk());
+         chunks.back().mName = module->Name();
+         FileStreamOut out(chunks.back().mData, chunks.back().mBufferRefs);
+         module->SaveState(out);
+      }
+   }
+}
+
+void ModuleContainer::LoadState(SaveStateFile& file)
+{
+   for (int i=0; i<file.GetNumChunks(); ++i)
+   {
+      const string& moduleName = file.GetChunkName(i);
+      IDrawableModule* module = FindModule(moduleName, false);
+      if (module == nullptr)
+      {
+         TheSynth->LogEvent("Couldn't find module \""+moduleName+"\" to load state into", kLogEventType_Error);
+         continue;
+      }
+      
+      //every module has its own chunk, so one that's damaged or fails to load doesn't throw off the ones after it
+      const void* data;
+      size_t size;
+      if (!file.GetChunk(i, data, size))
+      {
+         TheSynth->LogEvent("Saved state for module \""+moduleName+"\" is damaged, skipping it", kLogEventType_Error);
+         continue;
+      }
+      
+      try
+      {
+         FileStreamIn in(data, size);
+         module->LoadState(in);
+      }
+      catch (LoadStateException& e)
+      {
+         TheSynth->LogEvent("Error loading state for module \""+moduleName+"\"", kLogEventType_Error);
+      }
+   }
+   
+   for (auto module : mModules)
+      module->PostLoadState();
+}
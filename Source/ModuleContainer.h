@@ -14,6 +14,7 @@
 #include "OpenFrameworksPort.h"
 #include "IDrawableModule.h"
 #include "ofxJSONElement.h"
+#include "SaveStateFile.h"
 
 class ModuleContainer
 {
@@ -59,6 +60,8 @@ public:
    ofxJSONElement WriteModules();
    void SaveState(FileStreamOut& out);
    void LoadState(FileStreamIn& in);
+   void SaveState(vector<SaveStateFile::Chunk>& chunks);   //large buffers are left as references in each chunk
+   void LoadState(SaveStateFile& file);
    
 private:
    ofVec2f GetOwnerPosition() const;
@@ -20,7 +20,9 @@ MultitrackRecorder* TheMultitrackRecorder = nullptr;
 MultitrackRecorder::MultitrackRecorder()
 : mRecordingLength(RECORD_CHUNK_SIZE)
 , mRecording(false)
+, mRecordToDisk(false)
 , mRecordCheckbox(nullptr)
+, mRecordToDiskCheckbox(nullptr)
 , mPlayCheckbox(nullptr)
 , mAddTrackButton(nullptr)
 , mResetPlayheadButton(nullptr)
@@ -58,6 +60,7 @@ void MultitrackRecorder::CreateUIControls()
    mResetPlayheadButton = new ClickButton(this,"reset",230,2);
    mFixLengthsButton = new ClickButton(this,"fix lengths",270,2);
    mUndoRecordButton = new ClickButton(this,"undo rec",450,2);
+   mRecordToDiskCheckbox = new Checkbox(this,"to disk",mUndoRecordButton,kAnchor_Right,&mRecordToDisk);
    
    for (int i=0; i<NUM_CLIP_ARRANGERS; ++i)
       mClipArranger[i].CreateUIControls();
@@ -78,12 +81,23 @@ void MultitrackRecorder::Poll()
    int reallocDist = gSampleRate; //1 second from the end
    ArrangementMaster::mSampleLength = mRecordingLength;
    
+   //each take also streams to its own file, starting from wherever the playhead was when recording started
+   bool recordToDisk = mRecording && mRecordToDisk;
+   if (recordToDisk != mDiskRecorder.IsRecording())
+   {
+      if (recordToDisk)
+         mDiskRecorder.Start(ofGetTimestampString("recordings/multitrack_%Y-%m-%d_%H-%M-%S_track"+ofToString(mRecordIdx+1)+".wav"), 2);
+      else
+         mDiskRecorder.Stop();
+   }
+   
    int cW, cH;
    mClipArranger[0].GetDimensions(cW, cH);
    for (int i=0; i<NUM_CLIP_ARRANGERS; ++i)
       mClipArranger[i].SetPosition(0, 25 + mBufferHeight * mRecordBuffers.size() + i*cH);
    
-   if (mRecording &&
+   //takes going to disk don't touch the in-memory tracks, so there's nothing to grow
+   if (mRecording && !mRecordToDisk &&
        ArrangementMaster::mPlayhead > mRecordingLength - reallocDist)  //we're a second from the end
    {
       int newChunk = RECORD_CHUNK_SIZE;
@@ -129,10 +143,35 @@ void MultitrackRecorder::Process(double time, float* left, float* right, int buf
    
    ComputeSliders(0);
    
-   mMutex.Lock("audio thread");
+   //a take going to disk only goes through the disk recorder's ring, and the audio thread never waits on the ui for it
+   bool recordToDisk = mRecording && mRecordToDisk;
+   if (recordToDisk)
+   {
+      float* input[2] = { left, right };
+      mDiskRecorder.Write(input, 2, bufferSize);
+      
+      ScopedTryMutex lock(&mMutex, "audio thread");
+      if (!lock.IsLocked())
+      {
+         //the take is already safe, just keep time with it and pick the other tracks back up next block
+         ArrangementMaster::mPlayhead = MIN(ArrangementMaster::mPlayhead + bufferSize, mRecordingLength - 1);
+         return;
+      }
+      ProcessTracks(time, left, right, bufferSize, false);
+      return;
+   }
    
+   mMutex.Lock("audio thread");
+   ProcessTracks(time, left, right, bufferSize, mRecording);
+   mMutex.Unlock();
+}
+
+void MultitrackRecorder::ProcessTracks(double time, float* left, float* right, int bufferSize, bool recordToMemory)
+{
    if (mRecording || ArrangementMaster::mPlay)
    {
+      int recordStart = INT_MAX;
+      int recordEnd = 0;
       for (int i=0; i<bufferSize; ++i)
       {
          int recordIdx = GetRecordIdx();
@@ -142,10 +181,12 @@ void MultitrackRecorder::Process(double time, float* left, float* right, int buf
          else
             ApplyStructure();
          
-         if (mRecording)
+         if (recordToMemory)
          {
             mRecordBuffers[recordIdx]->mLeft[ArrangementMaster::mPlayhead] = left[i];
             mRecordBuffers[recordIdx]->mRight[ArrangementMaster::mPlayhead] = right[i];
+            recordStart = MIN(recordStart, ArrangementMaster::mPlayhead);
+            recordEnd = MAX(recordEnd, ArrangementMaster::mPlayhead+1);
          }
          
          for (int j=0; j<mRecordBuffers.size(); ++j)
@@ -163,12 +204,17 @@ void MultitrackRecorder::Process(double time, float* left, float* right, int buf
          if (ArrangementMaster::mPlayhead < mRecordingLength - 1)
             ++ArrangementMaster::mPlayhead;
       }
+      
+      if (recordToMemory)
+      {
+         RecordBuffer* recordBuffer = mRecordBuffers[mRecordIdx];
+         recordBuffer->mLeftPeaks.MarkDirty(recordStart, recordEnd);
+         recordBuffer->mRightPeaks.MarkDirty(recordStart, recordEnd);
+      }
    }
    
    for (int i=0; i<NUM_CLIP_ARRANGERS; ++i)
       mClipArranger[i].Process(time, left, right, bufferSize);
-   
-   mMutex.Unlock();
 }
 
 void MultitrackRecorder::DrawModule()
@@ -182,6 +228,7 @@ void MultitrackRecorder::DrawModule()
    mResetPlayheadButton->Draw();
    mFixLengthsButton->Draw();
    mUndoRecordButton->Draw();
+   mRecordToDiskCheckbox->Draw();
    
    ofPushStyle();
    ofPushMatrix();
@@ -189,9 +236,11 @@ void MultitrackRecorder::DrawModule()
    for (int i=0; i<mRecordBuffers.size(); ++i)
    {
       ofPushMatrix();
-      DrawAudioBuffer(mBufferWidth * mRecordBuffers[i]->mLength/mRecordingLength,mBufferHeight*.45f,mRecordBuffers[i]->mLeft,0,mRecordBuffers[i]->mLength,ArrangementMaster::mPlayhead);
+      mRecordBuffers[i]->mLeftPeaks.Update(mRecordBuffers[i]->mLeft, mRecordBuffers[i]->mLength);
+      mRecordBuffers[i]->mRightPeaks.Update(mRecordBuffers[i]->mRight, mRecordBuffers[i]->mLength);
+      DrawAudioBuffer(mBufferWidth * mRecordBuffers[i]->mLength/mRecordingLength,mBufferHeight*.45f,&mRecordBuffers[i]->mLeftPeaks,0,mRecordBuffers[i]->mLength,ArrangementMaster::mPlayhead);
       ofTranslate(0,mBufferHeight*.47f);
-      DrawAudioBuffer(mBufferWidth * mRecordBuffers[i]->mLength/mRecordingLength,mBufferHeight*.45f,mRecordBuffers[i]->mRight,0,mRecordBuffers[i]->mLength,ArrangementMaster::mPlayhead);
+      DrawAudioBuffer(mBufferWidth * mRecordBuffers[i]->mLength/mRecordingLength,mBufferHeight*.45f,&mRecordBuffers[i]->mRightPeaks,0,mRecordBuffers[i]->mLength,ArrangementMaster::mPlayhead);
       ofTranslate(0,mBufferHeight*.53f);
       ofPopMatrix();
       
@@ -388,9 +437,9 @@ void MultitrackRecorder::FilesDropped(vector<string> files, int x, int y)
       
       mRecordingLength = sample.LengthInSamples();
       RecordBuffer* buffer = new RecordBuffer(mRecordingLength);
-      Mult(sample.Data()->GetChannel(0), .5f, mRecordingLength);
       BufferCopy(buffer->mLeft, sample.Data()->GetChannel(0), mRecordingLength);
-      BufferCopy(buffer->mRight, sample.Data()->GetChannel(0), mRecordingLength);
+      Mult(buffer->mLeft, .5f, mRecordingLength);
+      BufferCopy(buffer->mRight, buffer->mLeft, mRecordingLength);
       mRecordBuffers.push_back(buffer);
       
       delete[] mMeasurePos;
@@ -473,6 +522,8 @@ void MultitrackRecorder::OnClicked(int x, int y, bool right)
             FixLengths();
             Add(mRecordBuffers[clickedIdx]->mLeft, mRecordBuffers[mMergeBufferIdx]->mLeft, mRecordingLength);
             Add(mRecordBuffers[clickedIdx]->mRight, mRecordBuffers[mMergeBufferIdx]->mRight, mRecordingLength);
+            mRecordBuffers[clickedIdx]->mLeftPeaks.Invalidate();
+            mRecordBuffers[clickedIdx]->mRightPeaks.Invalidate();
             DeleteBuffer(mMergeBufferIdx);
             mMutex.Unlock();
          }
@@ -567,6 +618,8 @@ void MultitrackRecorder::CopyRecordBufferContents(RecordBuffer* dst, RecordBuffe
    
    BufferCopy(dst->mLeft, src->mLeft, src->mLength);
    BufferCopy(dst->mRight, src->mRight, src->mLength);
+   dst->mLeftPeaks.Invalidate();
+   dst->mRightPeaks.Invalidate();
 }
 
 void MultitrackRecorder::FloatSliderUpdated(FloatSlider* slider, float oldVal)
@@ -19,6 +19,8 @@
 #include "Checkbox.h"
 #include "NamedMutex.h"
 #include "ClipArranger.h"
+#include "PeakCache.h"
+#include "DiskRecorder.h"
 
 #define RECORD_CHUNK_SIZE 10*gSampleRate
 #define MAX_NUM_MEASURES 1000
@@ -78,8 +80,11 @@ private:
       float* mRight;
       int mLength;
       BufferControls mControls;
+      PeakCache mLeftPeaks;
+      PeakCache mRightPeaks;
    };
    
+   void ProcessTracks(double time, float* left, float* right, int bufferSize, bool recordToMemory);   //with mMutex held
    void AddRecordBuffer();
    int GetRecordIdx();
    bool IsRecordingStructure();
@@ -98,8 +103,11 @@ private:
    int mRecordingLength;
    int mPlayhead;
    bool mRecording;
+   bool mRecordToDisk;
+   DiskRecorder mDiskRecorder;
    
    Checkbox* mRecordCheckbox;
+   Checkbox* mRecordToDiskCheckbox;
    Checkbox* mPlayCheckbox;
    ClickButton* mAddTrackButton;
    ClickButton* mResetPlayheadButton;
@@ -8,31 +8,30 @@
 
 #include "NamedMutex.h"
 
-void NamedMutex::Lock(string locker)
+void NamedMutex::Lock(const char* locker)
 {
-   if (mLocker == locker)
-   {
-      ++mExtraLockCount;
-      return;
-   }
    mMutex.lock();
-   mLocker = locker;
+   if (mLockCount++ == 0)
+      mLocker = locker;
+}
+
+bool NamedMutex::TryLock(const char* locker)
+{
+   if (!mMutex.try_lock())
+      return false;
+   if (mLockCount++ == 0)
+      mLocker = locker;
+   return true;
 }
 
 void NamedMutex::Unlock()
 {
-   if (mExtraLockCount == 0)
-   {
+   if (--mLockCount == 0)
       mLocker = "<none>";
-      mMutex.unlock();
-   }
-   else
-   {
-      --mExtraLockCount;
-   }
+   mMutex.unlock();
 }
 
-ScopedMutex::ScopedMutex(NamedMutex* mutex, string locker)
+ScopedMutex::ScopedMutex(NamedMutex* mutex, const char* locker)
 : mMutex(mutex)
 {
    mMutex->Lock(locker);
@@ -41,4 +40,16 @@ ScopedMutex::ScopedMutex(NamedMutex* mutex, string locker)
 ScopedMutex::~ScopedMutex()
 {
    mMutex->Unlock();
+}
+
+ScopedTryMutex::ScopedTryMutex(NamedMutex* mutex, const char* locker)
+: mMutex(mutex)
+{
+   mLocked = mMutex->TryLock(locker);
+}
+
+ScopedTryMutex::~ScopedTryMutex()
+{
+   if (mLocked)
+      mMutex->Unlock();
 }
\ No newline at end of file
@@ -11,25 +11,41 @@
 
 #include "OpenFrameworksPort.h"
 
+//the locker name is only kept for debugging, so it has to be a string literal.
+//that keeps locking free of allocations, which matters since the audio thread takes this every block
 class NamedMutex
 {
 public:
-   NamedMutex() : mLocker("<none>"), mExtraLockCount(0) {}
-   void Lock(string locker);
+   NamedMutex() : mLocker("<none>"), mLockCount(0) {}
+   void Lock(const char* locker);
+   bool TryLock(const char* locker);
    void Unlock();
+   const char* GetLocker() const { return mLocker; }
 private:
    ofMutex mMutex;
-   string mLocker;
-   int mExtraLockCount;
+   const char* mLocker;
+   int mLockCount;
 };
 
 class ScopedMutex
 {
 public:
-   ScopedMutex(NamedMutex* mutex, string locker);
+   ScopedMutex(NamedMutex* mutex, const char* locker);
    ~ScopedMutex();
 private:
    NamedMutex* mMutex;
 };
 
+//for the audio thread: never waits, check IsLocked() and skip the work if someone else has it
+class ScopedTryMutex
+{
+public:
+   ScopedTryMutex(NamedMutex* mutex, const char* locker);
+   ~ScopedTryMutex();
+   bool IsLocked() const { return mLocked; }
+private:
+   NamedMutex* mMutex;
+   bool mLocked;
+};
+
 #endif /* defined(__modularSynth__NamedMutex__) */
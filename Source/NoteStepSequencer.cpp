@@ -427,6 +427,8 @@ void NoteStepSequencer::Step(int samplesTo, bool reset)
    if (!mEnabled || mHold)
       return;
    
+   double time = gTime + samplesTo * gInvSampleRateMs;
+   
    if (mArpStep != 0)
    {
       mArpIndex += mArpStep;
@@ -511,23 +513,23 @@ void NoteStepSequencer::Step(int samplesTo, bool reset)
          offPitch = -1;
          mLastVel = mVels[mArpIndex];
          mLastNoteLength = mNoteLengths[mArpIndex];
-         mLastNoteStartTime = gTime;
+         mLastNoteStartTime = time;
          mAlreadyDidNoteOff = false;
       }
       else
       {
          if (mLastPitch == outPitch && !mAlreadyDidNoteOff)   //same note, play noteoff first
          {
-            PlayNoteOutput(gTime, mLastPitch, 0, -1);
+            PlayNoteOutput(time, mLastPitch, 0, -1);
             offPitch = -1;
          }
          if (mVels[mArpIndex] > 1)
          {
-            PlayNoteOutput(gTime, outPitch, mVels[mArpIndex], -1);
+            PlayNoteOutput(time, outPitch, mVels[mArpIndex], -1);
             mLastPitch = outPitch;
             mLastVel = mVels[mArpIndex];
             mLastNoteLength = mNoteLengths[mArpIndex];
-            mLastNoteStartTime = gTime;
+            mLastNoteStartTime = time;
             mAlreadyDidNoteOff = false;
          }
       }
@@ -535,7 +537,7 @@ void NoteStepSequencer::Step(int samplesTo, bool reset)
    
    if (offPitch != -1)
    {
-      PlayNoteOutput(gTime + samplesTo * gInvSampleRateMs, offPitch, 0, -1);
+      PlayNoteOutput(time, offPitch, 0, -1);
       if (offPitch == mLastPitch)
       {
          mLastPitch = -1;
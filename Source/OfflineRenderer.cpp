@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.cpp
+    Created: 17 Oct 2026 2:41:10pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "OfflineRenderer.h"
+#include "SampleCache.h"
+#include "SampleStream.h"
+
+namespace
+{
+   const char* kRenderFlag = "--render";
+   const double kDefaultRenderSeconds = 60;
+   const double kPollIntervalMs = 1000.0 / 60;   //how often the ui timer would have polled
+}
+
+OfflineRenderer::OfflineRenderer()
+{
+   mHeadlessComponent.setSize(1280, 1024);
+}
+
+bool OfflineRenderer::Render(string inputPath, string outputPath, double seconds)
+{
+   mSynth.Setup(&mGlobalManagers, &mHeadlessComponent);
+   mSynth.SkipStartupLayout();
+   
+   if (ofIsStringInString(inputPath, ".bsk"))
+      mSynth.LoadState(inputPath);
+   else
+      mSynth.LoadLayoutFromFile(inputPath, false);
+   
+   File outputFile(ofToDataPath(outputPath).c_str());
+   outputFile.deleteFile();
+   outputFile.create();
+   FileOutputStream* outputTo = outputFile.createOutputStream();
+   if (outputTo == nullptr)
+   {
+      ofLog() << "couldn't open " << outputPath << " for writing";
+      return false;
+   }
+   
+   WavAudioFormat wavFormat;
+   ScopedPointer<AudioFormatWriter> writer = wavFormat.createWriterFor(outputTo, gSampleRate, 2, 24, StringPairArray(), 0);
+   if (writer == nullptr)
+   {
+      delete outputTo;
+      ofLog() << "couldn't create a wav writer for " << outputPath;
+      return false;
+   }
+   
+   ChannelBuffer output(gBufferSize);
+   output.SetNumActiveChannels(2);
+   float* outputChannels[2] = { output.GetChannel(0), output.GetChannel(1) };
+   const float* inputChannels[MAX_INPUT_CHANNELS];
+   for (int i=0; i<MAX_INPUT_CHANNELS; ++i)
+      inputChannels[i] = gZeroBuffer;
+   
+   int64 totalSamples = int64(seconds * gSampleRate);
+   int64 renderedSamples = 0;
+   double nextPollTime = gTime;
+   double renderedMs = 0;
+   double processMs = 0;
+   
+   ofLog() << "rendering " << seconds << "s of " << inputPath << " at " << gSampleRate << "hz, " << gBufferSize << " sample blocks";
+   
+   while (renderedSamples < totalSamples)
+   {
+      //the ui thread would normally be polling modules between blocks
+      if (gTime >= nextPollTime)
+      {
+         mSynth.Poll();
+         nextPollTime = gTime + kPollIntervalMs;
+      }
+      
+      //nothing's waiting on us in real time, so let samples finish loading and streams fill up rather than
+      //rendering the silence a live session would have gotten
+      TheSampleCache->WaitForPendingLoads();
+      SampleStream::WaitForPrefetches();
+      
+      double start = Time::getMillisecondCounterHiRes();
+      mSynth.AudioIn(inputChannels, gBufferSize, MAX_INPUT_CHANNELS);
+      mSynth.AudioOut(outputChannels, gBufferSize, 2);
+      processMs += Time::getMillisecondCounterHiRes() - start;
+      
+      int samples = (int)MIN(int64(gBufferSize), totalSamples - renderedSamples);
+      writer->writeFromFloatArrays(outputChannels, 2, samples);
+      renderedSamples += samples;
+      renderedMs += samples * gInvSampleRateMs;
+   }
+   
+   writer = nullptr;  //flushes and closes the file
+   
+   ofLog() << "wrote " << outputFile.getFullPathName().toStdString();
+   ofLog() << "processed " << renderedMs/1000 << "s of audio in " << processMs/1000 << "s (" << (processMs > 0 ? renderedMs/processMs : 0) << "x realtime)";
+   
+   return true;
+}
+
+//static
+bool OfflineRenderer::IsRenderCommandLine(const String& commandLine)
+{
+   StringArray args = StringArray::fromTokens(commandLine, true);
+   return args.contains(kRenderFlag);
+}
+
+//static
+int OfflineRenderer::RunFromCommandLine(const String& commandLine)
+{
+   StringArray args = StringArray::fromTokens(commandLine, true);
+   args.trim();
+   args.removeEmptyStrings();
+   for (int i=0; i<args.size(); ++i)
+      args.set(i, args[i].unquoted());
+   
+   int flagIndex = args.indexOf(kRenderFlag);
+   if (flagIndex < 0 || flagIndex+2 >= args.size())
+   {
+      ofLog() << "usage: " << kRenderFlag << " <layout.json|state.bsk> <output.wav> [seconds]";
+      return 1;
+   }
+   
+   string inputPath = args[flagIndex+1].toStdString();
+   string outputPath = args[flagIndex+2].toStdString();
+   double seconds = kDefaultRenderSeconds;
+   if (flagIndex+3 < args.size())
+      seconds = args[flagIndex+3].getDoubleValue();
+   
+   OfflineRenderer renderer;
+   return renderer.Render(inputPath, outputPath, seconds) ? 0 : 1;
+}
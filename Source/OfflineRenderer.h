@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer.h
+    Created: 17 Oct 2026 2:41:10pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SynthGlobals.h"
+#include "ModularSynth.h"
+
+//runs a layout or save state without a window or audio device, pumping the graph as fast as it'll go
+//and writing the master output to a wav. started with "--render <layout.json|state.bsk> <output.wav> [seconds]"
+class OfflineRenderer
+{
+public:
+   OfflineRenderer();
+   
+   bool Render(string inputPath, string outputPath, double seconds);
+   
+   static bool IsRenderCommandLine(const String& commandLine);
+   static int RunFromCommandLine(const String& commandLine);
+   
+private:
+   GlobalManagers mGlobalManagers;
+   ModularSynth mSynth;
+   juce::Component mHeadlessComponent;  //never shown, just gives ofGetWidth() and friends something to measure
+};
@@ -623,7 +623,8 @@ ofRectangle RetinaTrueTypeFont::DrawStringWrap(string str, float size, float x,
 
 float RetinaTrueTypeFont::GetStringWidth(string str, float size)
 {
-   assert(mLoaded);
+   if (!mLoaded)  //running headless, nothing to measure with
+      return str.length() * size * .5f;
    
    nvgFontFaceId(gFontBoundsNanoVG, mFontBoundsHandle);
    nvgFontSize(gFontBoundsNanoVG, size);
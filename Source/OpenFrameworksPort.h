@@ -139,6 +139,10 @@ public:
    {
       mCritSec.exit();
    }
+   bool try_lock()
+   {
+      return mCritSec.tryEnter();
+   }
    CriticalSection mCritSec;
 };
 
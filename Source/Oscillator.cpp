@@ -67,6 +67,77 @@ float Oscillator::Value(float phase) const
    return sample;
 }
 
+//the lane renderer covers the common unison case: plain sin/saw/square/tri without shuffle or soften
+bool Oscillator::CanRenderLanes() const
+{
+   if (mShuffle > 0 || mSoften > 0)
+      return false;
+   if (mType != kOsc_Square && mPulseWidth != .5f)
+      return false;
+   return mType == kOsc_Sin || mType == kOsc_Saw || mType == kOsc_NegSaw || mType == kOsc_Square || mType == kOsc_Tri;
+}
+
+namespace
+{
+   //correction for a unit step at t=0, spread over one sample each side (t and dt are in cycles)
+   inline float PolyBlep(float t, float dt)
+   {
+      float before = t / dt;
+      float after = (t - 1) / dt;
+      float blep = t < dt ? before + before - before * before - 1 : 0;
+      return t > 1 - dt ? after * after + after + after + 1 : blep;
+   }
+}
+
+//renders one sample for several phases at once (unison voices), as straight loops over the lanes
+//with no branches or libm calls so the compiler can vectorize them.
+//saw and square are band-limited with polyblep, which is why this needs each lane's phase increment
+void Oscillator::RenderLanes(const float* phases, const float* phaseIncs, float* samples, int numLanes) const
+{
+   assert(CanRenderLanes());
+   
+   float t[kMaxLanes];
+   float dt[kMaxLanes];
+   assert(numLanes <= kMaxLanes);
+   for (int i=0; i<numLanes; ++i)
+   {
+      t[i] = phases[i] / FTWO_PI;
+      t[i] -= floorf(t[i]);
+      dt[i] = ofClamp(phaseIncs[i] / FTWO_PI, .00001f, .5f);
+   }
+   
+   switch (mType)
+   {
+      case kOsc_Sin:
+         for (int i=0; i<numLanes; ++i)
+            samples[i] = SinCycle(t[i]);
+         break;
+      case kOsc_Saw:
+         for (int i=0; i<numLanes; ++i)
+            samples[i] = t[i] * 2 - 1 - PolyBlep(t[i], dt[i]);
+         break;
+      case kOsc_NegSaw:
+         for (int i=0; i<numLanes; ++i)
+            samples[i] = 1 - t[i] * 2 + PolyBlep(t[i], dt[i]);
+         break;
+      case kOsc_Square:
+         for (int i=0; i<numLanes; ++i)
+         {
+            float fall = t[i] - mPulseWidth;
+            fall -= floorf(fall);
+            samples[i] = (t[i] > mPulseWidth ? -1 : 1) + PolyBlep(t[i], dt[i]) - PolyBlep(fall, dt[i]);
+         }
+         break;
+      case kOsc_Tri:
+         for (int i=0; i<numLanes; ++i)
+            samples[i] = fabsf(t[i] - .5f) * 4 - 1;
+         break;
+      default:
+         assert(false);
+         break;
+   }
+}
+
 float Oscillator::SawSample(float phase) const
 {
    phase /= FTWO_PI;
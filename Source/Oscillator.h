@@ -21,6 +21,8 @@ public:
    OscillatorType GetType() const { return mType; }
    void SetType(OscillatorType type) { mType = type; }
    float Value(float phase) const;
+   bool CanRenderLanes() const;
+   void RenderLanes(const float* phases, const float* phaseIncs, float* samples, int numLanes) const;
    float GetPulseWidth() const { return mPulseWidth; }
    void SetPulseWidth(float width) { mPulseWidth = width; }
    float GetShuffle() const { return mShuffle; }
@@ -28,6 +30,8 @@ public:
    float GetSoften() const { return mSoften; }
    void SetSoften(float soften) { mSoften = ofClamp(soften,0,1); }
    OscillatorType mType;
+   
+   static const int kMaxLanes = 8;
 private:
    float SawSample(float phase) const;
    
@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    PartialBank.cpp
+    Created: 17 Oct 2026 3:41:27pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "PartialBank.h"
+
+PartialBank::PartialBank(int maxPartials)
+: mMaxPartials(maxPartials)
+{
+   mPhase = new float[maxPartials];
+   mPhaseInc = new float[maxPartials];
+   mAmp = new float[maxPartials];
+   mTargetAmp = new float[maxPartials];
+   for (int i=0; i<maxPartials; ++i)
+   {
+      mPhase[i] = 0;
+      mPhaseInc[i] = 0;
+      mAmp[i] = 0;
+      mTargetAmp[i] = 0;
+   }
+}
+
+PartialBank::~PartialBank()
+{
+   delete[] mPhase;
+   delete[] mPhaseInc;
+   delete[] mAmp;
+   delete[] mTargetAmp;
+}
+
+void PartialBank::SetPartial(int index, float phaseInc, float amp)
+{
+   assert(index >= 0 && index < mMaxPartials);
+   mPhaseInc[index] = phaseInc / FTWO_PI;
+   mTargetAmp[index] = amp;
+}
+
+void PartialBank::SetPhase(int index, float phase)
+{
+   assert(index >= 0 && index < mMaxPartials);
+   phase /= FTWO_PI;
+   mPhase[index] = phase - floorf(phase);
+}
+
+void PartialBank::ResetPhases()
+{
+   for (int i=0; i<mMaxPartials; ++i)
+      mPhase[i] = 0;
+}
+
+void PartialBank::Silence(int fromIndex)
+{
+   for (int i=MAX(fromIndex,0); i<mMaxPartials; ++i)
+      mTargetAmp[i] = 0;
+}
+
+void PartialBank::Process(float* out, int bufferSize)
+{
+   for (int j=0; j<mMaxPartials; ++j)
+   {
+      float phaseInc = mPhaseInc[j];
+      if (phaseInc >= .5f || phaseInc < 0)   //above nyquist
+      {
+         mAmp[j] = 0;
+         continue;
+      }
+      
+      float amp = mAmp[j];
+      float ampInc = (mTargetAmp[j] - amp) / bufferSize;
+      float phase = mPhase[j];
+      
+      if (amp != 0 || ampInc != 0)
+      {
+         for (int i=0; i<bufferSize; ++i)
+         {
+            float t = phase + (i+1) * phaseInc;
+            t -= int(t);
+            out[i] += SinCycle(t) * (amp + (i+1) * ampInc);
+         }
+      }
+      
+      phase += bufferSize * phaseInc;
+      phase -= floorf(phase);
+      mPhase[j] = phase;
+      mAmp[j] = mTargetAmp[j];
+   }
+}
@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    PartialBank.h
+    Created: 17 Oct 2026 3:41:27pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SynthGlobals.h"
+
+//a bank of sine partials for additive synthesis.
+//amplitudes are set once per block and ramped across it, and each partial is rendered as a
+//straight run over the block (phase and amp are linear in the sample index) so that loop vectorizes.
+//partials at or above nyquist, and silent ones, are skipped
+class PartialBank
+{
+public:
+   PartialBank(int maxPartials);
+   ~PartialBank();
+   
+   int GetMaxPartials() const { return mMaxPartials; }
+   void SetPartial(int index, float phaseInc, float amp);  //phaseInc as from GetPhaseInc(), amp is reached at the end of the next block
+   void SetPhase(int index, float phase);   //radians
+   void ResetPhases();
+   void Silence(int fromIndex);  //ramps out everything from fromIndex up
+   void Process(float* out, int bufferSize);   //adds into out
+   
+private:
+   int mMaxPartials;
+   float* mPhase;    //in cycles, 0-1
+   float* mPhaseInc; //in cycles per sample
+   float* mAmp;
+   float* mTargetAmp;
+};
@@ -0,0 +1,199 @@
+/*
+  ==============================================================================
+
+    PeakCache.cpp
+    Created: 17 Oct 2026 6:37:12pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "PeakCache.h"
+#include "ChannelBuffer.h"
+
+namespace
+{
+   uint64 PackSpan(int start, int end)
+   {
+      return (uint64(uint32(start)) << 32) | uint32(end);
+   }
+
+   const uint64 kClean = PackSpan(INT_MAX, 0);
+}
+
+PeakCache::PeakCache()
+: mNumChannels(0)
+, mLength(0)
+, mDirty(kClean)
+{
+   for (int ch=0; ch<kMaxChannels; ++ch)
+      mData[ch] = nullptr;
+}
+
+void PeakCache::MarkDirty(int start, int end)
+{
+   start = MAX(start, 0);
+   if (end <= start)
+      return;
+
+   uint64 dirty = mDirty.load(std::memory_order_relaxed);
+   uint64 marked;
+   do
+   {
+      int dirtyStart = int(dirty >> 32);
+      int dirtyEnd = int(dirty & 0xffffffff);
+      marked = PackSpan(MIN(dirtyStart, start), MAX(dirtyEnd, end));
+   } while (!mDirty.compare_exchange_weak(dirty, marked, std::memory_order_relaxed));
+}
+
+void PeakCache::Update(ChannelBuffer* buffer, int length)
+{
+   const float* data[kMaxChannels];
+   int numChannels = MIN(buffer->NumActiveChannels(), int(kMaxChannels));
+   for (int ch=0; ch<numChannels; ++ch)
+      data[ch] = buffer->GetChannel(ch);
+   SetData(data, numChannels, MIN(length, buffer->BufferSize()));
+}
+
+void PeakCache::Update(const float* data, int length)
+{
+   SetData(&data, 1, length);
+}
+
+void PeakCache::SetData(const float* const* data, int numChannels, int length)
+{
+   bool changed = (numChannels != mNumChannels || length != mLength);
+   for (int ch=0; ch<numChannels && !changed; ++ch)
+      changed = (data[ch] != mData[ch]);
+
+   if (changed)
+   {
+      //different buffer, start over
+      mNumChannels = numChannels;
+      mLength = length;
+      for (int ch=0; ch<numChannels; ++ch)
+      {
+         mData[ch] = data[ch];
+         mLevels[ch].clear();
+         for (int level=0; level == 0 || BlockSize(level-1) < length; ++level)
+            mLevels[ch].push_back(vector<Peak>((length + BlockSize(level) - 1) / BlockSize(level)));
+      }
+      mDirty.store(kClean, std::memory_order_relaxed);
+      Rebuild(0, length);
+      return;
+   }
+
+   uint64 dirty = mDirty.exchange(kClean, std::memory_order_relaxed);
+   int dirtyStart = int(dirty >> 32);
+   int dirtyEnd = MIN(int(dirty & 0xffffffff), mLength);
+   if (dirtyStart < dirtyEnd)
+      Rebuild(dirtyStart, dirtyEnd);
+}
+
+void PeakCache::Rebuild(int start, int end)
+{
+   for (int ch=0; ch<mNumChannels; ++ch)
+   {
+      int firstBlock = start / kBaseBlockSize;
+      int lastBlock = (end + kBaseBlockSize - 1) / kBaseBlockSize;
+      vector<Peak>& base = mLevels[ch][0];
+      for (int block=firstBlock; block<lastBlock; ++block)
+      {
+         const float* data = mData[ch] + block * kBaseBlockSize;
+         int numSamples = MIN(int(kBaseBlockSize), mLength - block * kBaseBlockSize);
+         Peak& peak = base[block];
+         peak.mMin = data[0];
+         peak.mMax = data[0];
+         peak.mSumSquares = 0;
+         for (int i=0; i<numSamples; ++i)
+         {
+            peak.mMin = MIN(peak.mMin, data[i]);
+            peak.mMax = MAX(peak.mMax, data[i]);
+            peak.mSumSquares += data[i] * data[i];
+         }
+      }
+
+      for (int level=1; level<(int)mLevels[ch].size(); ++level)
+      {
+         firstBlock /= 2;
+         lastBlock = (lastBlock + 1) / 2;
+         const vector<Peak>& children = mLevels[ch][level-1];
+         vector<Peak>& parents = mLevels[ch][level];
+         for (int block=firstBlock; block<lastBlock; ++block)
+         {
+            Peak& peak = parents[block];
+            peak = children[block*2];
+            if (block*2+1 < (int)children.size())
+            {
+               const Peak& other = children[block*2+1];
+               peak.mMin = MIN(peak.mMin, other.mMin);
+               peak.mMax = MAX(peak.mMax, other.mMax);
+               peak.mSumSquares += other.mSumSquares;
+            }
+         }
+      }
+   }
+}
+
+void PeakCache::GetPeak(int channel, int start, int end, float& min, float& max, float& rms) const
+{
+   start = MAX(start, 0);
+   end = MIN(end, mLength);
+   if (start >= end || channel >= mNumChannels)
+   {
+      min = max = rms = 0;
+      return;
+   }
+
+   int level = 0;
+   while (level+1 < (int)mLevels[channel].size() && BlockSize(level+1) <= end - start)
+      ++level;
+
+   Peak peak;
+   peak.mMin = FLT_MAX;
+   peak.mMax = -FLT_MAX;
+   peak.mSumSquares = 0;
+   Accumulate(channel, level, start, end, peak);
+
+   min = peak.mMin;
+   max = peak.mMax;
+   rms = sqrtf(peak.mSumSquares / (end - start));
+}
+
+//whole blocks from this level, and the ragged edges from the levels below
+void PeakCache::Accumulate(int channel, int level, int start, int end, Peak& peak) const
+{
+   if (start >= end)
+      return;
+
+   if (level < 0)
+   {
+      const float* data = mData[channel];
+      for (int i=start; i<end; ++i)
+      {
+         peak.mMin = MIN(peak.mMin, data[i]);
+         peak.mMax = MAX(peak.mMax, data[i]);
+         peak.mSumSquares += data[i] * data[i];
+      }
+      return;
+   }
+
+   int blockSize = BlockSize(level);
+   int firstBlock = (start + blockSize - 1) / blockSize;
+   int lastBlock = end / blockSize;
+   if (firstBlock >= lastBlock)
+   {
+      Accumulate(channel, level-1, start, end, peak);
+      return;
+   }
+
+   const vector<Peak>& blocks = mLevels[channel][level];
+   for (int block=firstBlock; block<lastBlock; ++block)
+   {
+      peak.mMin = MIN(peak.mMin, blocks[block].mMin);
+      peak.mMax = MAX(peak.mMax, blocks[block].mMax);
+      peak.mSumSquares += blocks[block].mSumSquares;
+   }
+   Accumulate(channel, level-1, start, firstBlock * blockSize, peak);
+   Accumulate(channel, level-1, lastBlock * blockSize, end, peak);
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    PeakCache.h
+    Created: 17 Oct 2026 6:37:12pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include <atomic>
+
+class ChannelBuffer;
+
+//min/max/rms summaries of an audio buffer at power-of-two block sizes, so drawing a waveform
+//costs about the same no matter how many samples are on screen.
+//anything that writes into the buffer reports what it touched with MarkDirty() (fine to call from the audio thread),
+//and the next Update() from the drawing thread rebuilds just those summaries
+class PeakCache
+{
+public:
+   PeakCache();
+
+   void Update(ChannelBuffer* buffer, int length);
+   void Update(const float* data, int length);
+   void MarkDirty(int start, int end);
+   void Invalidate() { MarkDirty(0, INT_MAX); }
+
+   int NumChannels() const { return mNumChannels; }
+   int GetLength() const { return mLength; }
+   void GetPeak(int channel, int start, int end, float& min, float& max, float& rms) const;  //over [start,end)
+
+   static const int kBaseBlockSize = 32;
+
+private:
+   struct Peak
+   {
+      float mMin;
+      float mMax;
+      float mSumSquares;
+   };
+
+   void SetData(const float* const* data, int numChannels, int length);
+   void Rebuild(int start, int end);
+   void Accumulate(int channel, int level, int start, int end, Peak& peak) const;
+   int BlockSize(int level) const { return kBaseBlockSize << level; }
+
+   static const int kMaxChannels = 2;
+
+   const float* mData[kMaxChannels];
+   int mNumChannels;
+   int mLength;
+   vector< vector<Peak> > mLevels[kMaxChannels];  //mLevels[ch][i] holds blocks of BlockSize(i) samples
+   std::atomic<uint64> mDirty;  //start in the high half, end in the low half. start >= end means clean
+};
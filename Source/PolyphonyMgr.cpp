@@ -14,66 +14,160 @@
 #include "SampleVoice.h"
 #include "SynthGlobals.h"
 #include "Profiler.h"
+#include "IDrawableModule.h"
 
 PolyphonyMgr::PolyphonyMgr(IDrawableModule* owner)
-   : mAllowStealing(true)
-   , mLastVoice(-1)
+   : mVoiceType(kVoiceType_Karplus)
+   , mVoiceParams(nullptr)
+   , mAllowStealing(true)
+   , mNumVoicesCreated(0)
+   , mNumScratchBuffers(0)
+   , mVoiceLimit(0)
+   , mRenderInParallel(false)
+   , mJobTime(0)
+   , mJobNumChannels(1)
    , mFadeOutBufferPos(0)
    , mOwner(owner)
    , mFadeOutBuffer(kVoiceFadeSamples)
    , mFadeOutWorkBuffer(kVoiceFadeSamples)
 {
+   for (int i=0; i<kMaxVoices; ++i)
+   {
+      mVoicePool[i] = nullptr;
+      mScratchBuffers[i] = nullptr;
+   }
+   mVoices.reserve(kMaxVoices);
+   mJobVoices.reserve(kMaxVoices);
 }
 
 PolyphonyMgr::~PolyphonyMgr()
 {
-   for (int i=0; i<kNumVoices; ++i)
-      delete mVoices[i].mVoice;
+   for (int i=0; i<mNumVoicesCreated; ++i)
+      delete mVoicePool[i];
+   for (int i=0; i<mNumScratchBuffers; ++i)
+      delete mScratchBuffers[i];
 }
 
 void PolyphonyMgr::Init(VoiceType type, IVoiceParams* params)
 {
-   if (type == kVoiceType_FM)
-   {
-      for (int i=0; i<kNumVoices; ++i)
-      {
-         mVoices[i].mVoice = new FMVoice(mOwner);
-         mVoices[i].mVoice->SetVoiceParams(params);
-      }
-   }
-   else if (type == kVoiceType_Karplus)
+   mVoiceType = type;
+   mVoiceParams = params;
+   CreateVoices(kNumVoices);
+   mVoiceLimit = kNumVoices;
+   ApplyVoiceLimit(kNumVoices);  //nothing is playing us yet
+}
+
+void PolyphonyMgr::SetVoiceLimit(int limit)
+{
+   limit = MAX(1, MIN(limit, int(kMaxVoices)));
+   if (limit == mVoiceLimit)
+      return;
+   
+   CreateVoices(limit);
+   mVoiceLimit.store(limit, std::memory_order_release);
+}
+
+void PolyphonyMgr::SetRenderInParallel(bool parallel)
+{
+   if (parallel == mRenderInParallel)
+      return;
+   
+   if (parallel)
+      CreateScratchBuffers();
+   mRenderInParallel.store(parallel, std::memory_order_release);
+}
+
+IMidiVoice* PolyphonyMgr::CreateVoice()
+{
+   IMidiVoice* voice = nullptr;
+   if (mVoiceType == kVoiceType_FM)
+      voice = new FMVoice(mOwner);
+   else if (mVoiceType == kVoiceType_Karplus)
+      voice = new KarplusStrongVoice(mOwner);
+   else if (mVoiceType == kVoiceType_SingleOscillator)
+      voice = new SingleOscillatorVoice(mOwner);
+   else if (mVoiceType == kVoiceType_Sampler)
+      voice = new SampleVoice(mOwner);
+   else
+      assert(false);  //unsupported voice type
+   
+   voice->SetVoiceParams(mVoiceParams);
+   return voice;
+}
+
+void PolyphonyMgr::CreateVoices(int numVoices)
+{
+   for (; mNumVoicesCreated < numVoices; ++mNumVoicesCreated)
+      mVoicePool[mNumVoicesCreated] = CreateVoice();
+   
+   if (mRenderInParallel)
+      CreateScratchBuffers();
+}
+
+void PolyphonyMgr::CreateScratchBuffers()
+{
+   for (; mNumScratchBuffers < mNumVoicesCreated; ++mNumScratchBuffers)
    {
-      for (int i=0; i<kNumVoices; ++i)
-      {
-         mVoices[i].mVoice = new KarplusStrongVoice(mOwner);
-         mVoices[i].mVoice->SetVoiceParams(params);
-      }
+      //touch every channel now, so the audio thread never allocates them
+      ChannelBuffer* scratch = new ChannelBuffer(gBufferSize);
+      scratch->SetNumActiveChannels(ChannelBuffer::kMaxNumChannels);
+      for (int ch=0; ch<ChannelBuffer::kMaxNumChannels; ++ch)
+         scratch->GetChannel(ch);
+      mScratchBuffers[mNumScratchBuffers] = scratch;
    }
-   else if (type == kVoiceType_SingleOscillator)
+}
+
+//audio thread. voices past the new limit just stop, they're kept in the pool in case the limit goes back up
+void PolyphonyMgr::ApplyVoiceLimit(int numVoices)
+{
+   int oldNumVoices = mVoices.size();
+   for (int i=numVoices; i<oldNumVoices; ++i)
    {
-      for (int i=0; i<kNumVoices; ++i)
-      {
-         mVoices[i].mVoice = new SingleOscillatorVoice(mOwner);
-         mVoices[i].mVoice->SetVoiceParams(params);
-      }
+      Remove(mVoices[i].mPitch != -1 ? mActive : mFree, i);
+      mVoices[i].mVoice->ClearVoice();
    }
-   else if (type == kVoiceType_Sampler)
+   
+   mVoices.resize(numVoices);  //within what we reserved, so this never allocates
+   for (int i=oldNumVoices; i<numVoices; ++i)
    {
-      for (int i=0; i<kNumVoices; ++i)
-      {
-         mVoices[i].mVoice = new SampleVoice(mOwner);
-         mVoices[i].mVoice->SetVoiceParams(params);
-      }
+      mVoices[i] = VoiceInfo();
+      mVoices[i].mVoice = mVoicePool[i];
+      PushBack(mFree, i);
    }
+}
+
+void PolyphonyMgr::PushBack(VoiceList& list, int index)
+{
+   mVoices[index].mPrev = list.mTail;
+   mVoices[index].mNext = -1;
+   if (list.mTail != -1)
+      mVoices[list.mTail].mNext = index;
    else
-   {
-      assert(false);  //unsupported voice type
-   }
+      list.mHead = index;
+   list.mTail = index;
+   ++list.mCount;
+}
+
+void PolyphonyMgr::Remove(VoiceList& list, int index)
+{
+   VoiceInfo& info = mVoices[index];
+   if (info.mPrev != -1)
+      mVoices[info.mPrev].mNext = info.mNext;
+   else
+      list.mHead = info.mNext;
+   if (info.mNext != -1)
+      mVoices[info.mNext].mPrev = info.mPrev;
+   else
+      list.mTail = info.mPrev;
+   info.mPrev = -1;
+   info.mNext = -1;
+   --list.mCount;
 }
 
 void PolyphonyMgr::Start(double time, int pitch, float amount, int voiceIdx, ModulationParameters modulation)
 {
-   assert(voiceIdx < kNumVoices);
+   if (voiceIdx >= (int)mVoices.size())
+      voiceIdx = -1;  //asked for a voice past this instance's limit, pick one as usual
    
    amount = amount * amount; //increase the importance of velocity
    
@@ -82,7 +176,7 @@ void PolyphonyMgr::Start(double time, int pitch, float amount, int voiceIdx, Mod
 
    if (voiceIdx == -1) //haven't specified a voice
    {
-      for (int i=0; i<kNumVoices; ++i)
+      for (int i=mActive.mHead; i!=-1; i=mVoices[i].mNext)
       {
          if (mVoices[i].mPitch == pitch)
          {
@@ -94,38 +188,14 @@ void PolyphonyMgr::Start(double time, int pitch, float amount, int voiceIdx, Mod
    }
    
    if (voiceIdx == -1) //need a new voice
-   {
-      for (int i=0; i<kNumVoices; ++i)
-      {
-         int check = (i + mLastVoice + 1) % 16;  //try to keep incrementing through list to allow old voices to finish
-         if (mVoices[check].mPitch == -1)
-         {
-            voiceIdx = check;
-            break;
-         }
-      }
-   }
+      voiceIdx = mFree.mHead;  //the one that's been idle longest, to allow old voices to finish
 
    if (voiceIdx == -1)   //all used
    {
       if (mAllowStealing)
-      {
-         double oldest = mVoices[0].mTime;
-         int oldestIndex = 0;
-         for (int i=1; i<kNumVoices; ++i)
-         {
-            if (mVoices[i].mTime < oldest)
-            {
-               oldest = mVoices[i].mTime;
-               oldestIndex = i;
-            }
-         }
-         voiceIdx = oldestIndex;
-      }
+         voiceIdx = mActive.mHead;  //oldest
       else
-      {
          return;
-      }
    }
    
    IMidiVoice* voice = mVoices[voiceIdx].mVoice;
@@ -134,7 +204,6 @@ void PolyphonyMgr::Start(double time, int pitch, float amount, int voiceIdx, Mod
    voice->SetModulators(modulation);
    if (!preserveVoice || modulation.pan != voice->GetPan())
    {
-      Clear(mWorkBuffer, kVoiceFadeSamples);
       voice->Process(time, &mFadeOutWorkBuffer);
       for (int i=0; i<kVoiceFadeSamples; ++i)
       {
@@ -148,15 +217,16 @@ void PolyphonyMgr::Start(double time, int pitch, float amount, int voiceIdx, Mod
    }
    voice->Start(time, amount);
    voice->SetPan(modulation.pan);
-   mLastVoice = voiceIdx;
    
+   Remove(mVoices[voiceIdx].mPitch != -1 ? mActive : mFree, voiceIdx);
+   PushBack(mActive, voiceIdx);
    mVoices[voiceIdx].mPitch = pitch;
    mVoices[voiceIdx].mTime = time;
 }
 
 void PolyphonyMgr::Stop(double time, int pitch)
 {
-   for (int i=0; i<kNumVoices; ++i)
+   for (int i=mActive.mHead; i!=-1; i=mVoices[i].mNext)
    {
       if (mVoices[i].mPitch == pitch)
          mVoices[i].mVoice->Stop(time);
@@ -167,16 +237,31 @@ void PolyphonyMgr::Process(double time, ChannelBuffer* out, int bufferSize)
 {
    Profiler profiler("PolyphonyMgr");
    
+   int voiceLimit = mVoiceLimit.load(std::memory_order_acquire);
+   if (voiceLimit != (int)mVoices.size())
+      ApplyVoiceLimit(voiceLimit);
+   
    mFadeOutBuffer.SetNumActiveChannels(out->NumActiveChannels());
    mFadeOutWorkBuffer.SetNumActiveChannels(out->NumActiveChannels());
 
-   for (int i=0; i<kNumVoices; ++i)
+   if (!ProcessParallel(time, out, bufferSize))
+   {
+      for (int i=mActive.mHead; i!=-1; i=mVoices[i].mNext)
+         mVoices[i].mVoice->Process(time, out);
+   }
+   
+   int voice = mActive.mHead;
+   while (voice != -1)
    {
-      Clear(mWorkBuffer, bufferSize);
-      mVoices[i].mVoice->Process(time, out);
-      
-      if (mVoices[i].mPitch != -1 && mVoices[i].mVoice->IsDone(time))
-         mVoices[i].mPitch = -1;
+      int next = mVoices[voice].mNext;
+      //a note that starts later on looks done until it gets there, so only let go of voices that have started
+      if (mVoices[voice].mTime <= time && mVoices[voice].mVoice->IsDone(time))
+      {
+         Remove(mActive, voice);
+         PushBack(mFree, voice);
+         mVoices[voice].mPitch = -1;
+      }
+      voice = next;
    }
    
    for (int ch=0; ch<out->NumActiveChannels(); ++ch)
@@ -191,3 +276,41 @@ void PolyphonyMgr::Process(double time, ChannelBuffer* out, int bufferSize)
    
    mFadeOutBufferPos += bufferSize;
 }
+
+bool PolyphonyMgr::ProcessParallel(double time, ChannelBuffer* out, int bufferSize)
+{
+   if (!mRenderInParallel.load(std::memory_order_acquire) || mActive.mCount < 2 || TheVoiceRenderPool == nullptr)
+      return false;
+   //voices can only run side by side if nothing changes under them. inside a slider block the sliders hold still,
+   //and voices read any modulation from the values computed for the block
+   if (mOwner != nullptr && !mOwner->IsInSliderBlock())
+      return false;
+   if (mScratchBuffers[0]->BufferSize() != out->BufferSize())
+      return false;
+   
+   mJobVoices.clear();
+   for (int i=mActive.mHead; i!=-1; i=mVoices[i].mNext)
+      mJobVoices.push_back(i);
+   mJobTime = time;
+   mJobNumChannels = out->NumActiveChannels();
+   if (!TheVoiceRenderPool->Run(this, (int)mJobVoices.size()))
+      return false;
+   
+   //always summed in the same order, so the output doesn't depend on which thread finished first
+   for (int voice : mJobVoices)
+   {
+      ChannelBuffer* scratch = mScratchBuffers[voice];
+      for (int ch=0; ch<mJobNumChannels; ++ch)
+         Add(out->GetChannel(ch), scratch->GetChannel(ch), bufferSize);
+   }
+   return true;
+}
+
+void PolyphonyMgr::RunJob(int index)
+{
+   int voice = mJobVoices[index];
+   ChannelBuffer* scratch = mScratchBuffers[voice];
+   scratch->Clear();
+   scratch->SetNumActiveChannels(mJobNumChannels);
+   mVoices[voice].mVoice->Process(mJobTime, scratch);
+}
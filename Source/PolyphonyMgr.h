@@ -13,6 +13,8 @@
 #include "OpenFrameworksPort.h"
 #include "SynthGlobals.h"
 #include "ChannelBuffer.h"
+#include "VoiceRenderPool.h"
+#include <atomic>
 
 const int kVoiceFadeSamples = 50;
 
@@ -31,14 +33,16 @@ enum VoiceType
 
 struct VoiceInfo
 {
-   VoiceInfo() : mPitch(-1) {}
+   VoiceInfo() : mPitch(-1), mVoice(nullptr), mTime(0), mPrev(-1), mNext(-1) {}
    
    float mPitch;
    IMidiVoice* mVoice;
    double mTime;
+   int mPrev;   //neighbours in whichever voice list this one is in
+   int mNext;
 };
 
-class PolyphonyMgr
+class PolyphonyMgr : private VoiceRenderPool::IJobList
 {
 public:
    PolyphonyMgr(IDrawableModule* owner);
@@ -51,15 +55,52 @@ public:
    void Stop(double time, int pitch);
    void Process(double time, ChannelBuffer* out, int bufferSize);
    void GetPhaseAndInc(float& phase, float& inc);
+   void SetVoiceLimit(int limit);   //main thread, takes effect at the start of the next block
+   int GetVoiceLimit() const { return mVoiceLimit; }
+   void SetRenderInParallel(bool parallel);   //main thread
+   bool IsRenderingInParallel() const { return mRenderInParallel; }
+   
+   static const int kMaxVoices = 128;
 private:
+   //voices are linked into one of two lists, so finding a free voice, picking one to steal, and skipping over silent
+   //ones never has to look through the whole pool
+   struct VoiceList
+   {
+      VoiceList() : mHead(-1), mTail(-1), mCount(0) {}
+      int mHead;
+      int mTail;
+      int mCount;
+   };
+   
    void Prune(double time);
+   IMidiVoice* CreateVoice();
+   void CreateVoices(int numVoices);
+   void CreateScratchBuffers();
+   void ApplyVoiceLimit(int numVoices);
+   void PushBack(VoiceList& list, int index);
+   void Remove(VoiceList& list, int index);
+   bool ProcessParallel(double time, ChannelBuffer* out, int bufferSize);
+   void RunJob(int index) override;
    
-   VoiceInfo mVoices[kNumVoices];
+   VoiceType mVoiceType;
+   IVoiceParams* mVoiceParams;
+   vector<VoiceInfo> mVoices;   //audio thread
+   VoiceList mFree;   //longest idle first
+   VoiceList mActive;   //oldest note first, so the head is the one to steal
    bool mAllowStealing;
-   int mLastVoice;
+   //voices and scratch buffers get made on the main thread before a new limit is published, and stick around
+   //after it's lowered again, so the audio thread never allocates or frees one
+   IMidiVoice* mVoicePool[kMaxVoices];
+   int mNumVoicesCreated;
+   ChannelBuffer* mScratchBuffers[kMaxVoices];   //one per voice while rendering in parallel, so voices never share an output
+   int mNumScratchBuffers;
+   std::atomic<int> mVoiceLimit;
+   std::atomic<bool> mRenderInParallel;
+   vector<int> mJobVoices;   //this block's active voices, in the order they're summed
+   double mJobTime;
+   int mJobNumChannels;
    ChannelBuffer mFadeOutBuffer;
    ChannelBuffer mFadeOutWorkBuffer;
-   float mWorkBuffer[2048];
    int mFadeOutBufferPos;
    IDrawableModule* mOwner;
 };
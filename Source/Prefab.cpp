@@ -163,7 +163,7 @@ void Prefab::SavePrefab(string savePath)
 
 void Prefab::LoadPrefab(string loadPath)
 {
-   ScopedMutex mutex(TheSynth->GetAudioMutex(), "LoadPrefab()");
+   ScopedGraphEdit edit;
    ScopedLock renderLock(*TheSynth->GetRenderLock());
    
    mModuleContainer.Clear();
@@ -8,50 +8,297 @@
 
 #include "Profiler.h"
 #include "SynthGlobals.h"
+#include "DeadlineMonitor.h"
+#include <limits>
 
-map<uint32_t, string> Profiler::sNameLookup;
-map<uint32_t, Profiler::Cost> Profiler::sCosts;
-bool Profiler::sEnableProfiler = false;
+std::atomic<const char*> Profiler::sNameSlots[kMaxNames*2];
+std::atomic<int> Profiler::sNameSlotIds[kMaxNames*2];
+std::atomic<const char*> Profiler::sNames[kMaxNames];
+std::atomic<int> Profiler::sNumNames(0);
+std::atomic<Profiler::ThreadState*> Profiler::sThreads[kMaxThreads];
+std::atomic<int> Profiler::sNumThreads(0);
+CriticalSection Profiler::sThreadsMutex;
+std::atomic<int64> Profiler::sNumFrames(0);
+int64 Profiler::sLastTotals[kMaxNames];
+int64 Profiler::sLastNumFrames = 0;
+int Profiler::sHistory[kMaxNames][PROFILER_HISTORY_LENGTH];
+int Profiler::sHistoryIdx = 0;
+std::atomic<bool> Profiler::sEnableProfiler(false);
+std::atomic<bool> Profiler::sResetRequested(false);
+
+namespace
+{
+   //gives the thread's slot back when the thread exits, so restarted worker threads don't use up the table
+   struct ThreadStateReleaser
+   {
+      ThreadStateReleaser() : mInUse(nullptr) {}
+      ~ThreadStateReleaser() { if (mInUse) mInUse->store(false, std::memory_order_release); }
+      std::atomic<bool>* mInUse;
+   };
+   
+   thread_local ThreadStateReleaser tThreadStateReleaser;
+}
 
 Profiler::Profiler(const char* name, bool master)
-: mMaster(master)
+: mName(-1)
+, mChildTicks(0)
+, mParent(nullptr)
+, mMaster(master)
+, mRecordTrace(false)
+, mThread(nullptr)
 {
-   if (sEnableProfiler || mMaster)
+   mRecordTrace = sEnableProfiler.load(std::memory_order_relaxed);
+   if (!mRecordTrace && !master)
+      return;
+   
+   mName = InternName(name);
+   mThread = GetThreadState(false);
+   if (mName == -1 || mThread == nullptr)
    {
-      mName = JenkinsHash(name);
-      mTimerStart = ofGetSystemTimeMicros();
-      if (sNameLookup.find(mName) == sNameLookup.end())
-         sNameLookup[mName] = name;
+      mName = -1;
+      return;
    }
+   ++mThread->mDepth;
+   mParent = mThread->mCurrentScope;
+   mThread->mCurrentScope = this;
+   mTimerStart = Time::getHighResolutionTicks();
 }
 
 Profiler::~Profiler()
 {
-   if (sEnableProfiler || mMaster)
+   if (mName == -1)
+      return;
+   
+   int64 timerEnd = Time::getHighResolutionTicks();
+   int64 ticks = timerEnd - mTimerStart;
+   --mThread->mDepth;
+   mThread->mCurrentScope = mParent;
+   if (mParent != nullptr)
+      mParent->mChildTicks += ticks;
+   
+   //a master scope is the whole callback, so it keeps what its children took
+   int64 cost = mMaster ? ticks : ticks - mChildTicks;
+   
+   //only this thread writes to its costs, so there's no need for a locked add
+   std::atomic<int64>& total = mThread->mTotalTicks[mName];
+   total.store(total.load(std::memory_order_relaxed) + cost, std::memory_order_relaxed);
+   if (!mMaster && cost > mThread->mHeaviestTicks.load(std::memory_order_relaxed))
+   {
+      mThread->mHeaviestScope.store(mName, std::memory_order_relaxed);
+      mThread->mHeaviestTicks.store(cost, std::memory_order_relaxed);
+   }
+   
+   if (mRecordTrace)
    {
-      long timerEnd = ofGetSystemTimeMicros();
-      long timerLength = timerEnd - mTimerStart;
+      uint64 index = mThread->mNumEvents.load(std::memory_order_relaxed);
+      TraceEvent& event = mThread->mEvents[index & (kTraceEventsPerThread-1)];
+      event.mName = mName;
+      event.mDepth = mThread->mDepth;
+      event.mStartTicks = mTimerStart;
+      event.mEndTicks = timerEnd;
+      mThread->mNumEvents.store(index+1, std::memory_order_release);
+   }
    
-      sCosts[mName].mFrameCost += timerLength;
+   if (mMaster)
+   {
+      sNumFrames.fetch_add(1, std::memory_order_relaxed);
+      int heaviestScope = TakeHeaviestScope();
+      if (TheDeadlineMonitor != nullptr)
+         TheDeadlineMonitor->RecordCallback(mTimerStart, timerEnd, heaviestScope);
    }
 }
 
+//the scope with the longest exclusive time any thread ran since the last time this was called, ignoring master scopes
 //static
-void Profiler::PrintCounters()
+int Profiler::TakeHeaviestScope()
 {
-   //bool printedBreak = false;
-   for (auto iter = sCosts.begin(); iter != sCosts.end(); ++iter)
+   int heaviestScope = -1;
+   int64 heaviestTicks = 0;
+   int numThreads = MIN(sNumThreads.load(std::memory_order_acquire), kMaxThreads);
+   for (int i=0; i<numThreads; ++i)
    {
-      /*if ((*iter).second.mFrameCost > 500)
+      ThreadState* state = sThreads[i].load(std::memory_order_acquire);
+      int64 ticks = state->mHeaviestTicks.exchange(0, std::memory_order_relaxed);
+      if (ticks > heaviestTicks)
       {
-         if (!printedBreak)
+         heaviestTicks = ticks;
+         heaviestScope = state->mHeaviestScope.load(std::memory_order_relaxed);
+      }
+   }
+   return heaviestScope;
+}
+
+//string literals have a fixed address, so that's all we hash. the same name at two addresses
+//just gets two ids, which Draw() and GetUsage() merge back together
+//static
+int Profiler::InternName(const char* name)
+{
+   const int kNumSlots = kMaxNames*2;
+   uint32 slot = uint32((uint64(name) >> 3) * 2654435761u) % kNumSlots;
+   for (int probe=0; probe<kNumSlots; ++probe)
+   {
+      const char* existing = sNameSlots[slot].load(std::memory_order_acquire);
+      if (existing == nullptr)
+      {
+         if (sNameSlots[slot].compare_exchange_strong(existing, name, std::memory_order_acq_rel))
          {
-            ofLog() << "******* PrintCounters():";
-            printedBreak = true;
+            int id = sNumNames.fetch_add(1);
+            if (id >= kMaxNames)
+            {
+               sNameSlotIds[slot].store(kMaxNames, std::memory_order_release);
+               return -1;
+            }
+            sNames[id].store(name, std::memory_order_release);
+            sNameSlotIds[slot].store(id+1, std::memory_order_release);
+            return id;
          }
-         ofLog() << (*iter).first << " " << (*iter).second.mFrameCost << " us";
-      }*/
-      (*iter).second.EndFrame();
+      }
+      if (existing == name)
+      {
+         int id = sNameSlotIds[slot].load(std::memory_order_acquire) - 1;
+         if (id < 0 || id >= kMaxNames)
+            return -1;  //full, or another thread is still registering it
+         return id;
+      }
+      slot = (slot + 1) % kNumSlots;
+   }
+   return -1;
+}
+
+//static
+void Profiler::RegisterThread()
+{
+   GetThreadState(true);
+}
+
+//static
+void Profiler::ReserveThreads(int numThreads)
+{
+   ScopedLock lock(sThreadsMutex);
+   int numFree = 0;
+   for (int i=0; i<sNumThreads.load(std::memory_order_acquire); ++i)
+   {
+      if (!sThreads[i].load(std::memory_order_acquire)->mInUse.load(std::memory_order_acquire))
+         ++numFree;
+   }
+   
+   for (; numFree < numThreads && sNumThreads.load() < kMaxThreads; ++numFree)
+   {
+      int index = sNumThreads.load();
+      sThreads[index].store(new ThreadState(), std::memory_order_release);
+      sNumThreads.store(index+1, std::memory_order_release);
+   }
+}
+
+//claims a state left behind by a finished thread, or one set aside by ReserveThreads(). a thread state is big,
+//so only RegisterThread() makes a new one, that way a scope never allocates in the middle of processing
+//static
+Profiler::ThreadState* Profiler::GetThreadState(bool allowAllocation)
+{
+   static thread_local ThreadState* sThreadState = nullptr;
+   if (sThreadState != nullptr)
+      return sThreadState;
+   
+   int numThreads = MIN(sNumThreads.load(std::memory_order_acquire), kMaxThreads);
+   for (int i=0; i<numThreads; ++i)
+   {
+      ThreadState* state = sThreads[i].load(std::memory_order_acquire);
+      bool inUse = false;
+      if (state->mInUse.compare_exchange_strong(inUse, true, std::memory_order_acq_rel))
+      {
+         sThreadState = state;
+         break;
+      }
+   }
+   
+   if (sThreadState == nullptr)
+   {
+      if (!allowAllocation)
+         return nullptr;
+      
+      ScopedLock lock(sThreadsMutex);
+      int index = sNumThreads.load();
+      if (index >= kMaxThreads)
+         return nullptr;
+      ThreadState* state = new ThreadState();
+      state->mInUse = true;
+      sThreads[index].store(state, std::memory_order_release);
+      sNumThreads.store(index+1, std::memory_order_release);
+      sThreadState = state;
+   }
+   
+   Thread* thread = Thread::getCurrentThread();
+   MessageManager* messageManager = MessageManager::getInstanceWithoutCreating();
+   String threadName;
+   if (thread != nullptr)
+      threadName = thread->getThreadName();
+   else if (messageManager != nullptr && messageManager->isThisTheMessageThread())
+      threadName = "ui";
+   else
+      threadName = "audio";
+   threadName.copyToUTF8(sThreadState->mThreadName, sizeof(sThreadState->mThreadName));
+   sThreadState->mDepth = 0;
+   sThreadState->mCurrentScope = nullptr;
+   tThreadStateReleaser.mInUse = &sThreadState->mInUse;
+   return sThreadState;
+}
+
+Profiler::ThreadState::ThreadState()
+: mInUse(false)
+, mDepth(0)
+, mCurrentScope(nullptr)
+, mHeaviestScope(-1)
+, mHeaviestTicks(0)
+, mNumEvents(0)
+{
+   mThreadName[0] = 0;
+   for (int i=0; i<kMaxNames; ++i)
+      mTotalTicks[i] = 0;
+}
+
+//static
+void Profiler::ToggleProfiler()
+{
+   sEnableProfiler = !sEnableProfiler;
+   sResetRequested = true;
+}
+
+//ui thread. adds up what every thread spent in each scope since the last call, as an average per audio frame
+//static
+void Profiler::SumCosts()
+{
+   bool reset = sResetRequested.exchange(false);
+   double microsecondsPerTick = 1000000.0 / Time::getHighResolutionTicksPerSecond();
+   int numNames = MIN(sNumNames.load(std::memory_order_acquire), kMaxNames);
+   int numThreads = MIN(sNumThreads.load(std::memory_order_acquire), kMaxThreads);
+   int64 numFrames = sNumFrames.load(std::memory_order_relaxed);
+   int64 frames = numFrames - sLastNumFrames;
+   sLastNumFrames = numFrames;
+   
+   for (int name=0; name<numNames; ++name)
+   {
+      int64 totalTicks = 0;
+      for (int i=0; i<numThreads; ++i)
+         totalTicks += sThreads[i].load(std::memory_order_acquire)->mTotalTicks[name].load(std::memory_order_relaxed);
+      int64 ticks = totalTicks - sLastTotals[name];
+      sLastTotals[name] = totalTicks;
+      
+      if (reset)  //just toggled on, so most of these frames weren't timed
+      {
+         for (int i=0; i<PROFILER_HISTORY_LENGTH; ++i)
+            sHistory[name][i] = 0;
+      }
+      else if (frames > 0)
+      {
+         sHistory[name][sHistoryIdx] = int(ticks * microsecondsPerTick / frames);
+      }
+   }
+   
+   if (frames > 0 && !reset)
+   {
+      ++sHistoryIdx;
+      if (sHistoryIdx >= PROFILER_HISTORY_LENGTH)
+         sHistoryIdx = 0;
    }
 }
 
@@ -61,20 +308,31 @@ void Profiler::Draw()
    if (!sEnableProfiler)
       return;
    
+   SumCosts();
+   
+   map<string, long> costs;
+   int numNames = MIN(sNumNames.load(std::memory_order_acquire), kMaxNames);
+   for (int name=0; name<numNames; ++name)
+   {
+      const char* nameStr = sNames[name].load(std::memory_order_acquire);
+      long maxCost = MaxCost(name);
+      if (nameStr != nullptr && maxCost > 0)
+         costs[nameStr] = MAX(costs[nameStr], maxCost);
+   }
+   
    ofPushMatrix();
    ofTranslate(30,30);
    ofPushStyle();
    ofFill();
    ofSetColor(0,0,0,140);
-   ofRect(-5,-15,600,sCosts.size()*15+10);
+   ofRect(-5,-15,600,costs.size()*15+10);
    long entireFrameUs = GetSafeFrameLengthMicroseconds();
-   for (auto iter = sCosts.begin(); iter != sCosts.end(); ++iter)
+   for (auto iter = costs.begin(); iter != costs.end(); ++iter)
    {
-      const Cost& cost = (*iter).second;
-      long maxCost = cost.MaxCost();
+      long maxCost = iter->second;
       
       ofSetColor(255,255,255);
-      gFont.DrawString(sNameLookup[(*iter).first]+": "+ofToString(maxCost), 15, 0, 0);
+      gFont.DrawString(iter->first+": "+ofToString(maxCost), 15, 0, 0);
       
       if (maxCost > entireFrameUs)
          ofSetColor(255,0,0);
@@ -88,6 +346,73 @@ void Profiler::Draw()
    ofPopMatrix();
 }
 
+//writes the scopes still in each thread's ring in chrome trace event format, for chrome://tracing or ui.perfetto.dev
+//static
+bool Profiler::SaveTrace(string path)
+{
+   double microsecondsPerTick = 1000000.0 / Time::getHighResolutionTicksPerSecond();
+   int64 firstTick = std::numeric_limits<int64>::max();
+   vector< vector<TraceEvent> > threadEvents;
+   vector<string> threadNames;
+   
+   int numThreads = MIN(sNumThreads.load(std::memory_order_acquire), kMaxThreads);
+   for (int i=0; i<numThreads; ++i)
+   {
+      ThreadState* state = sThreads[i].load(std::memory_order_acquire);
+      threadEvents.push_back(vector<TraceEvent>());
+      threadNames.push_back(state ? state->mThreadName : "");
+      if (state == nullptr)
+         continue;
+      
+      uint64 end = state->mNumEvents.load(std::memory_order_acquire);
+      uint64 begin = end > kTraceEventsPerThread ? end - kTraceEventsPerThread : 0;
+      vector<TraceEvent>& events = threadEvents.back();
+      for (uint64 index = begin; index < end; ++index)
+         events.push_back(state->mEvents[index & (kTraceEventsPerThread-1)]);
+      
+      //the thread kept going while we copied, drop anything it may have overwritten
+      uint64 endAfterCopy = state->mNumEvents.load(std::memory_order_acquire);
+      uint64 safeBegin = endAfterCopy > kTraceEventsPerThread ? endAfterCopy - kTraceEventsPerThread : 0;
+      if (safeBegin > begin)
+         events.erase(events.begin(), events.begin() + (int)MIN(safeBegin - begin, uint64(events.size())));
+      
+      if (!events.empty())
+         firstTick = MIN(firstTick, events.front().mStartTicks);
+   }
+   
+   String json = "{\"traceEvents\":[\n";
+   bool first = true;
+   for (int i=0; i<(int)threadEvents.size(); ++i)
+   {
+      if (threadEvents[i].empty())
+         continue;
+      
+      json += String(first ? "" : ",\n") + "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + String(i) + ",\"args\":{\"name\":\"" + String(threadNames[i]) + "\"}}";
+      first = false;
+      
+      for (const auto& event : threadEvents[i])
+      {
+         const char* name = sNames[event.mName].load(std::memory_order_acquire);
+         json += ",\n{\"name\":\"" + String(name).replace("\"", "\\\"") + "\",\"ph\":\"X\",\"pid\":1,\"tid\":" + String(i) +
+                 ",\"ts\":" + String((event.mStartTicks - firstTick) * microsecondsPerTick, 3) +
+                 ",\"dur\":" + String((event.mEndTicks - event.mStartTicks) * microsecondsPerTick, 3) +
+                 ",\"args\":{\"depth\":" + String(event.mDepth) + "}}";
+      }
+   }
+   json += "\n]}\n";
+   
+   File file(ofToDataPath(path).c_str());
+   return file.replaceWithText(json);
+}
+
+//static
+const char* Profiler::GetScopeName(int id)
+{
+   if (id < 0 || id >= MIN(sNumNames.load(std::memory_order_acquire), kMaxNames))
+      return nullptr;
+   return sNames[id].load(std::memory_order_acquire);
+}
+
 //static
 long Profiler::GetSafeFrameLengthMicroseconds()
 {
@@ -99,22 +424,22 @@ long Profiler::GetSafeFrameLengthMicroseconds()
 //static
 float Profiler::GetUsage(const char* counter)
 {
-   return sCosts[JenkinsHash(counter)].MaxCost() / float(GetSafeFrameLengthMicroseconds());
-}
-
-void Profiler::Cost::EndFrame()
-{
-   mHistory[mHistoryIdx] = mFrameCost;
-   mFrameCost = 0;
-   ++mHistoryIdx;
-   if (mHistoryIdx >= PROFILER_HISTORY_LENGTH)
-      mHistoryIdx = 0;
+   long maxCost = 0;
+   int numNames = MIN(sNumNames.load(std::memory_order_acquire), kMaxNames);
+   for (int name=0; name<numNames; ++name)
+   {
+      const char* nameStr = sNames[name].load(std::memory_order_acquire);
+      if (nameStr != nullptr && strcmp(nameStr, counter) == 0)
+         maxCost = MAX(maxCost, MaxCost(name));
+   }
+   return maxCost / float(GetSafeFrameLengthMicroseconds());
 }
 
-long Profiler::Cost::MaxCost() const
+//static
+long Profiler::MaxCost(int name)
 {
    long maxCost = 0;
    for (int i=0; i<PROFILER_HISTORY_LENGTH; ++i)
-      maxCost = MAX(maxCost, mHistory[i]);
+      maxCost = MAX(maxCost, (long)sHistory[name][i]);
    return maxCost;
 }
@@ -11,43 +11,89 @@
 
 #include "OpenFrameworksPort.h"
 #include "SynthGlobals.h"
+#include <atomic>
 
 #define PROFILER_HISTORY_LENGTH 500
 
+//scoped timer. names must be string literals, they're interned by address so a scope costs a couple of
+//table lookups and no locks. each thread keeps its own running costs and a ring of recent scopes,
+//which can be saved as a chrome/perfetto trace to see exactly what ran where.
+//scopes only do anything while the profiler is toggled on, except master scopes, which always report to
+//TheDeadlineMonitor. costs are exclusive, time spent in a nested scope only counts towards that scope
 class Profiler
 {
 public:
    Profiler(const char* name, bool master = false);
    ~Profiler();
    
-   static void PrintCounters();
+   static void RegisterThread();  //sets up the calling thread's costs and trace ring, so its first scope doesn't have to
+   static void ReserveThreads(int numThreads);  //for threads we don't start ourselves, like the audio device's
    static void Draw();
    
    static float GetUsage(const char* counter);
    
-   static void ToggleProfiler() { sEnableProfiler = !sEnableProfiler; sCosts.clear(); }
+   static void ToggleProfiler();
+   static bool IsEnabled() { return sEnableProfiler; }
+   static bool SaveTrace(string path);
+   static const char* GetScopeName(int id);
+   
+   static const int kMaxNames = 256;
+   static const int kMaxThreads = 32;
+   static const int kTraceEventsPerThread = 16384;  //power of two
    
 private:
-   static long GetSafeFrameLengthMicroseconds();
+   struct TraceEvent
+   {
+      int mName;
+      int mDepth;
+      int64 mStartTicks;
+      int64 mEndTicks;
+   };
    
-   struct Cost
+   struct ThreadState
    {
-      Cost() : mFrameCost(0), mHistoryIdx(0) { bzero(mHistory, sizeof(long)); }
-      void EndFrame();
-      long MaxCost() const;
-      
-      long mFrameCost;
-      long mHistory[PROFILER_HISTORY_LENGTH];
-      int mHistoryIdx;
+      ThreadState();
+      std::atomic<bool> mInUse;
+      char mThreadName[64];
+      int mDepth;
+      Profiler* mCurrentScope;
+      std::atomic<int64> mTotalTicks[kMaxNames];  //running totals, only written by the owning thread
+      std::atomic<int> mHeaviestScope;  //since the last master scope ended
+      std::atomic<int64> mHeaviestTicks;
+      TraceEvent mEvents[kTraceEventsPerThread];
+      std::atomic<uint64> mNumEvents;
    };
    
-   long mTimerStart;
-   uint32_t mName;
+   static int InternName(const char* name);
+   static ThreadState* GetThreadState(bool allowAllocation);
+   static int TakeHeaviestScope();
+   static void SumCosts();
+   static long GetSafeFrameLengthMicroseconds();
+   static long MaxCost(int name);
+   
+   int mName;
+   int64 mTimerStart;
+   int64 mChildTicks;  //spent in scopes nested inside this one
+   Profiler* mParent;
    bool mMaster;
+   bool mRecordTrace;
+   ThreadState* mThread;
    
-   static map<uint32_t, string> sNameLookup;
-   static map<uint32_t, Cost> sCosts;
-   static bool sEnableProfiler;
+   static std::atomic<const char*> sNameSlots[kMaxNames*2];
+   static std::atomic<int> sNameSlotIds[kMaxNames*2];
+   static std::atomic<const char*> sNames[kMaxNames];
+   static std::atomic<int> sNumNames;
+   static std::atomic<ThreadState*> sThreads[kMaxThreads];
+   static std::atomic<int> sNumThreads;
+   static CriticalSection sThreadsMutex;  //for adding thread states
+   static std::atomic<int64> sNumFrames;  //master scopes that have ended
+   //ui thread
+   static int64 sLastTotals[kMaxNames];
+   static int64 sLastNumFrames;
+   static int sHistory[kMaxNames][PROFILER_HISTORY_LENGTH];  //average microseconds per frame
+   static int sHistoryIdx;
+   static std::atomic<bool> sEnableProfiler;
+   static std::atomic<bool> sResetRequested;
 };
 
 #endif /* defined(__modularSynth__Profiler__) */
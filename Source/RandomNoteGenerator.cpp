@@ -80,7 +80,7 @@ void RandomNoteGenerator::OnTimeEvent(int samplesTo)
    {
       mSkipCount = 0;
       if (mProbability >= ofRandom(1))
-         PlayNoteOutput(gTime, mPitch, mVelocity*127, -1);
+         PlayNoteOutput(gTime + samplesTo * gInvSampleRateMs, mPitch, mVelocity*127, -1);
    }
 }
 
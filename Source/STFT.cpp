@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    STFT.cpp
+    Created: 17 Oct 2026 11:02:17pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "STFT.h"
+
+STFT::STFT(int windowSize, int hopSize, int numInputs)
+: mWindowSize(windowSize)
+, mHopSize(hopSize)
+, mNumInputs(numInputs)
+, mListener(nullptr)
+, mFFT(windowSize)
+, mAnalysisWindow(windowSize)
+, mSynthesisWindow(windowSize)
+, mInputHistory(numInputs, vector<float>(windowSize))
+, mOutput(windowSize)
+, mTimeDomain(windowSize)
+, mReal(numInputs, vector<float>(windowSize/2 + 1))
+, mImag(numInputs, vector<float>(windowSize/2 + 1))
+{
+   assert(hopSize > 0 && hopSize <= windowSize);
+   
+   for (int i=0; i<windowSize; ++i)
+      mAnalysisWindow[i] = -.5f*cos(FTWO_PI*i/windowSize)+.5f;
+   
+   //divide out however much the analysis*synthesis windows pile up at each point, and the fft's factor of windowSize
+   for (int i=0; i<windowSize; ++i)
+   {
+      float overlap = 0;
+      for (int j = i % hopSize; j<windowSize; j += hopSize)
+         overlap += mAnalysisWindow[j] * mAnalysisWindow[j];
+      mSynthesisWindow[i] = overlap > .0001f ? mAnalysisWindow[i] / (overlap * windowSize) : 0;
+   }
+   
+   Reset();
+}
+
+void STFT::Reset()
+{
+   for (auto& history : mInputHistory)
+      std::fill(history.begin(), history.end(), 0);
+   std::fill(mOutput.begin(), mOutput.end(), 0);
+   mHistoryPos = 0;
+   mOutputPos = 0;
+   mSamplesUntilFrame = mHopSize;
+}
+
+void STFT::Process(const float* const* inputs, float* output, int bufferSize)
+{
+   int done = 0;
+   while (done < bufferSize)
+   {
+      int numSamples = MIN(bufferSize - done, mSamplesUntilFrame);
+      
+      int firstPart = MIN(numSamples, mWindowSize - mHistoryPos);
+      for (int input=0; input<mNumInputs; ++input)
+      {
+         float* history = mInputHistory[input].data();
+         BufferCopy(history + mHistoryPos, inputs[input] + done, firstPart);
+         BufferCopy(history, inputs[input] + done + firstPart, numSamples - firstPart);
+      }
+      mHistoryPos = (mHistoryPos + numSamples) % mWindowSize;
+      
+      if (output != nullptr)
+      {
+         firstPart = MIN(numSamples, mWindowSize - mOutputPos);
+         BufferCopy(output + done, &mOutput[mOutputPos], firstPart);
+         Clear(&mOutput[mOutputPos], firstPart);
+         BufferCopy(output + done + firstPart, &mOutput[0], numSamples - firstPart);
+         Clear(&mOutput[0], numSamples - firstPart);
+         mOutputPos = (mOutputPos + numSamples) % mWindowSize;
+      }
+      
+      done += numSamples;
+      mSamplesUntilFrame -= numSamples;
+      if (mSamplesUntilFrame == 0)
+      {
+         RunFrame(done, output != nullptr);
+         mSamplesUntilFrame = mHopSize;
+      }
+   }
+}
+
+void STFT::RunFrame(int offset, bool resynthesize)
+{
+   //the oldest sample in the history is where the next one gets written
+   int firstPart = mWindowSize - mHistoryPos;
+   for (int input=0; input<mNumInputs; ++input)
+   {
+      const float* history = mInputHistory[input].data();
+      BufferCopy(mTimeDomain.data(), history + mHistoryPos, firstPart);
+      BufferCopy(mTimeDomain.data() + firstPart, history, mHistoryPos);
+      Mult(mTimeDomain.data(), mAnalysisWindow.data(), mWindowSize);
+      mFFT.Forward(mTimeDomain.data(), mReal[input].data(), mImag[input].data());
+   }
+   
+   if (mListener)
+      mListener->ProcessFrame(this, offset);
+   
+   if (!resynthesize)
+      return;
+   
+   mFFT.Inverse(mReal[0].data(), mImag[0].data(), mTimeDomain.data());
+   Mult(mTimeDomain.data(), mSynthesisWindow.data(), mWindowSize);
+   
+   firstPart = mWindowSize - mOutputPos;
+   Add(&mOutput[mOutputPos], mTimeDomain.data(), firstPart);
+   Add(&mOutput[0], mTimeDomain.data() + firstPart, mOutputPos);
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    STFT.h
+    Created: 17 Oct 2026 11:02:17pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SynthGlobals.h"
+#include "FFT.h"
+
+class STFT;
+
+class ISTFTListener
+{
+public:
+   virtual ~ISTFTListener() {}
+   //called once per hop with every input's spectrum. whatever is left in input 0's spectrum gets resynthesized.
+   //offset is how far into the current block the frame landed
+   virtual void ProcessFrame(STFT* stft, int offset) = 0;
+};
+
+//short-time fourier transform with overlap-add resynthesis.
+//frames are taken every hopSize samples no matter how the audio arrives, so the cost follows the hop rather than
+//the buffer size. inputs are analyzed in lockstep, for things like a vocoder's carrier.
+//the synthesis window is normalized against the analysis window at this hop, so an untouched spectrum comes back
+//out at unity gain, windowSize samples late
+class STFT
+{
+public:
+   STFT(int windowSize, int hopSize, int numInputs = 1);
+   
+   void SetListener(ISTFTListener* listener) { mListener = listener; }
+   void Process(const float* const* inputs, float* output, int bufferSize);   //output can be null to only analyze
+   void Reset();
+   
+   float* GetReal(int input) { return mReal[input].data(); }
+   float* GetImag(int input) { return mImag[input].data(); }
+   int GetNumBins() const { return mWindowSize/2 + 1; }
+   int GetWindowSize() const { return mWindowSize; }
+   int GetHopSize() const { return mHopSize; }
+   int GetLatency() const { return mWindowSize; }
+   
+private:
+   void RunFrame(int offset, bool resynthesize);
+   
+   int mWindowSize;
+   int mHopSize;
+   int mNumInputs;
+   ISTFTListener* mListener;
+   ::FFT mFFT;
+   vector<float> mAnalysisWindow;
+   vector<float> mSynthesisWindow;
+   vector< vector<float> > mInputHistory;   //circular, one per input
+   int mHistoryPos;
+   vector<float> mOutput;   //circular overlap-add accumulator
+   int mOutputPos;
+   int mSamplesUntilFrame;
+   vector<float> mTimeDomain;
+   vector< vector<float> > mReal;
+   vector< vector<float> > mImag;
+};
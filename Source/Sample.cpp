@@ -11,6 +11,7 @@
 #include "FileStream.h"
 #include "ModularSynth.h"
 #include "ChannelBuffer.h"
+#include "SampleStream.h"
 
 Sample::Sample()
 : mData(0)
@@ -21,61 +22,157 @@ Sample::Sample()
 , mLooping(false)
 , mNumBars(-1)
 , mVolume(1)
+, mStream(nullptr)
+, mStreamLoopStart(0)
 {
    mName[0] = 0;
 }
 
 Sample::~Sample()
 {
+   delete mStream;
 }
 
-bool Sample::Read(const char* path, bool mono)
+void Sample::SetReadPath(const char* path)
 {
    StringCopy(mReadPath,path,MAX_SAMPLE_READ_PATH_LENGTH);
    vector<string> tokens = ofSplitString(path,"/");
    StringCopy(mName,tokens[tokens.size()-1].c_str(),32);
    mName[strlen(mName)-4] = 0;
+}
+
+bool Sample::Read(const char* path, bool mono)
+{
+   SetReadPath(path);
+   
+   SampleCache::EntryPtr entry = TheSampleCache->Load(path, mono);
+   entry->WaitUntilReady();
+   if (entry->Failed())
+      return false;
    
+   ClearStream();
+   SetCacheEntry(entry);
+   Reset();
+   return true;
+}
+
+void Sample::ReadAsync(const char* path, bool mono)
+{
+   SetReadPath(path);
+   ClearStream();
+   SetCacheEntry(TheSampleCache->Load(path, mono));
+   mOffset = FLT_MAX;
+}
+
+void Sample::SetCacheEntry(SampleCache::EntryPtr entry)
+{
+   SampleCache::EntryPtr oldEntry = mCacheEntry;  //released once we're out of the lock
+   LockDataMutex(true);
+   mCacheEntry = entry;
+   if (entry != nullptr)
+   {
+      mData.Resize(0);
+      mNumSamples = 0;  //mNumSamples only describes mData, the entry has its own length
+   }
+   LockDataMutex(false);
+}
+
+bool Sample::ReadStreaming(const char* path, bool mono, float minSeconds)
+{
    File file(ofToDataPath(path));
-   ScopedPointer<AudioFormatReader> reader(TheSynth->GetGlobalManagers()->mAudioFormatManager.createReaderFor(file));
+   AudioFormatReader* reader = TheSynth->GetGlobalManagers()->mAudioFormatManager.createReaderFor(file);
+   
+   if (reader == nullptr)
+      return false;
    
-   if (reader != nullptr)
+   if (reader->lengthInSamples < minSeconds * reader->sampleRate)
    {
-      mNumSamples = reader->lengthInSamples;
-      mSampleRateRatio = float(reader->sampleRate) / gSampleRate;
-      
-      mData.Resize(mNumSamples);
-      
-      AudioSampleBuffer fileBuffer;
-      fileBuffer.setSize (reader->numChannels, mNumSamples);
-      reader->read(&fileBuffer, 0, mNumSamples, 0, true, true);
-      
-      if (mono)
-         mData.SetNumActiveChannels(1);
-      else
-         mData.SetNumActiveChannels(reader->numChannels);
-      
-      for (int i=0; i<reader->lengthInSamples; ++i)
-      {
-         if (mono)
-         {
-            mData.GetChannel(0)[i] = fileBuffer.getSample(0, i); //put first channel in
-            for (int ch=1; ch<reader->numChannels; ++ch)
-               mData.GetChannel(0)[i] += fileBuffer.getSample(ch, i); //add the other channels
-            mData.GetChannel(0)[i] /= reader->numChannels;   //normalize volume
-         }
-         else
-         {
-            for (int ch=0; ch<reader->numChannels; ++ch)
-               mData.GetChannel(ch)[i] = fileBuffer.getSample(ch, i);
-         }
-      }
-      
-      Reset();
-      return true;
+      delete reader;
+      return Read(path, mono);
    }
    
-   return false;
+   SetReadPath(path);
+   SetCacheEntry(nullptr);
+   SampleStream* stream = new SampleStream(reader, mono);
+   stream->SetLooping(mLooping);
+   
+   mPlayMutex.lock();
+   SampleStream* oldStream = mStream;
+   mStream = stream;
+   mStreamLoopStart = 0;
+   mNumSamples = stream->LengthInSamples();
+   mSampleRateRatio = float(stream->GetSampleRate()) / gSampleRate;
+   Reset();
+   mPlayMutex.unlock();
+   
+   delete oldStream;
+   LockDataMutex(true);
+   mData.Resize(0);
+   LockDataMutex(false);
+   return true;
+}
+
+void Sample::ClearStream()
+{
+   mPlayMutex.lock();
+   SampleStream* stream = mStream;
+   mStream = nullptr;
+   mStreamLoopStart = 0;
+   mPlayMutex.unlock();
+   
+   delete stream;
+}
+
+int Sample::LengthInSamples() const
+{
+   if (mCacheEntry != nullptr)
+      return mCacheEntry->LengthInSamples();
+   return mNumSamples;
+}
+
+int Sample::NumChannels() const
+{
+   if (mStream != nullptr)
+      return mStream->NumChannels();
+   if (mCacheEntry != nullptr)
+      return mCacheEntry->NumChannels();
+   return mData.NumActiveChannels();
+}
+
+ChannelBuffer* Sample::Data()
+{
+   if (mCacheEntry != nullptr && mCacheEntry->GetData() != nullptr)
+      return mCacheEntry->GetData();
+   return &mData;
+}
+
+const PeakCache* Sample::GetPeaks()
+{
+   if (mCacheEntry != nullptr && mCacheEntry->GetData() != nullptr)
+      return mCacheEntry->GetPeaks();
+   mPeaks.Update(&mData, mNumSamples);
+   return &mPeaks;
+}
+
+float Sample::GetSampleRateRatio() const
+{
+   if (mCacheEntry != nullptr)
+      return float(mCacheEntry->GetSampleRate()) / gSampleRate;
+   return mSampleRateRatio;
+}
+
+int Sample::GetNumStreamUnderruns() const
+{
+   if (mStream != nullptr)
+      return mStream->GetNumUnderruns();
+   return 0;
+}
+
+void Sample::SetLooping(bool looping)
+{
+   mLooping = looping;
+   if (mStream != nullptr)
+      mStream->SetLooping(looping);
 }
 
 void Sample::Create(int length)
@@ -99,18 +196,24 @@ void Sample::Create(ChannelBuffer* data)
 void Sample::Setup(int length)
 {
    mNumSamples = length;
+   mPeaks.Invalidate();
    mRate = 1;
    mOffset = length;
    mSampleRateRatio = 1;
    mStopPoint = -1;
    strcpy(mName, "newsample");
    mReadPath[0] = 0;
+   ClearStream();
+   SetCacheEntry(nullptr);
 }
 
 bool Sample::Write(const char* path /*=nullptr*/)
 {
+   if (mStream != nullptr)
+      return false;  //nothing in memory to write
+   
    const char* writeTo = path ? path : mReadPath;
-   WriteDataToFile(writeTo, &mData, mNumSamples);
+   WriteDataToFile(writeTo, Data(), LengthInSamples());
    return true;
 }
 
@@ -158,29 +261,45 @@ bool Sample::ConsumeData(ChannelBuffer* out, int size, bool replace)
    assert(size <= out->BufferSize());
    
    mPlayMutex.lock();
-   float end = mNumSamples;
+   LockDataMutex(true);
+   
+   int length = LengthInSamples();
+   float end = length;
    if (mStopPoint != -1)
       end = mStopPoint;
    
-   if (mLooping && mOffset >= mNumSamples)
-      mOffset -= mNumSamples;
+   if (mLooping && mOffset >= length)
+   {
+      mOffset -= length;
+      mStreamLoopStart += length;
+   }
    
    if (mOffset >= end || mOffset != mOffset)
    {
+      LockDataMutex(false);
       mPlayMutex.unlock();
       return false;
    }
    
-   LockDataMutex(true);
+   if (mStream != nullptr)
+   {
+      ConsumeStreamData(out, size, replace, end);
+      LockDataMutex(false);
+      mPlayMutex.unlock();
+      return true;
+   }
+   
+   ChannelBuffer* data = Data();
+   float sampleRateRatio = GetSampleRateRatio();
    for (int i=0; i<size; ++i)
    {
       for (int ch=0; ch<out->NumActiveChannels(); ++ch)
       {
-         int dataChannel = MIN(ch, mData.NumActiveChannels()-1);
+         int dataChannel = MIN(ch, data->NumActiveChannels()-1);
          
          float sample = 0;
          if (mOffset < end || mLooping)
-            sample = GetInterpolatedSample(mOffset, mData.GetChannel(dataChannel), mNumSamples) * mVolume;
+            sample = GetInterpolatedSample(mOffset, data->GetChannel(dataChannel), length) * mVolume;
          
          if (replace)
             out->GetChannel(ch)[i] = sample;
@@ -188,7 +307,7 @@ bool Sample::ConsumeData(ChannelBuffer* out, int size, bool replace)
             out->GetChannel(ch)[i] += sample;
       }
       
-      mOffset += mRate * mSampleRateRatio;
+      mOffset += mRate * sampleRateRatio;
    }
    LockDataMutex(false);
    mPlayMutex.unlock();
@@ -196,6 +315,42 @@ bool Sample::ConsumeData(ChannelBuffer* out, int size, bool replace)
    return true;
 }
 
+void Sample::ConsumeStreamData(ChannelBuffer* out, int size, bool replace, float end)
+{
+   double step = mRate * mSampleRateRatio;
+   double first = mStreamLoopStart + mOffset;
+   double last = first + step * (size - 1);
+   int64 firstFrame = MAX((int64)floor(MIN(first, last)), int64(0));
+   int64 lastFrame = MAX((int64)floor(MAX(first, last)) + 1, int64(0));
+   
+   if (!mStream->BeginRead(firstFrame, lastFrame, step < 0))
+   {
+      //hold our position until the streamer catches up
+      if (replace)
+         out->Clear();
+      return;
+   }
+   
+   for (int i=0; i<size; ++i)
+   {
+      for (int ch=0; ch<out->NumActiveChannels(); ++ch)
+      {
+         int dataChannel = MIN(ch, mStream->NumChannels()-1);
+         
+         float sample = 0;
+         if (mOffset < end || mLooping)
+            sample = mStream->GetInterpolatedSample(dataChannel, mStreamLoopStart + mOffset) * mVolume;
+         
+         if (replace)
+            out->GetChannel(ch)[i] = sample;
+         else
+            out->GetChannel(ch)[i] += sample;
+      }
+      
+      mOffset += step;
+   }
+}
+
 void Sample::PadBack(int amount)
 {
    //TODO(Ryan)
@@ -241,8 +396,21 @@ void Sample::ShiftWrap(int numSamplesToShift)
 
 void Sample::CopyFrom(Sample* sample)
 {
+   if (sample->IsStreaming())
+      ReadStreaming(sample->mReadPath, sample->NumChannels() == 1);
+   else
+      ClearStream();
+   SetCacheEntry(sample->mCacheEntry);  //decoded files are shared rather than copied
+   
    mNumSamples = sample->mNumSamples;
-   mData.CopyFrom(&sample->mData);
+   if (sample->mCacheEntry == nullptr && !sample->IsStreaming())
+   {
+      LockDataMutex(true);
+      mData.Resize(sample->mData.BufferSize());
+      mData.CopyFrom(&sample->mData);
+      LockDataMutex(false);
+      mPeaks.Invalidate();
+   }
    mNumBars = sample->mNumBars;
    mLooping = sample->mLooping;
    mRate = sample->mRate;
@@ -254,20 +422,31 @@ void Sample::CopyFrom(Sample* sample)
 
 namespace
 {
-   const int kSaveStateRev = 0;
+   const int kSaveStateRev = 3;
 }
 
 void Sample::SaveState(FileStreamOut& out)
 {
    out << kSaveStateRev;
    
-   out << mNumSamples;
-   if (mNumSamples > 0)
-      mData.Save(out, mNumSamples);
+   //streamed samples are saved as a reference to their file, and so are files that haven't finished decoding yet,
+   //rather than holding up the save until they have
+   bool streaming = IsStreaming();
+   bool loading = IsLoading();
+   out << streaming;
+   if (streaming)
+      out << (NumChannels() == 1);  //whether the file was opened as mono
+   else
+      out << (loading && mCacheEntry->IsMono());
+   out << loading;
+   int savedLength = (streaming || loading) ? 0 : LengthInSamples();
+   out << savedLength;
+   if (savedLength > 0)
+      Data()->Save(out, savedLength);
    out << mNumBars;
    out << mLooping;
    out << mRate;
-   out << mSampleRateRatio;
+   out << GetSampleRateRatio();
    out << mStopPoint;
    out << string(mName);
    out << string(mReadPath);
@@ -278,12 +457,25 @@ void Sample::LoadState(FileStreamIn& in)
    int rev;
    in >> rev;
    
+   bool streaming = false;
+   if (rev >= 1)
+      in >> streaming;
+   bool mono = false;
+   if (rev >= 2)
+      in >> mono;
+   bool loading = false;
+   if (rev >= 3)
+      in >> loading;
+   
+   ClearStream();
+   SetCacheEntry(nullptr);
    in >> mNumSamples;
    if (mNumSamples > 0)
    {
       int readLength;
       mData.Load(in, readLength);
       assert(readLength == mNumSamples);
+      mPeaks.Invalidate();
    }
    in >> mNumBars;
    in >> mLooping;
@@ -296,4 +488,9 @@ void Sample::LoadState(FileStreamIn& in)
    string readPath;
    in >> readPath;
    StringCopy(mReadPath, readPath.c_str(), MAX_SAMPLE_READ_PATH_LENGTH);
+   
+   if (streaming && !ReadStreaming(mReadPath, mono))
+      ofLog() << "couldn't open " << mReadPath << " for streaming";
+   if (loading)
+      ReadAsync(readPath.c_str(), mono);
 }
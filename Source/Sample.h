@@ -11,9 +11,11 @@
 
 #include "OpenFrameworksPort.h"
 #include "ChannelBuffer.h"
+#include "SampleCache.h"
 
 class FileStreamOut;
 class FileStreamIn;
+class SampleStream;
 
 #define MAX_SAMPLE_READ_PATH_LENGTH 1024
 
@@ -23,18 +25,24 @@ public:
    Sample();
    ~Sample();
    bool Read(const char* path, bool mono = false);
+   void ReadAsync(const char* path, bool mono = false);  //returns right away, the sample is empty until it finishes decoding
+   bool ReadStreaming(const char* path, bool mono = false, float minSeconds = 0);  //plays from disk instead of loading, if the file is at least minSeconds long
    bool Write(const char* path = nullptr);   //no path = use read filename
    bool ConsumeData(ChannelBuffer* out, int size, bool replace);
    void Play(float rate = 1, int offset=0, int stopPoint=-1);
    void SetRate(float rate) { mRate = rate; }
    const char* Name() { return mName; }
-   int LengthInSamples() const { return mNumSamples; }
-   int NumChannels() const { return mData.NumActiveChannels(); }
-   ChannelBuffer* Data() { return &mData; }
+   int LengthInSamples() const;
+   int NumChannels() const;
+   ChannelBuffer* Data();  //empty when streaming. shared with other samples if it came from a file, so don't write to it
+   const PeakCache* GetPeaks();  //for drawing
+   bool IsLoading() const { return mCacheEntry != nullptr && !mCacheEntry->IsReady(); }
+   bool IsStreaming() const { return mStream != nullptr; }
+   int GetNumStreamUnderruns() const;
    int GetPlayPosition() const { return mOffset; }
    void SetPlayPosition(int sample) { mOffset = sample; }
-   float GetSampleRateRatio() const { return mSampleRateRatio; }
-   void Reset() { mOffset = mNumSamples; }
+   float GetSampleRateRatio() const;
+   void Reset() { mOffset = LengthInSamples(); }
    void SetStopPoint(int stopPoint) { mStopPoint = stopPoint; }
    void ClearStopPoint() { mStopPoint = -1; }
    void PadBack(int amount);
@@ -43,11 +51,11 @@ public:
    const char* GetReadPath() const { return mReadPath; }
    static bool WriteDataToFile(const char* path, float** data, int numSamples, int channels = 1);
    static bool WriteDataToFile(const char* path, ChannelBuffer* data, int numSamples);
-   bool IsPlaying() { return mOffset < mNumSamples; }
+   bool IsPlaying() { return mOffset < LengthInSamples(); }
    void LockDataMutex(bool lock) { lock ? mDataMutex.lock() : mDataMutex.unlock(); }
    void Create(int length);
    void Create(ChannelBuffer* data);
-   void SetLooping(bool looping) { mLooping = looping; }
+   void SetLooping(bool looping);
    void SetNumBars(int numBars) { mNumBars = numBars; }
    int GetNumBars() const { return mNumBars; }
    void SetVolume(float vol) { mVolume = vol; }
@@ -57,8 +65,14 @@ public:
    void LoadState(FileStreamIn& in);
 private:
    void Setup(int length);
+   void SetReadPath(const char* path);
+   void ClearStream();
+   void SetCacheEntry(SampleCache::EntryPtr entry);
+   void ConsumeStreamData(ChannelBuffer* out, int size, bool replace, float end);
    
    ChannelBuffer mData;
+   PeakCache mPeaks;
+   SampleCache::EntryPtr mCacheEntry;  //decoded file data, used instead of mData when set
    int mNumSamples;
    double mOffset;
    float mRate;
@@ -71,6 +85,8 @@ private:
    bool mLooping;
    int mNumBars;
    float mVolume;
+   SampleStream* mStream;
+   int64 mStreamLoopStart;   //stream position of the start of the current loop
 };
 
 #endif /* defined(__modularSynth__Sample__) */
@@ -41,7 +41,7 @@ void SampleBank::DrawModule()
    {
       ofPushMatrix();
       ofTranslate(5, 22);
-      DrawAudioBuffer(190, 55, mSamples[mSampleIdx].mSample->Data(), 0, mSamples[mSampleIdx].mSample->LengthInSamples(), -1);
+      DrawAudioBuffer(190, 55, mSamples[mSampleIdx].mSample->GetPeaks(), 0, mSamples[mSampleIdx].mSample->LengthInSamples(), -1);
       ofPopMatrix();
    }
 }
@@ -54,7 +54,11 @@ void SampleBank::OnClicked(int x, int y, bool right)
    {
       if (mSampleIdx >= 0 && mSampleIdx < mSamples.size())
       {
-         TheSynth->GrabSample(mSamples[mSampleIdx].mSample->Data(), false, mSamples[mSampleIdx].mSample->GetNumBars());
+         Sample* sample = mSamples[mSampleIdx].mSample;
+         if (sample->IsLoading())
+            ofLog() << sample->Name() << " is still loading";   //Data() would just be an empty buffer until it's decoded
+         else
+            TheSynth->GrabSample(sample->Data(), false, sample->GetNumBars());
       }
    }
 }
@@ -92,7 +96,7 @@ void SampleBank::LoadList(const char* filename)
             string type = tokens[4];
 
             Sample* sample = new Sample();
-            sample->Read(wavFile.c_str());
+            sample->ReadAsync(wavFile.c_str());
 
             SampleInfo info;
             info.mSample = sample;
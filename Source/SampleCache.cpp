@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    SampleCache.cpp
+    Created: 17 Oct 2026 5:02:48pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "SampleCache.h"
+#include "SynthGlobals.h"
+#include "ModularSynth.h"
+#include "SampleStream.h"
+
+SampleCache* TheSampleCache = nullptr;
+
+SampleCache::Entry::Entry(const File& file, int64 modificationTime, bool mono, AudioFormatManager* formatManager)
+: mFile(file)
+, mModificationTime(modificationTime)
+, mMono(mono)
+, mFormatManager(formatManager)
+, mSampleRate(gSampleRate)
+, mReady(false)
+, mReadyEvent(true)
+, mLastUsed(0)
+{
+}
+
+size_t SampleCache::Entry::GetMemorySize() const
+{
+   if (GetData() == nullptr)
+      return 0;
+   return size_t(mData->BufferSize()) * mData->NumActiveChannels() * sizeof(float);
+}
+
+void SampleCache::Entry::WaitUntilReady() const
+{
+   if (!IsReady())
+      mReadyEvent.wait();
+}
+
+void SampleCache::Entry::Decode()
+{
+   ScopedPointer<AudioFormatReader> reader(mFormatManager->createReaderFor(mFile));
+
+   if (reader != nullptr)
+   {
+      int length = (int)reader->lengthInSamples;
+      int fileChannels = MIN((int)reader->numChannels, int(ChannelBuffer::kMaxNumChannels));
+      mSampleRate = reader->sampleRate;   //published along with mData by mReady
+
+      ChannelBuffer* data = new ChannelBuffer(length);
+      data->SetNumActiveChannels(mMono ? 1 : fileChannels);
+
+      //decode a chunk at a time straight into the buffer, rather than holding a second copy of the whole file
+      const int kReadChunk = 65536;
+      AudioSampleBuffer readBuffer(fileChannels, MIN(kReadChunk, length));
+      for (int pos=0; pos<length; pos += kReadChunk)
+      {
+         int numFrames = MIN(kReadChunk, length - pos);
+         reader->read(&readBuffer, 0, numFrames, pos, true, true);
+         SampleStream::CopyFrames(readBuffer, numFrames, data, pos);
+      }
+
+      mPeaks.Update(data, length);
+      mData = data;
+   }
+
+   mReady.store(true, std::memory_order_release);
+   mReadyEvent.signal();
+}
+
+SampleCache::SampleCache()
+: mUseCounter(0)
+, mDecodePool(kNumWorkers)
+{
+}
+
+SampleCache::~SampleCache()
+{
+   mDecodePool.removeAllJobs(true, 5000);
+}
+
+SampleCache::EntryPtr SampleCache::Load(const char* path, bool mono)
+{
+   File file(ofToDataPath(path));
+   int64 modificationTime = file.getLastModificationTime().toMilliseconds();
+   string key = file.getFullPathName().toStdString() + (mono ? "|mono" : "");
+
+   ScopedLock lock(mEntriesMutex);
+
+   auto iter = mEntries.find(key);
+   if (iter != mEntries.end() && iter->second->GetModificationTime() == modificationTime)
+   {
+      iter->second->mLastUsed = ++mUseCounter;
+      return iter->second;
+   }
+
+   //anything still holding the old version of a changed file keeps it until they let go
+   EntryPtr entry = new Entry(file, modificationTime, mono, &TheSynth->GetGlobalManagers()->mAudioFormatManager);
+   entry->mLastUsed = ++mUseCounter;
+   mEntries[key] = entry;
+   mDecodePool.addJob(new DecodeJob(this, entry), true);
+
+   return entry;
+}
+
+void SampleCache::Purge()
+{
+   ScopedLock lock(mEntriesMutex);
+   
+   size_t totalSize = 0;
+   vector<std::map<string, EntryPtr>::iterator> unused;
+   for (auto iter = mEntries.begin(); iter != mEntries.end(); ++iter)
+   {
+      totalSize += iter->second->GetMemorySize();
+      if (iter->second->getReferenceCount() == 1 && iter->second->IsReady())
+         unused.push_back(iter);
+   }
+   
+   if (totalSize <= kMemoryBudget)
+      return;
+   
+   std::sort(unused.begin(), unused.end(), [](const std::map<string, EntryPtr>::iterator& a, const std::map<string, EntryPtr>::iterator& b)
+             { return a->second->mLastUsed < b->second->mLastUsed; });
+   for (auto& iter : unused)
+   {
+      if (totalSize <= kMemoryBudget)
+         break;
+      totalSize -= iter->second->GetMemorySize();
+      mEntries.erase(iter);
+   }
+}
+
+void SampleCache::WaitForPendingLoads()
+{
+   vector<EntryPtr> pending;
+   {
+      ScopedLock lock(mEntriesMutex);
+      for (auto& entry : mEntries)
+      {
+         if (!entry.second->IsReady())
+            pending.push_back(entry.second);
+      }
+   }
+   
+   for (auto& entry : pending)
+      entry->WaitUntilReady();
+}
+
+int SampleCache::GetNumEntries()
+{
+   ScopedLock lock(mEntriesMutex);
+   return (int)mEntries.size();
+}
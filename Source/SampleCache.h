@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    SampleCache.h
+    Created: 17 Oct 2026 5:02:48pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include "ChannelBuffer.h"
+#include "PeakCache.h"
+#include <atomic>
+#include <map>
+
+//decodes sound files on a pool of worker threads, and shares the decoded audio between everything that loads the same file.
+//files are keyed by path and modification time, so a file that changed on disk gets decoded again.
+//files nothing is using anymore stay around until the cache goes over its memory budget, and then the least recently
+//loaded ones go first
+class SampleCache
+{
+public:
+   //decoded audio for one file. never changes once it's ready, so it's safe to read from any thread
+   class Entry : public ReferenceCountedObject
+   {
+   public:
+      Entry(const File& file, int64 modificationTime, bool mono, AudioFormatManager* formatManager);
+
+      bool IsReady() const { return mReady.load(std::memory_order_acquire); }
+      void WaitUntilReady() const;
+      bool Failed() const { return IsReady() && mData == nullptr; }
+      ChannelBuffer* GetData() const { return IsReady() ? mData.get() : nullptr; }
+      int LengthInSamples() const { return GetData() != nullptr ? mData->BufferSize() : 0; }
+      int NumChannels() const { return GetData() != nullptr ? mData->NumActiveChannels() : 1; }
+      const PeakCache* GetPeaks() const { return IsReady() ? &mPeaks : nullptr; }
+      double GetSampleRate() const { return IsReady() ? mSampleRate : gSampleRate; }
+      int64 GetModificationTime() const { return mModificationTime; }
+      bool IsMono() const { return mMono; }
+      size_t GetMemorySize() const;
+
+   private:
+      friend class SampleCache;
+      void Decode();
+
+      File mFile;
+      int64 mModificationTime;
+      bool mMono;
+      AudioFormatManager* mFormatManager;
+      ScopedPointer<ChannelBuffer> mData;
+      PeakCache mPeaks;
+      double mSampleRate;
+      std::atomic<bool> mReady;
+      mutable WaitableEvent mReadyEvent;
+      uint64 mLastUsed;  //guarded by mEntriesMutex
+   };
+   typedef ReferenceCountedObjectPtr<Entry> EntryPtr;
+
+   SampleCache();
+   ~SampleCache();
+
+   EntryPtr Load(const char* path, bool mono);  //returns right away, the entry becomes ready once a worker has decoded it
+   void Purge();  //drops entries that nothing is holding on to, oldest first, until the cache fits in its budget
+   void WaitForPendingLoads();   //blocks until every file asked for so far has been decoded
+   int GetNumEntries();
+
+   static const int kNumWorkers = 2;
+   static const size_t kMemoryBudget = size_t(512) * 1024 * 1024;
+
+private:
+   class DecodeJob : public ThreadPoolJob
+   {
+   public:
+      DecodeJob(SampleCache* cache, Entry* entry) : ThreadPoolJob("decode sample"), mCache(cache), mEntry(entry) {}
+      JobStatus runJob() override { mEntry->Decode(); mCache->Purge(); return jobHasFinished; }
+   private:
+      SampleCache* mCache;
+      EntryPtr mEntry;
+   };
+
+   CriticalSection mEntriesMutex;
+   std::map<string, EntryPtr> mEntries;
+   uint64 mUseCounter;
+   ThreadPool mDecodePool;
+};
+
+extern SampleCache* TheSampleCache;
@@ -15,7 +15,7 @@ void SampleDrawer::Draw(int playPosition, float vol, ofColor color)
    ofPushMatrix();
    ofTranslate(mX,mY);
    mSample->LockDataMutex(true);
-   DrawAudioBuffer(mWidth, mHeight, mSample->Data(), mStartSample, mEndSample, playPosition, vol, color);
+   DrawAudioBuffer(mWidth, mHeight, mSample->GetPeaks(), mStartSample, mEndSample, playPosition, vol, color);
    mSample->LockDataMutex(false);
    ofPopMatrix();
 }
@@ -19,6 +19,11 @@
 #include "PatchCableSource.h"
 #include "Scale.h"
 
+namespace
+{
+   const float kStreamLongerThanSeconds = 60;   //anything shorter is cheap enough to just load
+}
+
 SamplePlayer::SamplePlayer()
 : mVolume(1)
 , mVolumeSlider(nullptr)
@@ -183,7 +188,7 @@ void SamplePlayer::DropdownUpdated(DropdownList* list, int oldVal)
 void SamplePlayer::FilesDropped(vector<string> files, int x, int y)
 {
    Sample* sample = new Sample();
-   sample->Read(files[0].c_str());
+   sample->ReadStreaming(files[0].c_str(), false, kStreamLongerThanSeconds);
    UpdateSample(sample, true);
 }
 
@@ -200,10 +205,17 @@ void SamplePlayer::UpdateSample(Sample* sample, bool ownsSample)
    mPlay = false;
    mOwnsSample = ownsSample;
    
+   UpdateDrawBuffer();
+}
+
+void SamplePlayer::UpdateDrawBuffer()
+{
    mSample->LockDataMutex(true);
-   mDrawBuffer.Resize(mSample->LengthInSamples());
+   mDrawBuffer.Resize(mSample->Data()->BufferSize());
    mDrawBuffer.CopyFrom(mSample->Data());
    mSample->LockDataMutex(false);
+   mDrawPeaks.Invalidate();
+   mDrawPeaks.Update(&mDrawBuffer, mDrawBuffer.BufferSize());
 }
 
 void SamplePlayer::ButtonClicked(ClickButton *button)
@@ -233,7 +245,7 @@ void SamplePlayer::ButtonClicked(ClickButton *button)
       pclose(output);
       
       Sample* sample = new Sample();
-      sample->Read(ofToDataPath("youtube.wav").c_str());
+      sample->ReadStreaming(ofToDataPath("youtube.wav").c_str(), false, kStreamLongerThanSeconds);
       UpdateSample(sample, true);
    }
 }
@@ -289,9 +301,23 @@ void SamplePlayer::DrawModule()
 
    ofPushMatrix();
    ofTranslate(5,60);
-   if (mSample)
+   if (mSample && mSample->IsStreaming())
+   {
+      //no waveform in memory to draw, so just show where we are in the file
+      ofPushStyle();
+      ofFill();
+      ofSetColor(255,255,255,50);
+      ofRect(0, 0, mWidth-10, mHeight - 65);
+      ofSetColor(0,255,0);
+      float pos = ofMap(mSample->GetPlayPosition(), 0, mSample->LengthInSamples(), 0, mWidth-10, true);
+      ofLine(pos, 0, pos, mHeight - 65);
+      ofPopStyle();
+   }
+   else if (mSample)
    {
-      DrawAudioBuffer(mWidth-10, mHeight - 65, &mDrawBuffer, 0, mDrawBuffer.BufferSize(), mSample->GetPlayPosition());
+      if (mDrawBuffer.BufferSize() != mSample->Data()->BufferSize())
+         UpdateDrawBuffer();  //finished loading since we last looked
+      DrawAudioBuffer(mWidth-10, mHeight - 65, &mDrawPeaks, 0, mDrawBuffer.BufferSize(), mSample->GetPlayPosition());
    }
    else
    {
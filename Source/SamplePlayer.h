@@ -19,6 +19,7 @@
 #include "Slider.h"
 #include "DropdownList.h"
 #include "ClickButton.h"
+#include "PeakCache.h"
 
 class SampleBank;
 class Sample;
@@ -63,6 +64,7 @@ public:
    
 private:
    void UpdateSample(Sample* sample, bool ownsSample);
+   void UpdateDrawBuffer();
    void UpdateSampleList();
    float GetPlayPositionForMouse(float mouseX) const;
    
@@ -104,5 +106,6 @@ private:
    float mOscWheelSpeed;
    
    ChannelBuffer mDrawBuffer;
+   PeakCache mDrawPeaks;
 };
 
@@ -0,0 +1,346 @@
+/*
+  ==============================================================================
+
+    SampleStream.cpp
+    Created: 17 Oct 2026 3:41:27pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "SampleStream.h"
+#include "SynthGlobals.h"
+
+//one thread fills the rings of every open stream
+class SampleStreamer : public juce::Thread
+{
+public:
+   SampleStreamer() : juce::Thread("sample streamer"), mPrefetching(nullptr), mIdlePasses(0) {}
+
+   void run() override
+   {
+      vector<SampleStream*> streams;
+      while (!threadShouldExit())
+      {
+         {
+            ScopedLock lock(mStreamsMutex);
+            streams = mStreams;
+         }
+         
+         //the reads happen outside the lock, so opening and closing streams never waits on the disk.
+         //a stream being closed waits for us instead, if we're in the middle of filling it
+         bool didWork = false;
+         for (auto* stream : streams)
+         {
+            {
+               ScopedLock lock(mStreamsMutex);
+               if (!VectorContains(stream, mStreams))
+                  continue;
+               mPrefetching = stream;
+            }
+            if (stream->Prefetch())
+               didWork = true;
+            mPrefetching = nullptr;
+         }
+         if (!didWork)
+         {
+            ++mIdlePasses;
+            mIdle.signal();
+            mWake.wait(10);
+         }
+      }
+   }
+
+   void Wake() { mWake.signal(); }
+   
+   void WaitUntilDoneWith(SampleStream* stream)
+   {
+      while (mPrefetching.load() == stream)
+         Thread::sleep(1);
+   }
+   
+   void WaitUntilIdle()
+   {
+      //the next pass might have started before whatever we're waiting on was asked for, so wait for the one after it
+      int64 idlePasses = mIdlePasses.load() + 2;
+      while (mIdlePasses.load() < idlePasses && isThreadRunning())
+      {
+         Wake();
+         mIdle.wait(10);
+      }
+   }
+
+   CriticalSection mStreamsMutex;
+   vector<SampleStream*> mStreams;
+   std::atomic<SampleStream*> mPrefetching;
+
+private:
+   WaitableEvent mWake;
+   WaitableEvent mIdle;
+   std::atomic<int64> mIdlePasses;   //passes that found nothing to read
+};
+
+namespace
+{
+   //the streamer is started with the first stream and stopped with the last one
+   CriticalSection sStreamerLifetimeMutex;
+   SampleStreamer* sStreamer = nullptr;
+}
+
+SampleStream::SampleStream(AudioFormatReader* reader, bool mono)
+: mReader(reader)
+, mRing(kRingLength)
+, mLength((int)reader->lengthInSamples)
+, mSampleRate(reader->sampleRate)
+, mLooping(false)
+, mStreamer(nullptr)
+, mGeneration(0)
+, mReverse(false)
+, mBlockStart(0)
+, mBlockEnd(0)
+, mHasPlayed(false)
+, mNumUnderruns(0)
+, mReadPos(0)
+, mSeekTarget(0)
+, mSeekReverse(false)
+, mRequestedGeneration(0)
+, mServedGeneration(0)
+, mBufferedStart(0)
+, mBufferedEnd(0)
+, mFillReverse(false)
+, mFillStart(0)
+, mFillEnd(0)
+{
+   int fileChannels = MIN((int)reader->numChannels, int(ChannelBuffer::kMaxNumChannels));
+   mNumChannels = mono ? 1 : fileChannels;
+   mRing.SetNumActiveChannels(mNumChannels);
+   mReadBuffer.setSize(fileChannels, kPrefetchBlock);
+
+   //the ring starts out filling from the top of the file, so playback can start right away
+   ScopedLock lock(sStreamerLifetimeMutex);
+   if (sStreamer == nullptr)
+   {
+      sStreamer = new SampleStreamer();
+      sStreamer->startThread(7);
+   }
+   mStreamer = sStreamer;
+   {
+      ScopedLock streamsLock(mStreamer->mStreamsMutex);
+      mStreamer->mStreams.push_back(this);
+   }
+   mStreamer->Wake();
+}
+
+SampleStream::~SampleStream()
+{
+   ScopedLock lock(sStreamerLifetimeMutex);
+   bool lastStream;
+   {
+      ScopedLock streamsLock(mStreamer->mStreamsMutex);
+      RemoveFromVector(this, mStreamer->mStreams);
+      lastStream = mStreamer->mStreams.empty();
+   }
+   mStreamer->WaitUntilDoneWith(this);
+   if (lastStream)
+   {
+      sStreamer->stopThread(1000);
+      delete sStreamer;
+      sStreamer = nullptr;
+   }
+}
+
+//static
+void SampleStream::WaitForPrefetches()
+{
+   ScopedLock lock(sStreamerLifetimeMutex);
+   if (sStreamer != nullptr)
+      sStreamer->WaitUntilIdle();
+}
+
+bool SampleStream::BeginRead(int64 firstFrame, int64 lastFrame, bool reverse)
+{
+   if (lastFrame - firstFrame >= kRingLength - kKeepBehind - kPrefetchBlock)
+      return false;  //playing too fast to ever fit in the ring
+
+   int64 readPos = mReadPos.load(std::memory_order_relaxed);
+   bool outsideRing;
+   if (reverse)
+      outsideRing = lastFrame > readPos || firstFrame <= readPos - kRingLength;
+   else
+      outsideRing = firstFrame < readPos || lastFrame >= readPos + kRingLength;
+   if (reverse != mReverse || outsideRing)
+   {
+      //going backwards, keep a little above the playhead and fill downwards from there
+      if (reverse)
+         RequestSeek(lastFrame + kKeepBehind, true);
+      else
+         RequestSeek(MAX(firstFrame - kKeepBehind, 0), false);
+      return false;
+   }
+
+   if (mServedGeneration.load(std::memory_order_acquire) != mGeneration)
+      return false;  //still waiting on the streamer to pick up the seek
+
+   int64 bufferedStart = mBufferedStart.load(std::memory_order_acquire);
+   int64 bufferedEnd = mBufferedEnd.load(std::memory_order_acquire);
+   bool underrun;
+   if (reverse)
+      underrun = firstFrame < bufferedStart && bufferedStart > 0;
+   else
+      underrun = lastFrame >= bufferedEnd && (mLooping || bufferedEnd < mLength);
+   if (underrun)
+   {
+      if (mHasPlayed)
+         ++mNumUnderruns;
+      mStreamer->Wake();
+      return false;
+   }
+
+   mBlockStart = bufferedStart;
+   mBlockEnd = bufferedEnd;
+   mHasPlayed = true;
+
+   if (reverse)
+   {
+      int64 newReadPos = lastFrame + kKeepBehind;
+      if (newReadPos < readPos)
+      {
+         mReadPos.store(newReadPos, std::memory_order_release);
+         if (bufferedStart - (readPos - kRingLength) <= kPrefetchBlock &&
+             bufferedStart - (newReadPos - kRingLength) > kPrefetchBlock)
+            mStreamer->Wake();   //just made room for another block
+      }
+   }
+   else
+   {
+      int64 newReadPos = firstFrame - kKeepBehind;
+      if (newReadPos > readPos)
+      {
+         mReadPos.store(newReadPos, std::memory_order_release);
+         if (readPos + kRingLength - bufferedEnd < kPrefetchBlock &&
+             newReadPos + kRingLength - bufferedEnd >= kPrefetchBlock)
+            mStreamer->Wake();   //just made room for another block
+      }
+   }
+
+   return true;
+}
+
+void SampleStream::RequestSeek(int64 frame, bool reverse)
+{
+   ++mGeneration;
+   mReverse = reverse;
+   mHasPlayed = false;
+   mReadPos.store(frame, std::memory_order_relaxed);
+   mSeekTarget.store(frame, std::memory_order_relaxed);
+   mSeekReverse.store(reverse, std::memory_order_relaxed);
+   mRequestedGeneration.store(mGeneration, std::memory_order_release);
+   mStreamer->Wake();
+}
+
+float SampleStream::GetFrame(int channel, int64 frame)
+{
+   if (frame < mBlockStart || frame >= mBlockEnd || (frame >= mLength && !mLooping))
+      return 0;
+   return mRing.GetChannel(channel)[frame & (kRingLength-1)];
+}
+
+float SampleStream::GetInterpolatedSample(int channel, double position)
+{
+   int64 frame = (int64)floor(position);
+   float a = float(position - frame);
+   return (1-a) * GetFrame(channel, frame) + a * GetFrame(channel, frame+1);
+}
+
+bool SampleStream::Prefetch()
+{
+   int generation = mRequestedGeneration.load(std::memory_order_acquire);
+   if (generation != mServedGeneration.load(std::memory_order_relaxed))
+   {
+      mFillReverse = mSeekReverse.load(std::memory_order_relaxed);
+      int64 seekTarget = mSeekTarget.load(std::memory_order_relaxed);
+      if (mFillReverse)
+      {
+         seekTarget += 1;  //that frame is the top of what's kept, so it gets filled too
+         if (!mLooping)
+            seekTarget = MIN(seekTarget, int64(mLength));
+      }
+      mFillStart = seekTarget;
+      mFillEnd = seekTarget;
+      mBufferedStart.store(seekTarget, std::memory_order_release);
+      mBufferedEnd.store(seekTarget, std::memory_order_release);
+      mServedGeneration.store(generation, std::memory_order_release);
+   }
+
+   if (mLength == 0)
+      return false;
+
+   int64 fillPos;
+   int numFrames;
+   if (mFillReverse)
+   {
+      //anything written at or below mReadPos - kRingLength would land on top of a frame that's still needed
+      int64 room = mFillStart - (mReadPos.load(std::memory_order_acquire) - kRingLength + 1);
+      numFrames = (int)MIN(room, int64(kPrefetchBlock));
+      numFrames = (int)MIN(int64(numFrames), mFillStart);  //nothing before the start of the file
+      if (numFrames <= 0)
+         return false;
+      int fileEnd = int((mFillStart - 1) % mLength) + 1;
+      numFrames = MIN(numFrames, fileEnd);  //a loop wrap gets picked up by the next call
+      fillPos = mFillStart - numFrames;
+   }
+   else
+   {
+      int64 room = mReadPos.load(std::memory_order_acquire) + kRingLength - mFillEnd;
+      numFrames = (int)MIN(room, int64(kPrefetchBlock));
+      if (!mLooping)
+         numFrames = (int)MIN(int64(numFrames), mLength - mFillEnd);
+      fillPos = mFillEnd;
+      int fileFrame = int(fillPos % mLength);
+      numFrames = MIN(numFrames, mLength - fileFrame);  //a loop wrap gets picked up by the next call
+   }
+   if (numFrames <= 0)
+      return false;
+
+   mReader->read(&mReadBuffer, 0, numFrames, int(fillPos % mLength), true, true);
+
+   int ringPos = int(fillPos & (kRingLength-1));
+   int firstPart = MIN(numFrames, kRingLength - ringPos);
+   CopyFrames(mReadBuffer, firstPart, &mRing, ringPos);
+   if (firstPart < numFrames)
+   {
+      AudioSampleBuffer rest(mReadBuffer.getArrayOfWritePointers(), mReadBuffer.getNumChannels(), firstPart, numFrames - firstPart);
+      CopyFrames(rest, numFrames - firstPart, &mRing, 0);
+   }
+
+   if (mFillReverse)
+   {
+      mFillStart = fillPos;
+      mBufferedStart.store(mFillStart, std::memory_order_release);
+   }
+   else
+   {
+      mFillEnd += numFrames;
+      mBufferedEnd.store(mFillEnd, std::memory_order_release);
+   }
+   return true;
+}
+
+//static
+void SampleStream::CopyFrames(const AudioSampleBuffer& src, int numFrames, ChannelBuffer* dest, int destStart)
+{
+   int srcChannels = src.getNumChannels();
+   if (dest->NumActiveChannels() == 1 && srcChannels > 1)
+   {
+      float* out = dest->GetChannel(0) + destStart;
+      BufferCopy(out, src.getReadPointer(0), numFrames);
+      for (int ch=1; ch<srcChannels; ++ch)
+         Add(out, src.getReadPointer(ch), numFrames);
+      Mult(out, 1.0f / srcChannels, numFrames);
+   }
+   else
+   {
+      for (int ch=0; ch<dest->NumActiveChannels(); ++ch)
+         BufferCopy(dest->GetChannel(ch) + destStart, src.getReadPointer(MIN(ch, srcChannels-1)), numFrames);
+   }
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    SampleStream.h
+    Created: 17 Oct 2026 3:41:27pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include "ChannelBuffer.h"
+#include <atomic>
+
+class SampleStreamer;
+
+//plays a sound file straight off the disk. a shared background thread keeps a small ring of upcoming frames filled,
+//in whichever direction the file is playing, and the audio thread only ever reads out of that ring, so a file of any
+//length costs kRingLength frames of memory.
+//positions are frames that keep counting up across loop wraps, the frame in the file is position % length
+class SampleStream
+{
+public:
+   SampleStream(AudioFormatReader* reader, bool mono);  //takes ownership of the reader
+   ~SampleStream();
+
+   int NumChannels() const { return mNumChannels; }
+   int LengthInSamples() const { return mLength; }
+   double GetSampleRate() const { return mSampleRate; }
+   int GetNumUnderruns() const { return mNumUnderruns; }
+   void SetLooping(bool looping) { mLooping = looping; }
+
+   //audio thread. returns false if the frames aren't buffered yet, and asks the streamer for them
+   bool BeginRead(int64 firstFrame, int64 lastFrame, bool reverse);
+   float GetInterpolatedSample(int channel, double position);
+
+   //blocks until the streamer has caught up with every stream, for when nothing is waiting on the audio in real time
+   static void WaitForPrefetches();
+
+   //copies frames read out of a file into dest, mixing down if dest only has one channel
+   static void CopyFrames(const AudioSampleBuffer& src, int numFrames, ChannelBuffer* dest, int destStart);
+
+   static const int kRingLength = 32768;  //power of two
+   static const int kPrefetchBlock = 4096;
+   static const int kKeepBehind = 2048;   //frames kept behind the playhead, so small backwards scrubs don't need a reload
+
+private:
+   friend class SampleStreamer;
+   bool Prefetch();  //streamer thread, returns true if it read anything
+   void RequestSeek(int64 frame, bool reverse);
+   float GetFrame(int channel, int64 frame);
+
+   ScopedPointer<AudioFormatReader> mReader;
+   AudioSampleBuffer mReadBuffer;
+   ChannelBuffer mRing;
+   int mNumChannels;
+   int mLength;
+   double mSampleRate;
+   std::atomic<bool> mLooping;
+   SampleStreamer* mStreamer;
+
+   //audio thread
+   int mGeneration;
+   bool mReverse;  //which way the current seek fills
+   int64 mBlockStart;
+   int64 mBlockEnd;
+   bool mHasPlayed;  //whether this seek has started playing yet, so the initial fill isn't counted as an underrun
+   std::atomic<int> mNumUnderruns;
+
+   //playing forwards, the audio thread never reads below mReadPos, and the streamer fills upwards without overwriting it.
+   //backwards it's mirrored, mReadPos is the highest frame still needed and the streamer fills downwards.
+   //mReadPos only moves the way the file is playing, anything else goes through a seek. a seek bumps mRequestedGeneration,
+   //and the audio thread plays silence until the streamer has emptied the ring and matched it in mServedGeneration
+   std::atomic<int64> mReadPos;
+   std::atomic<int64> mSeekTarget;
+   std::atomic<bool> mSeekReverse;
+   std::atomic<int> mRequestedGeneration;
+   std::atomic<int> mServedGeneration;
+   std::atomic<int64> mBufferedStart;  //the ring holds the frames from mBufferedStart up to mBufferedEnd
+   std::atomic<int64> mBufferedEnd;
+
+   //streamer thread
+   bool mFillReverse;
+   int64 mFillStart;
+   int64 mFillEnd;
+};
@@ -12,15 +12,18 @@
 #include "Scale.h"
 #include "Profiler.h"
 #include "ChannelBuffer.h"
+#include "IDrawableModule.h"
 
 SampleVoice::SampleVoice(IDrawableModule* owner)
 : mPos(0)
 , mOwner(owner)
 {
+   mAdsrBuffer = new float[kWorkBufferSize];
 }
 
 SampleVoice::~SampleVoice()
 {
+   delete[] mAdsrBuffer;
 }
 
 bool SampleVoice::IsDone(double time)
@@ -37,13 +40,13 @@ bool SampleVoice::Process(double time, ChannelBuffer* out)
        mVoiceParams->mSampleLength == 0)
       return false;
    
-   float volSq = mVoiceParams->mVol * mVoiceParams->mVol;
+   SliderBlockValues vol(mOwner, &mVoiceParams->mVol);
+   
+   assert(out->BufferSize() <= kWorkBufferSize);
+   mAdsr.Render(time, mAdsrBuffer, out->BufferSize());
    
    for (int pos=0; pos<out->BufferSize(); ++pos)
    {
-      if (mOwner)
-         mOwner->ComputeSliders(pos);
-      
       if (mPos <= mVoiceParams->mSampleLength || mVoiceParams->mLoop)
       {
          float freq = TheScale->PitchToFreq(GetPitch(pos));
@@ -53,7 +56,7 @@ bool SampleVoice::Process(double time, ChannelBuffer* out)
          else
             speed = freq/TheScale->PitchToFreq(TheScale->ScaleRoot()+48);
          
-         float sample = GetInterpolatedSample(mPos, mVoiceParams->mSampleData, mVoiceParams->mSampleLength) * mAdsr.Value(time) * volSq;
+         float sample = GetInterpolatedSample(mPos, mVoiceParams->mSampleData, mVoiceParams->mSampleLength) * mAdsrBuffer[pos] * vol[pos] * vol[pos];
          
          if (out->NumActiveChannels() == 1)
          {
@@ -44,6 +44,7 @@ public:
    bool IsDone(double time) override;
 private:
    ADSR mAdsr;
+   float* mAdsrBuffer;
    SampleVoiceParams* mVoiceParams;
    float mPos;
    IDrawableModule* mOwner;
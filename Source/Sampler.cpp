@@ -83,7 +83,7 @@ void Sampler::Process(double time)
    if (!mEnabled || GetTarget() == nullptr)
       return;
    
-   ComputeSliders(0);
+   BeginSliderBlock(gBufferSize);
    SyncBuffers();
    
    int bufferSize = GetBuffer()->BufferSize();
@@ -116,6 +116,8 @@ void Sampler::Process(double time)
    
    mPolyMgr.Process(time, &mWriteBuffer, bufferSize);
    
+   EndSliderBlock();
+   
    SyncOutputBuffer(mWriteBuffer.NumActiveChannels());
    for (int ch=0; ch<mWriteBuffer.NumActiveChannels(); ++ch)
    {
@@ -234,6 +236,8 @@ void Sampler::LoadLayout(const ofxJSONElement& moduleInfo)
 {
    mModuleSaveData.LoadString("target", moduleInfo);
    mModuleSaveData.LoadBool("loop", moduleInfo, false);
+   mModuleSaveData.LoadInt("voicelimit", moduleInfo, kNumVoices, 1, PolyphonyMgr::kMaxVoices, true);
+   mModuleSaveData.LoadBool("parallel_voices", moduleInfo, false);
    
    SetUpFromSaveData();
 }
@@ -242,6 +246,8 @@ void Sampler::SetUpFromSaveData()
 {
    SetTarget(TheSynth->FindModule(mModuleSaveData.GetString("target")));
    mVoiceParams.mLoop = mModuleSaveData.GetBool("loop");
+   mPolyMgr.SetVoiceLimit(mModuleSaveData.GetInt("voicelimit"));
+   mPolyMgr.SetRenderInParallel(mModuleSaveData.GetBool("parallel_voices"));
 }
 
 
@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+    SaveStateFile.cpp
+    Created: 17 Oct 2026 9:26:40pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "SaveStateFile.h"
+
+namespace
+{
+   const int kEntryFixedSize = 8 + 8 + 8 + 4 + 1;   //offset, stored size, size, checksum, compressed flag
+   const int kCompressionLevel = 1;   //audio doesn't squeeze down much further at higher levels, and it's a lot slower
+}
+
+//static
+bool SaveStateFile::Write(const File& file, const string& layout, const vector<Chunk>& chunks, bool compress)
+{
+   //compress everything first, the table of contents needs to know how big each chunk came out
+   vector<MemoryBlock> compressed(chunks.size());
+   if (compress)
+   {
+      for (size_t i=0; i<chunks.size(); ++i)
+      {
+         {
+            MemoryOutputStream zipped(compressed[i], false);
+            GZIPCompressorOutputStream zipper(&zipped, kCompressionLevel);
+            zipper.write(chunks[i].mData.getData(), chunks[i].mData.getSize());
+         }
+         if (compressed[i].getSize() >= chunks[i].mData.getSize())
+            compressed[i].reset();   //didn't help, store this one as-is
+      }
+   }
+
+   TemporaryFile temp(file);
+   {
+      FileOutputStream out(temp.getFile());
+      if (out.failedToOpen())
+         return false;
+
+      out.writeInt((int)kMagic);
+      out.writeInt(kVersion);
+      out.writeInt64((int64)layout.size());
+      out.write(layout.data(), layout.size());
+
+      out.writeInt((int)chunks.size());
+      int64 offset = 0;
+      for (size_t i=0; i<chunks.size(); ++i)
+      {
+         bool isCompressed = compressed[i].getSize() > 0;
+         const MemoryBlock& stored = isCompressed ? compressed[i] : chunks[i].mData;
+         out.writeInt((int)chunks[i].mName.size());
+         out.write(chunks[i].mName.data(), chunks[i].mName.size());
+         out.writeInt64(offset);
+         out.writeInt64((int64)stored.getSize());
+         out.writeInt64((int64)chunks[i].mData.getSize());
+         out.writeInt((int)Checksum(stored.getData(), stored.getSize()));
+         out.writeByte(isCompressed ? 1 : 0);
+         offset += stored.getSize();
+      }
+
+      for (size_t i=0; i<chunks.size(); ++i)
+      {
+         const MemoryBlock& stored = compressed[i].getSize() > 0 ? compressed[i] : chunks[i].mData;
+         out.write(stored.getData(), stored.getSize());
+      }
+
+      out.flush();
+      if (out.getStatus().failed())
+         return false;
+   }
+
+   return temp.overwriteTargetFileWithTemporary();
+}
+
+SaveStateFile::SaveStateFile(const File& file)
+: mValid(false)
+, mPreparePool(kNumWorkers)
+{
+   mMappedFile = new MemoryMappedFile(file, MemoryMappedFile::readOnly);
+   const char* data = (const char*)mMappedFile->getData();
+   int64 size = (int64)mMappedFile->getSize();
+   if (data == nullptr || size < 8)
+      return;
+
+   MemoryInputStream in(data, (size_t)size, false);
+   if ((uint32)in.readInt() != kMagic || in.readInt() != kVersion)
+      return;
+
+   int64 layoutLength = in.readInt64();
+   if (layoutLength < 0 || layoutLength > in.getNumBytesRemaining())
+      return;
+   mLayout.assign(data + in.getPosition(), (size_t)layoutLength);
+   in.skipNextBytes(layoutLength);
+
+   int numChunks = in.readInt();
+   if (numChunks < 0)
+      return;
+   for (int i=0; i<numChunks; ++i)
+   {
+      Entry* entry = mEntries.add(new Entry());
+
+      int nameLength = in.readInt();
+      if (nameLength < 0 || nameLength + kEntryFixedSize > in.getNumBytesRemaining())
+         return;
+      entry->mName.assign(data + in.getPosition(), nameLength);
+      in.skipNextBytes(nameLength);
+
+      entry->mOffset = in.readInt64();
+      entry->mStoredSize = in.readInt64();
+      entry->mSize = in.readInt64();
+      entry->mChecksum = (uint32)in.readInt();
+      entry->mCompressed = in.readByte() != 0;
+   }
+
+   int64 chunkDataStart = in.getPosition();
+   for (auto* entry : mEntries)
+   {
+      if (entry->mOffset < 0 || entry->mStoredSize < 0 || entry->mSize < 0 ||
+          chunkDataStart + entry->mOffset + entry->mStoredSize > size ||
+          (!entry->mCompressed && entry->mStoredSize != entry->mSize))
+         return;   //table of contents points outside the file, it's been cut off or mangled
+      entry->mStored = data + chunkDataStart + entry->mOffset;
+   }
+
+   mValid = true;
+
+   //nothing gets read off the disk until a page is touched, so this checks and decodes chunks in the background
+   //while the modules ahead of them are loading
+   for (auto* entry : mEntries)
+      mPreparePool.addJob(new PrepareJob(entry), true);
+}
+
+SaveStateFile::~SaveStateFile()
+{
+   mPreparePool.removeAllJobs(true, 5000);
+}
+
+bool SaveStateFile::GetChunk(int index, const void*& data, size_t& size)
+{
+   Entry* entry = mEntries[index];
+   entry->mReady.wait();
+   if (!entry->mOk)
+      return false;
+
+   data = entry->mCompressed ? entry->mDecoded.getData() : entry->mStored;
+   size = (size_t)entry->mSize;
+   return true;
+}
+
+ThreadPoolJob::JobStatus SaveStateFile::PrepareJob::runJob()
+{
+   if (Checksum(mEntry->mStored, (size_t)mEntry->mStoredSize) == mEntry->mChecksum)
+   {
+      if (mEntry->mCompressed)
+      {
+         MemoryInputStream stored(mEntry->mStored, (size_t)mEntry->mStoredSize, false);
+         GZIPDecompressorInputStream unzipper(stored);
+         mEntry->mDecoded.setSize((size_t)mEntry->mSize);
+         char* decoded = (char*)mEntry->mDecoded.getData();
+         int64 decodedSize = 0;
+         while (decodedSize < mEntry->mSize)
+         {
+            int read = unzipper.read(decoded + decodedSize, (int)MIN(mEntry->mSize - decodedSize, int64(1 << 30)));
+            if (read <= 0)
+               break;
+            decodedSize += read;
+         }
+         mEntry->mOk = (decodedSize == mEntry->mSize);
+      }
+      else
+      {
+         mEntry->mOk = true;
+      }
+   }
+
+   mEntry->mReady.signal();
+   return jobHasFinished;
+}
+
+//static
+uint32 SaveStateFile::Checksum(const void* data, size_t size)
+{
+   //FNV-1a. only here to catch damaged files, not tampering
+   const uint8* bytes = (const uint8*)data;
+   uint32 hash = 2166136261u;
+   for (size_t i=0; i<size; ++i)
+   {
+      hash ^= bytes[i];
+      hash *= 16777619u;
+   }
+   return hash;
+}
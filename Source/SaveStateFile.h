@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    SaveStateFile.h
+    Created: 17 Oct 2026 9:26:40pm
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include "FileStream.h"
+
+//the .bsk container: the layout, a table of contents, then one chunk of saved state per module.
+//each chunk has its own checksum and can be compressed, so a damaged module gets skipped without losing the rest.
+//loading maps the file instead of streaming through it, and checks/decodes chunks on worker threads ahead of the
+//modules that are going to read them
+class SaveStateFile
+{
+public:
+   struct Chunk
+   {
+      string mName;
+      MemoryBlock mData;
+      vector<FileStreamOut::BufferRef> mBufferRefs;   //resolved into mData before it's written
+   };
+
+   static bool Write(const File& file, const string& layout, const vector<Chunk>& chunks, bool compress);
+
+   SaveStateFile(const File& file);
+   ~SaveStateFile();
+
+   bool IsValid() const { return mValid; }   //false for anything that isn't in this format, like saves from before it existed
+   const string& GetLayout() const { return mLayout; }
+   int GetNumChunks() const { return mEntries.size(); }
+   const string& GetChunkName(int index) const { return mEntries[index]->mName; }
+   bool GetChunk(int index, const void*& data, size_t& size);   //waits for the chunk to be ready. false if it's damaged
+
+   static const uint32 kMagic = 0x434b5342;   //"BSKC"
+   static const int kVersion = 1;
+   static const int kNumWorkers = 2;
+
+private:
+   struct Entry
+   {
+      Entry() : mOk(false), mReady(true) {}
+
+      string mName;
+      int64 mOffset;   //from the start of the chunk data, which follows the table of contents
+      int64 mStoredSize;
+      int64 mSize;
+      uint32 mChecksum;
+      bool mCompressed;
+
+      const char* mStored;
+      MemoryBlock mDecoded;
+      bool mOk;
+      WaitableEvent mReady;
+   };
+
+   class PrepareJob : public ThreadPoolJob
+   {
+   public:
+      PrepareJob(Entry* entry) : ThreadPoolJob("prepare save state chunk"), mEntry(entry) {}
+      JobStatus runJob() override;
+   private:
+      Entry* mEntry;
+   };
+
+   static uint32 Checksum(const void* data, size_t size);
+
+   ScopedPointer<MemoryMappedFile> mMappedFile;
+   bool mValid;
+   string mLayout;
+   OwnedArray<Entry> mEntries;
+   ThreadPool mPreparePool;   //declared last so it's torn down before the entries its jobs point at
+};
@@ -27,6 +27,7 @@ Scale::Scale()
 , mReferencePitchEntry(nullptr)
 , mIntonation(kIntonation_Equal)
 , mIntonationSelector(nullptr)
+, mFreqTable(nullptr)
 {
    assert(TheScale == nullptr);
    TheScale = this;
@@ -113,10 +114,27 @@ void Scale::Init()
 
 float Scale::PitchToFreq(float pitch)
 {
+   const FreqTable* table = mFreqTable.load(std::memory_order_acquire);
+   bool useTable = IsFreqTableCurrent(table);
+   
    switch (mIntonation)
    {
       case kIntonation_Equal:
+      {
+         if (useTable)
+         {
+            float index = pitch - kFreqTableMinPitch;
+            if (index >= 0 && index < kFreqTableSize)
+            {
+               int step = (int)index;
+               float fine = (index - step) * kFreqTableFineSteps;
+               int fineStep = (int)fine;
+               float fineRatio = ofLerp(table->mFine[fineStep], table->mFine[fineStep+1], fine - fineStep);
+               return table->mSteps[step] * fineRatio;
+            }
+         }
          return Pow2((pitch-mReferencePitch)/mTet) * mReferenceFreq;
+      }
       /*case kIntonation_Rational:
       {
          int referencePitch = ScaleRoot();
@@ -137,12 +155,17 @@ float Scale::PitchToFreq(float pitch)
       case kIntonation_Rational:
       case kIntonation_Meantone:
       {
-         int referencePitch = ScaleRoot();
-         do
+         int referencePitch;
+         float referenceFreq;
+         if (useTable)
          {
-            referencePitch += mTet;
-         }while (referencePitch < mReferencePitch && abs(referencePitch - mReferencePitch) > mTet);
-         float referenceFreq = Pow2((referencePitch-mReferencePitch)/mTet) * mReferenceFreq;
+            referencePitch = table->mTuningReferencePitch;
+            referenceFreq = table->mTuningReferenceFreq;
+         }
+         else
+         {
+            referenceFreq = GetReferenceFreqForTuningTable(referencePitch);
+         }
          
          int intPitch = (int)pitch;
          float remainder = pitch - intPitch;
@@ -159,6 +182,53 @@ float Scale::PitchToFreq(float pitch)
    return 0;
 }
 
+//the tuning table is centered on the scale root in the octave nearest the reference pitch
+float Scale::GetReferenceFreqForTuningTable(int& referencePitchOut) const
+{
+   int referencePitch = mScale.mScaleRoot;
+   do
+   {
+      referencePitch += mTet;
+   }while (referencePitch < mReferencePitch && abs(referencePitch - mReferencePitch) > mTet);
+   referencePitchOut = referencePitch;
+   return Pow2((referencePitch-mReferencePitch)/mTet) * mReferenceFreq;
+}
+
+//the table is only used while it matches the current settings, so changes that haven't reached
+//UpdateFreqTable() yet (loading, root changes from the audio thread) take the slow path until the next Poll()
+bool Scale::IsFreqTableCurrent(const FreqTable* table) const
+{
+   return table != nullptr &&
+          table->mTet == mTet &&
+          table->mReferenceFreq == mReferenceFreq &&
+          table->mReferencePitch == mReferencePitch &&
+          table->mRoot == mScale.mScaleRoot;
+}
+
+void Scale::UpdateFreqTable()
+{
+   FreqTable* current = mFreqTable.load(std::memory_order_acquire);
+   if (IsFreqTableCurrent(current) || mTet <= 0)
+      return;
+   
+   FreqTable* table = (current == &mFreqTables[0]) ? &mFreqTables[1] : &mFreqTables[0];
+   for (int i=0; i<kFreqTableSize; ++i)
+      table->mSteps[i] = pow(2.0, (i + kFreqTableMinPitch - mReferencePitch) / double(mTet)) * mReferenceFreq;
+   for (int i=0; i<=kFreqTableFineSteps; ++i)
+      table->mFine[i] = pow(2.0, i / double(kFreqTableFineSteps * mTet));
+   table->mTuningReferenceFreq = GetReferenceFreqForTuningTable(table->mTuningReferencePitch);
+   table->mTet = mTet;
+   table->mReferenceFreq = mReferenceFreq;
+   table->mReferencePitch = mReferencePitch;
+   table->mRoot = mScale.mScaleRoot;
+   mFreqTable.store(table, std::memory_order_release);
+   
+   //lookups happen on the audio thread and its workers, so anything still reading the old table picked it up
+   //before the swap, in a block that's over once this returns. after that it's free to be rebuilt next time
+   if (current != nullptr)
+      TheSynth->RunOnAudioThread([](){});
+}
+
 float Scale::FreqToPitch(float freq)
 {
    //TODO(Ryan) always use equal for now
@@ -331,6 +401,7 @@ vector<int> Scale::GetPitchesForScale(string type)
 void Scale::Poll()
 {
    ComputeSliders(0);
+   UpdateFreqTable();
 }
 
 float Scale::RationalizeNumber(float input)
@@ -502,8 +573,11 @@ void Scale::TextEntryComplete(TextEntry* entry)
    if (entry == mTetEntry)
    {
       UpdateTuningTable();
+      UpdateFreqTable();
       NotifyListeners();
    }
+   if (entry == mReferenceFreqEntry || entry == mReferencePitchEntry)
+      UpdateFreqTable();
 }
 
 void ScalePitches::SetRoot(int root)
@@ -17,6 +17,7 @@
 #include "Chord.h"
 #include "TextEntry.h"
 #include "ChordDatabase.h"
+#include <atomic>
 
 class IScaleListener
 {
@@ -127,6 +128,10 @@ private:
    float RationalizeNumber(float input);
    void UpdateTuningTable();
    float GetTuningTableRatio(int semitonesFromCenter);
+   struct FreqTable;
+   void UpdateFreqTable();
+   bool IsFreqTableCurrent(const FreqTable* table) const;
+   float GetReferenceFreqForTuningTable(int& referencePitchOut) const;
    
    enum IntonationMode
    {
@@ -158,6 +163,26 @@ private:
    DropdownList* mIntonationSelector;
    
    float mTuningTable[256];
+   
+   //equal temperament lookup for PitchToFreq(), rebuilt on the ui thread whenever the tuning changes.
+   //the coarse table holds whole steps, the fine table the fraction of a step in between
+   static const int kFreqTableMinPitch = -128;
+   static const int kFreqTableSize = 512;
+   static const int kFreqTableFineSteps = 256;
+   struct FreqTable
+   {
+      float mSteps[kFreqTableSize];
+      float mFine[kFreqTableFineSteps+1];
+      int mTet;   //the settings it was built for
+      float mReferenceFreq;
+      float mReferencePitch;
+      int mRoot;
+      int mTuningReferencePitch;
+      float mTuningReferenceFreq;
+   };
+   //a new table is built in whichever one isn't published and then swapped in, so a lookup never sees one half-built
+   FreqTable mFreqTables[2];
+   std::atomic<FreqTable*> mFreqTable;
    
    ChordDatabase mChordDatabase;
 };
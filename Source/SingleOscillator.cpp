@@ -126,14 +126,16 @@ void SingleOscillator::Process(double time)
    if (!mEnabled || GetTarget() == nullptr)
       return;
    
-   ComputeSliders(0);
-   
    int bufferSize = GetTarget()->GetBuffer()->BufferSize();
    assert(bufferSize == gBufferSize);
    
+   BeginSliderBlock(bufferSize);
+   
    mWriteBuffer.Clear();
    mPolyMgr.Process(time, &mWriteBuffer, bufferSize);
    
+   EndSliderBlock();
+   
    SyncOutputBuffer(mWriteBuffer.NumActiveChannels());
    for (int ch=0; ch<mWriteBuffer.NumActiveChannels(); ++ch)
    {
@@ -241,6 +243,8 @@ void SingleOscillator::LoadLayout(const ofxJSONElement& moduleInfo)
    mModuleSaveData.LoadEnum<OscillatorType>("osc", moduleInfo, kOsc_Sin, mOscSelector);
    mModuleSaveData.LoadFloat("detune", moduleInfo, 1, mDetuneSlider);
    mModuleSaveData.LoadBool("pressure_envelope", moduleInfo);
+   mModuleSaveData.LoadInt("voicelimit", moduleInfo, kNumVoices, 1, PolyphonyMgr::kMaxVoices, true);
+   mModuleSaveData.LoadBool("parallel_voices", moduleInfo, false);
 
    SetUpFromSaveData();
 }
@@ -251,6 +255,8 @@ void SingleOscillator::SetUpFromSaveData()
    SetVol(mModuleSaveData.GetFloat("vol"));
    SetType(mModuleSaveData.GetEnum<OscillatorType>("osc"));
    SetDetune(mModuleSaveData.GetFloat("detune"));
+   mPolyMgr.SetVoiceLimit(mModuleSaveData.GetInt("voicelimit"));
+   mPolyMgr.SetRenderInParallel(mModuleSaveData.GetBool("parallel_voices"));
 }
 
 
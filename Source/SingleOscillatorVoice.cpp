@@ -12,16 +12,22 @@
 #include "Scale.h"
 #include "Profiler.h"
 #include "ChannelBuffer.h"
+#include "IDrawableModule.h"
 
 SingleOscillatorVoice::SingleOscillatorVoice(IDrawableModule* owner)
-: mStartTime(-1)
+: mOsc(kOsc_Square)
+, mStartTime(-1)
 , mUseFilter(false)
 , mOwner(owner)
 {
+   mAdsrBuffer = new float[kWorkBufferSize];
+   mFilterAdsrBuffer = new float[kWorkBufferSize];
 }
 
 SingleOscillatorVoice::~SingleOscillatorVoice()
 {
+   delete[] mAdsrBuffer;
+   delete[] mFilterAdsrBuffer;
 }
 
 bool SingleOscillatorVoice::IsDone(double time)
@@ -36,36 +42,58 @@ bool SingleOscillatorVoice::Process(double time, ChannelBuffer* out)
    if (IsDone(time))
       return false;
    
-   for (int u=0; u<mVoiceParams->mUnison && u<kMaxUnison; ++u)
-      mOscData[u].mOsc.SetType(mVoiceParams->mOscType);
+   mOsc.SetType(mVoiceParams->mOscType);
    
    bool mono = (out->NumActiveChannels() == 1);
+   int numLanes = mVoiceParams->mUnison;
+   if (numLanes > kMaxUnison)
+      numLanes = kMaxUnison;
+   
+   float lanePhases[kMaxUnison];
+   float lanePhaseIncs[kMaxUnison];
+   float laneSamples[kMaxUnison];
+   float laneGainLeft[kMaxUnison];
+   float laneGainRight[kMaxUnison];
+   float lastPan = -999;
+   float lastUnisonWidth = -999;
       
-   float syncPhaseInc = GetPhaseInc(mVoiceParams->mSyncFreq);
+   assert(out->BufferSize() <= kWorkBufferSize);
+   mAdsr.Render(time, mAdsrBuffer, out->BufferSize());
+   if (mUseFilter)
+      mFilterAdsr.Render(time, mFilterAdsrBuffer, out->BufferSize());
+   
+   //read modulated sliders per sample from the owner's slider block, the sliders themselves don't move under us
+   SliderBlockValues pulseWidth(mOwner, &mVoiceParams->mPulseWidth);
+   SliderBlockValues shuffle(mOwner, &mVoiceParams->mShuffle);
+   SliderBlockValues detuneAmount(mOwner, &mVoiceParams->mDetune);
+   SliderBlockValues phaseOffset(mOwner, &mVoiceParams->mPhaseOffset);
+   SliderBlockValues unisonWidth(mOwner, &mVoiceParams->mUnisonWidth);
+   SliderBlockValues volume(mOwner, &mVoiceParams->mVol);
+   SliderBlockValues filterCutoff(mOwner, &mVoiceParams->mFilterCutoff);
+   SliderBlockValues filterQ(mOwner, &mVoiceParams->mFilterQ);
+   SliderBlockValues syncFreq(mOwner, &mVoiceParams->mSyncFreq);
+   
    for (int pos=0; pos<out->BufferSize(); ++pos)
    {
-      if (mOwner)
-         mOwner->ComputeSliders(pos);
+      float syncPhaseInc = GetPhaseInc(syncFreq[pos]);
+      float adsrVal = mAdsrBuffer[pos];
       
-      float adsrVal = mAdsr.Value(time);
+      mOsc.SetPulseWidth(pulseWidth[pos]);
+      mOsc.SetShuffle(shuffle[pos]);
       
-      float summedLeft = 0;
-      float summedRight = 0;
-      for (int u=0; u<mVoiceParams->mUnison && u<kMaxUnison; ++u)
+      float pitch = GetPitch(pos);
+      float freq = TheScale->PitchToFreq(pitch) * mVoiceParams->mMult;
+      float baseInc = GetPhaseInc(freq);
+      
+      for (int u=0; u<numLanes; ++u)
       {
-         mOscData[u].mOsc.SetPulseWidth(mVoiceParams->mPulseWidth);
-         mOscData[u].mOsc.SetShuffle(mVoiceParams->mShuffle);
-         
-         float pitch = GetPitch(pos);
-         float freq = TheScale->PitchToFreq(pitch) * mVoiceParams->mMult;
-         
-         float detune = ((mVoiceParams->mDetune - 1) * mOscData[u].mDetuneFactor) + 1;
-         float phaseInc = GetPhaseInc(freq * detune);
+         float detune = ((detuneAmount[pos] - 1) * mOscData[u].mDetuneFactor) + 1;
+         float phaseInc = baseInc * detune;
          
          mOscData[u].mPhase += phaseInc;
          if (mOscData[u].mPhase == INFINITY)
          {
-            ofLog() << "Infinite phase. phaseInc:" + ofToString(phaseInc) + " detune:" + ofToString(mVoiceParams->mDetune) + " freq:" + ofToString(freq) + " pitch:" + ofToString(pitch) + " getpitch:" + ofToString(GetPitch(pos));
+            ofLog() << "Infinite phase. phaseInc:" + ofToString(phaseInc) + " detune:" + ofToString(detuneAmount[pos]) + " freq:" + ofToString(freq) + " pitch:" + ofToString(pitch) + " getpitch:" + ofToString(GetPitch(pos));
          }
          while (mOscData[u].mPhase > FTWO_PI*2)
          {
@@ -74,22 +102,35 @@ bool SingleOscillatorVoice::Process(double time, ChannelBuffer* out)
          }
          mOscData[u].mSyncPhase += syncPhaseInc;
          
-         float sample;
-         float vol = mVoiceParams->mVol * .1f;
-         
          if (mVoiceParams->mSync)
-            sample = mOscData[u].mOsc.Value(mOscData[u].mSyncPhase) * adsrVal * vol;
-         else
-            sample = mOscData[u].mOsc.Value(mOscData[u].mPhase + mVoiceParams->mPhaseOffset) * adsrVal * vol;
-         
-         if (u >= 2)
-            sample *= 1 - (mOscData[u].mDetuneFactor * .5f);
-         
-         if (mono)
          {
-            summedLeft += sample;
+            lanePhases[u] = mOscData[u].mSyncPhase;
+            lanePhaseIncs[u] = syncPhaseInc;
          }
          else
+         {
+            lanePhases[u] = mOscData[u].mPhase + phaseOffset[pos];
+            lanePhaseIncs[u] = phaseInc;
+         }
+      }
+      
+      //all unison voices at once when we can, otherwise one at a time
+      if (mOsc.CanRenderLanes())
+      {
+         mOsc.RenderLanes(lanePhases, lanePhaseIncs, laneSamples, numLanes);
+      }
+      else
+      {
+         for (int u=0; u<numLanes; ++u)
+            laneSamples[u] = mOsc.Value(lanePhases[u]);
+      }
+      
+      float pan = GetPan();
+      if (!mono && (pan != lastPan || unisonWidth[pos] != lastUnisonWidth))
+      {
+         lastPan = pan;
+         lastUnisonWidth = unisonWidth[pos];
+         for (int u=0; u<numLanes; ++u)
          {
             float unisonPan;
             if (mVoiceParams->mUnison == 1)
@@ -100,16 +141,36 @@ bool SingleOscillatorVoice::Process(double time, ChannelBuffer* out)
                unisonPan = 1;
             else
                unisonPan = mOscData[u].mDetuneFactor;
-            float pan = GetPan() + unisonPan * mVoiceParams->mUnisonWidth;
-            summedLeft += sample * GetLeftPanGain(pan);
-            summedRight += sample * GetRightPanGain(pan);
+            float lanePan = pan + unisonPan * lastUnisonWidth;
+            laneGainLeft[u] = GetLeftPanGain(lanePan);
+            laneGainRight[u] = GetRightPanGain(lanePan);
+         }
+      }
+      
+      float vol = volume[pos] * .1f * adsrVal;
+      float summedLeft = 0;
+      float summedRight = 0;
+      for (int u=0; u<numLanes; ++u)
+      {
+         float sample = laneSamples[u] * vol;
+         if (u >= 2)
+            sample *= 1 - (mOscData[u].mDetuneFactor * .5f);
+         
+         if (mono)
+         {
+            summedLeft += sample;
+         }
+         else
+         {
+            summedLeft += sample * laneGainLeft[u];
+            summedRight += sample * laneGainRight[u];
          }
       }
       
       if (mUseFilter)
       {
-         float f = mFilterAdsr.Value(time) * mVoiceParams->mFilterCutoff;
-         float q = mVoiceParams->mFilterQ;
+         float f = mFilterAdsrBuffer[pos] * filterCutoff[pos];
+         float q = filterQ[pos];
          mFilterLeft.SetFilterParams(f, q);
          summedLeft = mFilterLeft.Filter(summedLeft);
          if (!mono)
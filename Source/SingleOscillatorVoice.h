@@ -59,18 +59,20 @@ public:
 private:
    struct OscData
    {
-      OscData() : mPhase(0), mSyncPhase(0), mOsc(kOsc_Square), mDetuneFactor(0) {}
+      OscData() : mPhase(0), mSyncPhase(0), mDetuneFactor(0) {}
       float mPhase;
       float mSyncPhase;
-      Oscillator mOsc;
       float mDetuneFactor;
    };
    OscData mOscData[kMaxUnison];
+   Oscillator mOsc;  //shared by all unison voices, so they can be rendered together
    ADSR mAdsr;
    OscillatorVoiceParams* mVoiceParams;
    double mStartTime;
    
    ADSR mFilterAdsr;
+   float* mAdsrBuffer;
+   float* mFilterAdsrBuffer;
    BiquadFilter mFilterLeft;
    BiquadFilter mFilterRight;
    bool mUseFilter;
@@ -45,6 +45,8 @@ FloatSlider::FloatSlider(IFloatSliderListener* owner, const char* label, int x,
 , mSmooth(0)
 , mIsSmoothing(false)
 , mComputeHasBeenCalledOnce(false)
+, mBlockValues(new float[kWorkBufferSize])   //allocated up front, blocks are computed on the audio thread
+, mBlockSize(0)
 {
    assert(owner);
    SetLabel(label);
@@ -63,6 +65,7 @@ FloatSlider::~FloatSlider()
 {
    if (mIsSmoothing)
       TheTransport->RemoveAudioPoller(this);
+   delete[] mBlockValues;
 }
 
 void FloatSlider::Init()
@@ -517,6 +520,44 @@ void FloatSlider::Compute(int samplesIn /*= 0*/)
    }
 }
 
+bool FloatSlider::IsModulated() const
+{
+   return (mModulator && mModulator->Active()) || mIsSmoothing;
+}
+
+void FloatSlider::ComputeBlock(int blockSize)
+{
+   mComputeHasBeenCalledOnce = true;
+   
+   mBlockSize = MIN(blockSize, kWorkBufferSize);
+   
+   //same as Compute(), without notifying the owner. that happens in ApplyBlockValue() when the value is used
+   float startVal = *mVar;
+   for (int i=0; i<mBlockSize; ++i)
+   {
+      if (mModulator && mModulator->Active())
+      {
+         float* var = mIsSmoothing ? &mSmoothTarget : mVar;
+         *var = mModulator->Value(i);
+      }
+      if (mIsSmoothing)
+         *mVar = ofClamp(mRamp.Value(gTime + i * gInvSampleRateMs), mMin, mMax);
+      mBlockValues[i] = *mVar;
+   }
+   *mVar = startVal;
+}
+
+void FloatSlider::ApplyBlockValue(int samplesIn)
+{
+   if (mBlockSize == 0)
+      return;
+   
+   float oldVal = *mVar;
+   *mVar = mBlockValues[MIN(samplesIn, mBlockSize-1)];
+   if (oldVal != *mVar)
+      mOwner->FloatSliderUpdated(this, oldVal);
+}
+
 float* FloatSlider::GetModifyValue()
 {
    if (!TheSynth->IsLoadingModule() && mModulator && mModulator->Active() && mModulator->CanAdjustRange())
@@ -39,6 +39,12 @@ public:
    bool IsMouseDown() const { return mMouseDown; }
    void SetExtents(float min, float max) { mMin = min; mMax = max; }
    void Compute(int samplesIn = 0);
+   bool IsModulated() const;
+   void ComputeBlock(int blockSize);
+   void ApplyBlockValue(int samplesIn);
+   const float* GetBlockValues() const { return mBlockValues; }   //from the last ComputeBlock()
+   int GetBlockSize() const { return mBlockSize; }
+   const float* GetVar() const { return mVar; }
    void DisplayLFOControl();
    void DisableLFO();
    FloatSliderLFOControl* GetLFO() { return mLFOControl; }
@@ -131,6 +137,8 @@ private:
    Ramp mRamp;
    bool mIsSmoothing;
    bool mComputeHasBeenCalledOnce;
+   float* mBlockValues;
+   int mBlockSize;
    
    float mLastDisplayedValue;
    
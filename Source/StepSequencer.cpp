@@ -404,16 +404,16 @@ void StepSequencer::OnTimeEvent(int samplesTo)
    UpdateLights();
 }
 
-void StepSequencer::PlayNote(int note, float val)
+void StepSequencer::PlayStepNote(double time, int note, float val)
 {
    if (mStochasticMode)
    {
       if (val > ofRandom(1))
-         mNoteOutput.PlayNote(gTime, note, val * 127);
+         mNoteOutput.PlayNote(time, note, val * 127);
    }
    else
    {
-      mNoteOutput.PlayNote(gTime, note, val * 127);
+      mNoteOutput.PlayNote(time, note, val * 127);
    }
 }
 
@@ -686,7 +686,7 @@ void StepSequencerRow::OnTimeEvent(int samplesTo)
    int step = mSeq->GetStep(offsetMs);
    float val = mGrid->GetValRefactor(mRow,step);
    if (val > 0)
-      mSeq->PlayNote(mRow, val * val);
+      mSeq->PlayStepNote(gTime + samplesTo * gInvSampleRateMs, mRow, val * val);
 }
 
 void StepSequencerRow::SetOffset(float offset)
@@ -718,7 +718,7 @@ void NoteRepeat::OnTimeEvent(int samplesTo)
 {
    int pressure = mSeq->GetPadPressure(mRow);
    if (pressure > 10)
-      mSeq->PlayNote(mRow, pressure / 85.0f);
+      mSeq->PlayStepNote(gTime + samplesTo * gInvSampleRateMs, mRow, pressure / 85.0f);
 }
 
 void NoteRepeat::SetInterval(NoteInterval interval)
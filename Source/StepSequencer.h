@@ -79,7 +79,7 @@ public:
    
    void Init() override;
    void Poll() override;
-   void PlayNote(int note, float val);
+   void PlayStepNote(double time, int note, float val);
    void SetEnabled(bool enabled) override { mEnabled = enabled; }
    bool Enabled() const override { return mEnabled; }
    int GetPadPressure(int row) { return mPadPressures[row]; }
@@ -8,6 +8,7 @@
 
 
 #include "SynthGlobals.h"
+#include "PeakCache.h"
 #include "ModularSynth.h"
 #include "IAudioSource.h"
 #include "INoteSource.h"
@@ -19,6 +20,14 @@
 #include "PatchCable.h"
 #include "PatchCableSource.h"
 #include "ChannelBuffer.h"
+#include "Profiler.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPIN_WAIT_USE_PAUSE 1
+#else
+#define SPIN_WAIT_USE_PAUSE 0
+#endif
 
 #ifdef JUCE_MAC
 #import <execinfo.h>
@@ -43,8 +52,8 @@ RetinaTrueTypeFont gFontBold;
 float gModuleDrawAlpha = 255;
 float gNullBuffer[kWorkBufferSize];
 float gZeroBuffer[kWorkBufferSize];
-float gWorkBuffer[kWorkBufferSize];
-ChannelBuffer gWorkChannelBuffer(kWorkBufferSize);
+thread_local float gWorkBuffer[kWorkBufferSize];
+thread_local ChannelBuffer gWorkChannelBuffer(kWorkBufferSize);
 IUIControl* gHoveredUIControl = nullptr;
 IUIControl* gHotBindUIControl[10];
 float gControlTactileFeedback = 0;
@@ -75,6 +84,30 @@ void LoadGlobalResources()
    //gModuleShader.load(ofToDataPath("shaders/module.vert"), ofToDataPath("shaders/module.frag"));
 }
 
+void PrepareAudioThread()
+{
+   Profiler::RegisterThread();
+   Clear(gWorkBuffer, kWorkBufferSize);
+   gWorkChannelBuffer.SetNumActiveChannels(ChannelBuffer::kMaxNumChannels);
+   for (int ch=0; ch<ChannelBuffer::kMaxNumChannels; ++ch)
+      gWorkChannelBuffer.GetChannel(ch);
+   gWorkChannelBuffer.SetNumActiveChannels(1);
+}
+
+void SpinWait::Pause()
+{
+   if (++mCount < kSpinsBeforeYield)
+   {
+#if SPIN_WAIT_USE_PAUSE
+      _mm_pause();
+#endif
+   }
+   else
+   {
+      juce::Thread::yield();
+   }
+}
+
 void SetGlobalBufferSize(int size)
 {
    assert(size <= kWorkBufferSize);
@@ -90,6 +123,59 @@ void SetGlobalSampleRate(int rate)
    gNyquistLimit = gSampleRate / 2.0f;
 }
 
+namespace
+{
+   //draws one channel's waveform, with getPeak(position, samplesPerStep) giving the loudest magnitude in each column
+   template <typename GetPeak>
+   void DrawWaveform(float width, float height, float start, float end, float pos, float vol, ofColor color, GetPeak getPeak)
+   {
+      vol = MAX(.1f,vol); //make sure we at least draw something if there is waveform data
+      
+      ofPushStyle();
+      
+      ofSetLineWidth(.5f);
+      ofFill();
+      ofSetColor(255,255,255,50);
+      ofRect(0, 0, width, height);
+      
+      if (end - start > 0)
+      {
+         float step = .5f/gDrawScale;
+         float samplesPerStep = (end-start) / width * step;
+         
+         for (float i = 0; i < width; i+=step)
+         {
+            int position =  ofMap(i, 0, width, start, end-1, true);
+            float mag = getPeak(position, samplesPerStep);
+            mag = sqrt(mag);
+            mag = sqrt(mag);
+            mag *= height/2 * vol;
+            if (mag > height/2)
+            {
+               ofSetColor(255,0,0);
+               mag = height/2;
+            }
+            else
+            {
+               ofSetColor(color);
+            }
+            if (mag == 0)
+               mag = .1f;
+            ofLine(i, height/2-mag, i, height/2+mag);
+         }
+         
+         if (pos != -1)
+         {
+            ofSetColor(0,255,0);
+            int position =  ofMap(pos, start, end, 0, width, true);
+            ofLine(position,0,position,height);
+         }
+      }
+      
+      ofPopStyle();
+   }
+}
+
 void DrawAudioBuffer(float width, float height, ChannelBuffer* buffer, float start, float end, float pos, float vol /*=1*/, ofColor color /*=ofColor::black*/)
 {
    ofPushMatrix();
@@ -104,55 +190,37 @@ void DrawAudioBuffer(float width, float height, ChannelBuffer* buffer, float sta
 
 void DrawAudioBuffer(float width, float height, const float* buffer, float start, float end, float pos, float vol /*=1*/, ofColor color /*=ofColor::black*/)
 {
-   vol = MAX(.1f,vol); //make sure we at least draw something if there is waveform data
-   
-   ofPushStyle();
+   if (buffer == nullptr)
+      end = start;   //just the background
    
-   ofSetLineWidth(.5f);
-   ofFill();
-   ofSetColor(255,255,255,50);
-   ofRect(0, 0, width, height);
-   
-   if (buffer && end - start > 0)
+   DrawWaveform(width, height, start, end, pos, vol, color, [buffer, end](int position, float samplesPerStep)
    {
-      float step = .5f/gDrawScale;
-      float samplesPerStep = (end-start) / width * step;
-      
-      for (float i = 0; i < width; i+=step)
-      {
-         float mag = 0;
-         int position =  ofMap(i, 0, width, start, end-1, true);
-         //rms
-         int j;
-         int inc = 1+samplesPerStep / 100;
-         for (j=0; j<samplesPerStep && position+j < end-1; j+=inc)
-            mag = MAX(mag,fabsf(buffer[position+j]));
-         mag = sqrt(mag);
-         mag = sqrt(mag);
-         mag *= height/2 * vol;
-         if (mag > height/2)
-         {
-            ofSetColor(255,0,0);
-            mag = height/2;
-         }
-         else
-         {
-            ofSetColor(color);
-         }
-         if (mag == 0)
-            mag = .1f;
-         ofLine(i, height/2-mag, i, height/2+mag);
-      }
-      
-      if (pos != -1)
+      float mag = 0;
+      int inc = 1+samplesPerStep / 100;
+      for (int j=0; j<samplesPerStep && position+j < end-1; j+=inc)
+         mag = MAX(mag,fabsf(buffer[position+j]));
+      return mag;
+   });
+}
+
+//same as above, but reads from the peak cache rather than scanning the samples
+void DrawAudioBuffer(float width, float height, const PeakCache* peaks, float start, float end, float pos, float vol /*=1*/, ofColor color /*=ofColor::black*/)
+{
+   ofPushMatrix();
+   int numChannels = MAX(peaks->NumChannels(), 1);
+   for (int ch=0; ch<numChannels; ++ch)
+   {
+      DrawWaveform(width, height/numChannels, start, end, pos, vol, color, [peaks, ch, end](int position, float samplesPerStep)
       {
-         ofSetColor(0,255,0);
-         int position =  ofMap(pos, start, end, 0, width, true);
-         ofLine(position,0,position,height);
-      }
+         if (ch >= peaks->NumChannels())
+            return 0.0f;
+         float min, max, rms;
+         peaks->GetPeak(ch, position, MIN(position + MAX(int(samplesPerStep), 1), int(end)), min, max, rms);
+         return MAX(fabsf(min), fabsf(max));
+      });
+      ofTranslate(0, height/numChannels);
    }
-
-   ofPopStyle();
+   ofPopMatrix();
 }
 
 void Add(float* buff1, const float* buff2, int bufferSize)
@@ -665,6 +733,21 @@ float GetRightPanGain(float pan)
    return ofMap(pan, -1, 0, 0, 1, true) + ofMap(pan, 0, 1, 0, 1, true);
 }
 
+#if defined(BESPOKE_DEBUG_ALLOCATIONS) || defined(BESPOKE_COUNT_ALLOCATIONS)
+//counted per thread, so the cost of one module's processing can be measured on its own
+static thread_local int64 sAllocationCount = 0;
+
+int64 GetAllocationCount()
+{
+   return sAllocationCount;
+}
+#else
+int64 GetAllocationCount()
+{
+   return -1;
+}
+#endif
+
 #ifdef BESPOKE_DEBUG_ALLOCATIONS
 FILE* logAllocationsFile;
 
@@ -814,12 +897,14 @@ void DumpUnfreedMemory()
 #undef new
 void* operator new(std::size_t size) throw(std::bad_alloc)
 {
+   ++sAllocationCount;
    void *ptr = (void*)malloc(size);
    //AddTrack((uint32)ptr, size, "<unknown>", 0);
    return(ptr);
 }
 void* operator new(std::size_t size, const char *file, int line) throw(std::bad_alloc)
 {
+   ++sAllocationCount;
    void *ptr = (void*)malloc(size);
    AddTrack((uint32)ptr, size, file, line);
    return(ptr);
@@ -831,12 +916,14 @@ void operator delete(void* p) throw()
 }
 void* operator new[](std::size_t size) throw(std::bad_alloc)
 {
+   ++sAllocationCount;
    void *ptr = (void*)malloc(size);
    //AddTrack((uint32)ptr, size, "<unknown>", 0);
    return(ptr);
 }
 void* operator new[](std::size_t size, const char *file, int line) throw(std::bad_alloc)
 {
+   ++sAllocationCount;
    void* ptr = (void*)malloc(size);
    AddTrack((uint32)ptr, size, file, line);
    return(ptr);
@@ -855,4 +942,59 @@ void DumpUnfreedMemory()
 {
    ofLog() << "This only works with BESPOKE_DEBUG_ALLOCATIONS defined";
 };
+
+#if defined(BESPOKE_COUNT_ALLOCATIONS) && defined(BESPOKE_LINUX)
+//glibc lets us stand in for malloc itself, which catches allocations that don't come through new as well as the ones
+//that do, since the default operator new calls malloc
+extern "C"
+{
+   void* __libc_malloc(size_t size);
+   void* __libc_calloc(size_t num, size_t size);
+   void* __libc_realloc(void* ptr, size_t size);
+   
+   void* malloc(size_t size) __THROW
+   {
+      ++sAllocationCount;
+      return __libc_malloc(size);
+   }
+   void* calloc(size_t num, size_t size) __THROW
+   {
+      ++sAllocationCount;
+      return __libc_calloc(num, size);
+   }
+   void* realloc(void* ptr, size_t size) __THROW
+   {
+      ++sAllocationCount;
+      return __libc_realloc(ptr, size);
+   }
+}
+#elif defined(BESPOKE_COUNT_ALLOCATIONS)
+//elsewhere only new is counted
+#undef new
+void* operator new(std::size_t size) throw(std::bad_alloc)
+{
+   ++sAllocationCount;
+   void* ptr = malloc(size);
+   if (ptr == nullptr)
+      throw std::bad_alloc();
+   return ptr;
+}
+void operator delete(void* p) throw()
+{
+   free(p);
+}
+void* operator new[](std::size_t size) throw(std::bad_alloc)
+{
+   ++sAllocationCount;
+   void* ptr = malloc(size);
+   if (ptr == nullptr)
+      throw std::bad_alloc();
+   return ptr;
+}
+void operator delete[](void* p) throw()
+{
+   free(p);
+}
+#define new DEBUG_NEW
+#endif
 #endif
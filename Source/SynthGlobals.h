@@ -19,6 +19,7 @@
 #include <random>
 
 //#define BESPOKE_DEBUG_ALLOCATIONS
+//#define BESPOKE_COUNT_ALLOCATIONS   //for --benchmark, so modules that allocate while processing show up
 
 #ifdef BESPOKE_DEBUG_ALLOCATIONS
 void* operator new(std::size_t size, const char *file, int line) throw(std::bad_alloc);
@@ -56,6 +57,7 @@ class IUIControl;
 class IDrawableModule;
 class RollingBuffer;
 class ChannelBuffer;
+class PeakCache;
 
 typedef map<string,int> EnumMap;
 
@@ -79,8 +81,8 @@ extern RetinaTrueTypeFont gFontBold;
 extern float gModuleDrawAlpha;
 extern float gNullBuffer[4096];
 extern float gZeroBuffer[4096];
-extern float gWorkBuffer[4096];  //scratch buffer for doing work in
-extern ChannelBuffer gWorkChannelBuffer;
+extern thread_local float gWorkBuffer[4096];  //scratch buffer for doing work in, one per audio thread
+extern thread_local ChannelBuffer gWorkChannelBuffer;
 extern IUIControl* gHoveredUIControl;
 extern IUIControl* gHotBindUIControl[10];
 extern float gControlTactileFeedback;
@@ -136,6 +138,7 @@ void SetGlobalBufferSize(int size);
 void SetGlobalSampleRate(int rate);
 void DrawAudioBuffer(float width, float height, ChannelBuffer* buffer, float start, float end, float pos, float vol=1, ofColor color=ofColor::black);
 void DrawAudioBuffer(float width, float height, const float* buffer, float start, float end, float pos, float vol=1, ofColor color=ofColor::black);
+void DrawAudioBuffer(float width, float height, const PeakCache* peaks, float start, float end, float pos, float vol=1, ofColor color=ofColor::black);
 void Add(float* buff1, const float* buff2, int bufferSize);
 void Mult(float* buff, float val, int bufferSize);
 void Mult(float* buff1, const float* buff2, int bufferSize);
@@ -172,6 +175,8 @@ string GetUniqueName(string name, vector<IDrawableModule*> existing);
 string GetUniqueName(string name, vector<string> existing);
 void SetMemoryTrackingEnabled(bool enabled);
 void DumpUnfreedMemory();
+int64 GetAllocationCount();  //allocations made by the calling thread so far, or -1 if this build doesn't count them
+void PrepareAudioThread();  //sets up the calling thread's scratch buffers, so an audio worker doesn't do it on its first block
 float DistSqToLine(ofVec2f point, ofVec2f a, ofVec2f b);
 uint32_t JenkinsHash(const char* key);
 void LoadStateValidate(bool assertion);
@@ -183,6 +188,29 @@ inline static float RandomSample()
    return (float(rand())/RAND_MAX) * 2.0f - 1.0f;
 }
 
+//minimax polynomial for sin(2*pi*t), t in [0,1). branch free, so loops over it vectorize
+inline float SinCycle(float t)
+{
+   float u = t - .5f;   //sin(2*pi*t) == -sin(2*pi*u)
+   float x = (.25f - fabsf(fabsf(u) - .25f)) * FTWO_PI;   //fold into the first quarter cycle
+   float x2 = x * x;
+   float y = x * (0.99999660f + x2 * (-0.16664824f + x2 * (0.00830629f + x2 * -0.00018363f)));
+   return -copysignf(y, u);
+}
+
+//for audio threads waiting a moment on each other. spins with a cpu pause for a while, then starts yielding the core,
+//so a waiter never starves the thread it's waiting on
+class SpinWait
+{
+public:
+   SpinWait() : mCount(0) {}
+   void Pause();
+   int GetCount() const { return mCount; }
+   static const int kSpinsBeforeYield = 256;
+private:
+   int mCount;
+};
+
 #ifndef assert
 #define assert Assert
 
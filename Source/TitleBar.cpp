@@ -110,6 +110,8 @@ TitleBar::TitleBar()
 , mSaveStateButton(nullptr)
 , mLoadStateButton(nullptr)
 , mWriteAudioButton(nullptr)
+, mRecordOutputCheckbox(nullptr)
+, mRecordOutput(false)
 , mQuitButton(nullptr)
 , mLoadLayoutDropdown(nullptr)
 , mLoadLayoutIndex(-1)
@@ -127,6 +129,7 @@ void TitleBar::CreateUIControls()
    mSaveStateButton = new ClickButton(this,"save state",140,19);
    mLoadStateButton = new ClickButton(this,"load state",205,19);
    mWriteAudioButton = new ClickButton(this,"write audio",280,19);
+   mRecordOutputCheckbox = new Checkbox(this,"rec",mWriteAudioButton,kAnchor_Right,&mRecordOutput);
    mQuitButton = new ClickButton(this,"quit",400,19);
    mDisplayHelpButton = new ClickButton(this," ? ",380,19);
    mLoadLayoutDropdown = new DropdownList(this, "load layout", 140, 2, &mLoadLayoutIndex);
@@ -201,6 +204,8 @@ void TitleBar::DrawModule()
       mSaveStateButton->Draw();
       mLoadStateButton->Draw();
       mWriteAudioButton->Draw();
+      mRecordOutput = TheSynth->IsRecordingOutput();
+      mRecordOutputCheckbox->Draw();
       mLoadLayoutDropdown->Draw();
    }
    
@@ -274,6 +279,8 @@ void TitleBar::GetModuleDimensions(int& x, int& y)
 
 void TitleBar::CheckboxUpdated(Checkbox* checkbox)
 {
+   if (checkbox == mRecordOutputCheckbox)
+      TheSynth->SetRecordingOutput(mRecordOutput);
 }
 
 void TitleBar::DropdownUpdated(DropdownList* list, int oldVal)
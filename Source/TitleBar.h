@@ -13,6 +13,7 @@
 #include "IDrawableModule.h"
 #include "DropdownList.h"
 #include "ClickButton.h"
+#include "Checkbox.h"
 #include "Slider.h"
 
 class ModuleFactory;
@@ -82,6 +83,8 @@ private:
    ClickButton* mSaveStateButton;
    ClickButton* mLoadStateButton;
    ClickButton* mWriteAudioButton;
+   Checkbox* mRecordOutputCheckbox;
+   bool mRecordOutput;
    ClickButton* mQuitButton;
    DropdownList* mLoadLayoutDropdown;
    ClickButton* mDisplayHelpButton;
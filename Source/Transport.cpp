@@ -20,6 +20,7 @@ Transport::Transport()
 , mTimeSigBottom(4)
 , mMeasureCount(0)
 , mMeasurePos(0)
+, mAnnouncedPos(0)
 , mSwingInterval(8)
 , mSwing(.5f)
 , mSwingSlider(nullptr)
@@ -37,6 +38,13 @@ Transport::Transport()
 , mTempoSlider(nullptr)
 , mLoopStartMeasure(-1)
 , mLoopEndMeasure(-1)
+, mHoldingNewListeners(false)
+, mTimingLists(new TimingLists())
+, mAdvancing(false)
+, mAdvancingThread(nullptr)
+, mAudioThread(nullptr)
+, mQueuedEditsWrite(0)
+, mQueuedEditsRead(0)
 {
    assert(TheTransport == nullptr);
    TheTransport = this;
@@ -44,6 +52,13 @@ Transport::Transport()
    SetName("transport");
 }
 
+Transport::~Transport()
+{
+   delete mTimingLists.load();
+   for (auto* lists : mRetiredTimingLists)
+      delete lists;
+}
+
 void Transport::CreateUIControls()
 {
    IDrawableModule::CreateUIControls();
@@ -116,6 +131,29 @@ void Transport::Advance(float ms)
    
    int oldMeasureCount = mMeasureCount;
    
+   AdvanceMeasurePos(amount);
+   mAnnouncedPos -= amount;
+   
+   if (TheChaosEngine)
+      TheChaosEngine->AudioUpdate();
+   
+   //flag that we're walking the lists before picking them up, so whoever swaps them out knows to wait for us
+   mAudioThread.store(Thread::getCurrentThreadId());
+   mAdvancingThread.store(Thread::getCurrentThreadId());
+   mAdvancing.store(true);
+   const TimingLists* lists = mTimingLists.load();
+
+   UpdateListeners(lists->mListeners);
+
+   for (auto* poller : lists->mAudioPollers)
+      poller->OnTransportAdvanced(amount);
+   
+   mAdvancing.store(false);
+   mAdvancingThread.store(nullptr);
+}
+
+void Transport::AdvanceMeasurePos(float amount)
+{
    mMeasurePos += amount;
    while (mMeasurePos>1)
    {
@@ -124,17 +162,6 @@ void Transport::Advance(float ms)
       if (mLoopStartMeasure != -1 && (mMeasureCount < mLoopStartMeasure || mMeasureCount >= mLoopEndMeasure))
          mMeasureCount = mLoopStartMeasure;
    }
-   
-   if (TheChaosEngine)
-      TheChaosEngine->AudioUpdate();
-
-   UpdateListeners(ms);
-
-   for (list<IAudioPoller*>::iterator i = mAudioPollers.begin(); i != mAudioPollers.end(); ++i)
-   {
-      IAudioPoller* poller = *i;
-      poller->OnTransportAdvanced(amount);
-   }
 }
 
 float QuadraticBezier (float x, float a, float b)
@@ -180,6 +207,7 @@ float Transport::SwingBeat(float pos)
 void Transport::Nudge(float amount)
 {
    mMeasurePos += amount;
+   mAnnouncedPos -= amount;
    if (mMeasurePos < 0)
    {
       mMeasurePos += 1;
@@ -244,6 +272,7 @@ void Transport::Reset()
 {
    mMeasurePos = .999f;
    mMeasureCount = -1;
+   mAnnouncedPos = 0;
 }
 
 void Transport::ButtonClicked(ClickButton *button)
@@ -262,12 +291,70 @@ void Transport::ButtonClicked(ClickButton *button)
 
 void Transport::AddListener(ITimeListener* listener, NoteInterval interval, float offset /*= 0*/, bool offsetIsInMs /*=true*/)
 {
-   //try to update first in case we already point to this
-   if (!UpdateListener(listener, interval, offset, offsetIsInMs))
-      mListeners.push_front(TransportListenerInfo(listener, interval, offset, offsetIsInMs));
+   SetListener(listener, interval, offset, offsetIsInMs, true);
 }
 
+//from the audio thread this only queues the change, and returns true since it can't look at the lists
 bool Transport::UpdateListener(ITimeListener* listener, NoteInterval interval, float offset /*= 0*/, bool offsetIsInMs /*=true*/)
+{
+   return SetListener(listener, interval, offset, offsetIsInMs, false);
+}
+
+bool Transport::QueueListenerEdit(ITimeListener* listener, NoteInterval interval, float offset, bool offsetIsInMs, bool addIfMissing)
+{
+   int write = mQueuedEditsWrite.load(std::memory_order_relaxed);
+   int next = (write + 1) % kMaxQueuedEdits;
+   if (next == mQueuedEditsRead.load(std::memory_order_acquire))
+      return false;  //the main thread hasn't caught up. drop it rather than block
+   
+   QueuedListenerEdit& edit = mQueuedEdits[write];
+   edit.mListener = listener;
+   edit.mInterval = interval;
+   edit.mOffset = offset;
+   edit.mOffsetIsInMs = offsetIsInMs;
+   edit.mAddIfMissing = addIfMissing;
+   mQueuedEditsWrite.store(next, std::memory_order_release);
+   return true;
+}
+
+void Transport::ApplyAudioThreadEdits()
+{
+   if (mQueuedEditsRead.load() == mQueuedEditsWrite.load())
+      return;
+   
+   bool changed = false;
+   {
+      ScopedLock lock(mTimingListsMutex);   //also keeps us to one reader
+      int read = mQueuedEditsRead.load(std::memory_order_relaxed);
+      int write = mQueuedEditsWrite.load(std::memory_order_acquire);
+      for (; read != write; read = (read + 1) % kMaxQueuedEdits)
+      {
+         const QueuedListenerEdit& edit = mQueuedEdits[read];
+         changed |= ApplyListenerEdit(edit.mListener, edit.mInterval, edit.mOffset, edit.mOffsetIsInMs, edit.mAddIfMissing);
+      }
+      mQueuedEditsRead.store(read, std::memory_order_release);
+   }
+   if (changed)
+      PublishTimingLists();
+}
+
+bool Transport::SetListener(ITimeListener* listener, NoteInterval interval, float offset, bool offsetIsInMs, bool addIfMissing)
+{
+   if (IsAudioThread())
+      return QueueListenerEdit(listener, interval, offset, offsetIsInMs, addIfMissing);
+   
+   bool changed = false;
+   {
+      ScopedLock lock(mTimingListsMutex);
+      changed = ApplyListenerEdit(listener, interval, offset, offsetIsInMs, addIfMissing);
+   }
+   if (changed)
+      PublishTimingLists();
+   return changed;
+}
+
+//needs mTimingListsMutex. returns whether the listener is (now) in the list
+bool Transport::ApplyListenerEdit(ITimeListener* listener, NoteInterval interval, float offset, bool offsetIsInMs, bool addIfMissing)
 {
    for (list<TransportListenerInfo>::iterator i = mListeners.begin(); i != mListeners.end(); ++i)
    {
@@ -280,30 +367,103 @@ bool Transport::UpdateListener(ITimeListener* listener, NoteInterval interval, f
          return true;
       }
    }
-   return false;
+   
+   if (!addIfMissing)
+      return false;
+   
+   mListeners.push_front(TransportListenerInfo(listener, interval, offset, offsetIsInMs));
+   if (mHoldingNewListeners)
+      mHeldListeners.push_back(listener);
+   return true;
 }
 
 void Transport::RemoveListener(ITimeListener* listener)
 {
-   for (list<TransportListenerInfo>::iterator i = mListeners.begin(); i != mListeners.end();)
+   if (!IsAudioThread())
+      ApplyAudioThreadEdits();   //so a queued add can't bring it back after it's gone
+   
    {
-      TransportListenerInfo& info = *i;
-      if (info.mListener == listener)
-         i = mListeners.erase(i);
-      else
-         ++i;
+      ScopedLock lock(mTimingListsMutex);
+      for (list<TransportListenerInfo>::iterator i = mListeners.begin(); i != mListeners.end();)
+      {
+         TransportListenerInfo& info = *i;
+         if (info.mListener == listener)
+            i = mListeners.erase(i);
+         else
+            ++i;
+      }
+      RemoveFromVector(listener, mHeldListeners);
    }
+   PublishTimingLists();
 }
 
 void Transport::AddAudioPoller(IAudioPoller* poller)
 {
-   if (!ListContains(poller, mAudioPollers))
+   {
+      ScopedLock lock(mTimingListsMutex);
+      if (ListContains(poller, mAudioPollers))
+         return;
       mAudioPollers.push_front(poller);
+      if (mHoldingNewListeners)
+         mHeldPollers.push_back(poller);
+   }
+   PublishTimingLists();
 }
 
 void Transport::RemoveAudioPoller(IAudioPoller* poller)
 {
-   mAudioPollers.remove(poller);
+   {
+      ScopedLock lock(mTimingListsMutex);
+      mAudioPollers.remove(poller);
+      RemoveFromVector(poller, mHeldPollers);
+   }
+   PublishTimingLists();
+}
+
+void Transport::SetHoldingNewListeners(bool hold)
+{
+   {
+      ScopedLock lock(mTimingListsMutex);
+      mHoldingNewListeners = hold;
+      if (hold)
+         return;
+      mHeldListeners.clear();
+      mHeldPollers.clear();
+   }
+   PublishTimingLists();
+}
+
+//hands the audio thread a fresh copy of the lists. once this returns, Advance() can't be calling
+//anything that was taken out of them, so it's safe to delete
+void Transport::PublishTimingLists()
+{
+   vector<TimingLists*> retired;
+   {
+      ScopedLock lock(mTimingListsMutex);
+      TimingLists* lists = new TimingLists();
+      for (const auto& info : mListeners)
+      {
+         if (!VectorContains(info.mListener, mHeldListeners))
+            lists->mListeners.push_back(info);
+      }
+      for (auto* poller : mAudioPollers)
+      {
+         if (!VectorContains(poller, mHeldPollers))
+            lists->mAudioPollers.push_back(poller);
+      }
+      mRetiredTimingLists.push_back(mTimingLists.exchange(lists));
+      
+      if (mAdvancingThread.load() == Thread::getCurrentThreadId())
+         return;  //called from a listener inside Advance(), which is still walking the old lists. the next change frees them
+      retired.swap(mRetiredTimingLists);
+   }
+   
+   SpinWait wait;
+   while (mAdvancing.load())
+      wait.Pause();
+   
+   for (auto* lists : retired)
+      delete lists;
 }
 
 int Transport::GetQuantized(float offsetMs, NoteInterval interval)
@@ -438,40 +598,88 @@ float Transport::GetDuration(NoteInterval interval)
    }
 }
 
-void Transport::UpdateListeners(float jumpMs)
+//events are scheduled one block ahead: we're called right after the transport has moved to the
+//start of the next block, so look for interval boundaries inside that block and tell listeners
+//exactly which sample they land on. that lets them timestamp their output with
+//gTime + samplesTo * gInvSampleRateMs instead of snapping to the block boundary.
+//anything between the end of the last lookahead and now (the transport was reset or nudged) fires on sample 0.
+//short intervals at high tempos can have several boundaries in one block, and each one gets its own event
+void Transport::UpdateListeners(const vector<TransportListenerInfo>& listeners)
 {
-   for (list<TransportListenerInfo>::iterator i = mListeners.begin(); i != mListeners.end(); ++i)
+   float announcedMs = mAnnouncedPos * MsPerBar();
+   for (const auto& info : listeners)
    {
-      const TransportListenerInfo& info = *i;
-      if (info.mInterval != kInterval_None &&
+      if (info.mInterval != kInterval_None &&
           info.mInterval != kInterval_Free)
       {
-         if (info.mOffsetIsInMs)
-         {
-            if (GetQuantized(info.mOffset-jumpMs, info.mInterval) != GetQuantized(info.mOffset, info.mInterval))
-            {
-               info.mListener->OnTimeEvent(0); //TODO(Ryan) calc sample offset
-            }
-         }
-         else
+         float offsetMs = info.mOffsetIsInMs ? info.mOffset : info.mOffset*MsPerBar();
+         float fromMs = announcedMs;
+         int startSample = 0;
+         while (startSample < gBufferSize)
          {
-            float offsetMs = info.mOffset*MsPerBar();
-            if (GetQuantized(offsetMs-jumpMs, info.mInterval) != GetQuantized(offsetMs, info.mInterval))
-            {
-               info.mListener->OnTimeEvent(0); //TODO(Ryan) calc sample offset
-            }
+            int samplesTo = GetSamplesToBoundary(offsetMs, fromMs, info.mInterval, startSample, gBufferSize);
+            if (samplesTo == -1)
+               break;
+            DispatchTimeEvent(info.mListener, samplesTo);
+            fromMs = samplesTo * gInvSampleRateMs;
+            startSample = samplesTo + 1;
          }
       }
    }
+   mAnnouncedPos = (gBufferSize-1) * gInvSampleRateMs / MsPerBar();
+}
+
+//returns the first sample in [startSample, numSamples) that falls into a different interval than fromMs,
+//or -1 if the interval doesn't change in that range
+int Transport::GetSamplesToBoundary(float offsetMs, float fromMs, NoteInterval interval, int startSample, int numSamples)
+{
+   int before = GetQuantized(offsetMs + fromMs, interval);
+   if (GetQuantized(offsetMs + (numSamples-1) * gInvSampleRateMs, interval) == before)
+      return -1;
+   
+   int low = startSample;
+   int high = numSamples-1;
+   while (low < high)
+   {
+      int mid = (low + high) / 2;
+      if (GetQuantized(offsetMs + mid * gInvSampleRateMs, interval) != before)
+         high = mid;
+      else
+         low = mid + 1;
+   }
+   return low;
+}
+
+//while a listener handles an event, the transport reports the position the event lands on,
+//so GetQuantized()/GetMeasure() return the step being triggered rather than the one before it
+void Transport::DispatchTimeEvent(ITimeListener* listener, int samplesTo)
+{
+   float measurePos = mMeasurePos;
+   unsigned int measureCount = mMeasureCount;
+   if (samplesTo > 0)
+      AdvanceMeasurePos(samplesTo * gInvSampleRateMs / MsPerBar());
+   float eventMeasurePos = mMeasurePos;
+   
+   listener->OnTimeEvent(samplesTo);
+   
+   if (mMeasurePos == eventMeasurePos) //don't undo it if the listener moved the transport itself
+   {
+      mMeasurePos = measurePos;
+      mMeasureCount = measureCount;
+   }
 }
 
 void Transport::OnDrumEvent(NoteInterval drumEvent)
 {
-   for (list<TransportListenerInfo>::iterator i = mListeners.begin(); i != mListeners.end(); ++i)
+   vector<TransportListenerInfo> listeners;
+   {
+      ScopedLock lock(mTimingListsMutex);
+      listeners.assign(mListeners.begin(), mListeners.end());
+   }
+   for (const auto& info : listeners)
    {
-      const TransportListenerInfo& info = *i;
       if (info.mInterval == drumEvent)
-         info.mListener->OnTimeEvent(0); //TODO(Ryan) calc sample offset
+         info.mListener->OnTimeEvent(0); //drum events come in live, so they land at the start of the block
    }
 }
 
@@ -544,5 +752,6 @@ void Transport::LoadState(FileStreamIn& in)
    LoadStateValidate(rev == kSaveStateRev);
    
    in >> mMeasurePos;
+   mAnnouncedPos = 0;
 }
 
@@ -16,6 +16,7 @@
 #include "DropdownList.h"
 #include "Checkbox.h"
 #include "IAudioPoller.h"
+#include <atomic>
 
 class ITimeListener
 {
@@ -67,6 +68,7 @@ class Transport : public IDrawableModule, public IButtonListener, public IFloatS
 {
 public:
    Transport();
+   ~Transport();
    
    string GetTitleLabel() override { return "transport"; }
    void CreateUIControls() override;
@@ -85,14 +87,16 @@ public:
    bool UpdateListener(ITimeListener* listener, NoteInterval interval, float offset = 0, bool offsetIsInMs = true);
    void AddAudioPoller(IAudioPoller* poller);
    void RemoveAudioPoller(IAudioPoller* poller);
+   void SetHoldingNewListeners(bool hold);   //while held, new listeners and pollers don't hear from the audio thread yet
+   void ApplyAudioThreadEdits();   //main thread. applies listener changes that were made from the audio thread
    float GetDuration(NoteInterval interval);
    int GetQuantized(float offsetMs, NoteInterval interval);
    float GetMeasurePos() const { return mMeasurePos; }
    float GetMeasurePos(int offset) const;
-   void SetMeasurePos(float pos) { mMeasurePos = pos; }
+   void SetMeasurePos(float pos) { mMeasurePos = pos; mAnnouncedPos = 0; }
    int GetMeasure() const { return mMeasureCount; }
    void SetMeasure(int count) { mMeasureCount = count; }
-   void SetDownbeat() { mMeasurePos = .999f; --mMeasureCount; }
+   void SetDownbeat() { mMeasurePos = .999f; --mMeasureCount; mAnnouncedPos = 0; }
    static int CountInStandardMeasure(NoteInterval interval);
    void Reset();
    void OnDrumEvent(NoteInterval drumEvent);
@@ -116,7 +120,33 @@ public:
    void SaveState(FileStreamOut& out) override;
    void LoadState(FileStreamIn& in) override;
 private:
-   void UpdateListeners(float jumpMs);
+   //the audio thread walks a published copy of the listener and poller lists, so they can change while it's running
+   struct TimingLists
+   {
+      vector<TransportListenerInfo> mListeners;
+      vector<IAudioPoller*> mAudioPollers;
+   };
+   
+   //the audio thread can't take mTimingListsMutex or allocate, so listener changes it makes
+   //(a controller moving an interval dropdown, say) wait here for the main thread to pick them up
+   struct QueuedListenerEdit
+   {
+      ITimeListener* mListener;
+      NoteInterval mInterval;
+      float mOffset;
+      bool mOffsetIsInMs;
+      bool mAddIfMissing;
+   };
+   
+   void PublishTimingLists();
+   bool QueueListenerEdit(ITimeListener* listener, NoteInterval interval, float offset, bool offsetIsInMs, bool addIfMissing);
+   bool SetListener(ITimeListener* listener, NoteInterval interval, float offset, bool offsetIsInMs, bool addIfMissing);
+   bool ApplyListenerEdit(ITimeListener* listener, NoteInterval interval, float offset, bool offsetIsInMs, bool addIfMissing);
+   bool IsAudioThread() const { return mAudioThread.load() == Thread::getCurrentThreadId(); }
+   void UpdateListeners(const vector<TransportListenerInfo>& listeners);
+   int GetSamplesToBoundary(float offsetMs, float fromMs, NoteInterval interval, int startSample, int numSamples);
+   void DispatchTimeEvent(ITimeListener* listener, int samplesTo);
+   void AdvanceMeasurePos(float amount);
    float Swing(float measurePos);
    float SwingBeat(float pos);
    void Nudge(float amount);
@@ -132,6 +162,7 @@ private:
    int mTimeSigBottom;
    unsigned int mMeasureCount;
    float mMeasurePos;
+   float mAnnouncedPos; //how far ahead of mMeasurePos time events have already been sent out
    int mSwingInterval;
    float mSwing;
    FloatSlider* mSwingSlider;
@@ -152,6 +183,19 @@ private:
 
    list<TransportListenerInfo> mListeners;
    list<IAudioPoller*> mAudioPollers;
+   CriticalSection mTimingListsMutex;   //guards the lists above. the audio thread queues its edits instead of taking this
+   bool mHoldingNewListeners;
+   vector<ITimeListener*> mHeldListeners;
+   vector<IAudioPoller*> mHeldPollers;
+   std::atomic<TimingLists*> mTimingLists;   //what Advance() walks
+   vector<TimingLists*> mRetiredTimingLists;
+   std::atomic<bool> mAdvancing;
+   std::atomic<Thread::ThreadID> mAdvancingThread;
+   std::atomic<Thread::ThreadID> mAudioThread;
+   static const int kMaxQueuedEdits = 256;
+   QueuedListenerEdit mQueuedEdits[kMaxQueuedEdits];   //single producer (audio thread), single consumer (main thread)
+   std::atomic<int> mQueuedEditsWrite;
+   std::atomic<int> mQueuedEditsRead;
 };
 
 extern Transport* TheTransport;
@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    TransportTests.cpp
+    Created: 19 Oct 2026 10:37:12am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "../JuceLibraryCode/JuceHeader.h"
+#include "Transport.h"
+#include "ModularSynth.h"
+#include "SynthGlobals.h"
+
+#if JUCE_UNIT_TESTS
+
+//listeners have to hear about every interval boundary, on the sample it lands on,
+//even when the interval is shorter than a buffer
+class TransportTests : public UnitTest
+{
+public:
+   TransportTests() : UnitTest("Transport") {}
+
+   void runTest() override
+   {
+      //the test gets its own transport, so keep the audio and render threads away from the real one while it's swapped out
+      ScopedLock renderLock(*TheSynth->GetRenderLock());
+      TheSynth->SuspendAudio();
+      Transport* transport = TheTransport;
+      TheTransport = nullptr;
+
+      beginTest("interval shorter than a buffer");
+      {
+         ExpectEveryBoundary(gBufferSize / 3.3f);
+      }
+
+      beginTest("interval longer than a buffer");
+      {
+         ExpectEveryBoundary(gBufferSize * 2.7f);
+      }
+
+      TheTransport = transport;
+      TheSynth->ResumeAudio();
+   }
+
+private:
+   struct Listener : public ITimeListener
+   {
+      void OnTimeEvent(int samplesTo) override { mEvents.push_back(mBlockStart + samplesTo); }
+      int64 mBlockStart;
+      vector<int64> mEvents;
+   };
+
+   void ExpectEveryBoundary(float intervalSamples)
+   {
+      const int kNumBlocks = 200;
+      float blockMs = gBufferSize * gInvSampleRateMs;
+      float intervalMs = intervalSamples * gInvSampleRateMs;
+
+      Transport* transport = new Transport();
+      transport->SetTimeSignature(4, 4);
+      transport->SetTempo(60 * 1000 * 4 / (intervalMs * Transport::CountInStandardMeasure(kInterval_64n)));
+
+      //Advance() takes this for the audio thread, so add the listener first. its first block is spent catching up, so skip that
+      Listener listener;
+      listener.mBlockStart = 0;
+      transport->AddListener(&listener, kInterval_64n);
+      transport->Advance(blockMs);
+      listener.mEvents.clear();
+      for (int i=0; i<kNumBlocks; ++i)
+      {
+         listener.mBlockStart = int64(i) * gBufferSize;
+         transport->Advance(blockMs);
+      }
+      transport->RemoveListener(&listener);
+      delete transport;
+      TheTransport = nullptr;
+
+      int expected = int(kNumBlocks * gBufferSize / intervalSamples);
+      expect(abs(int(listener.mEvents.size()) - expected) <= 1, "got "+String(listener.mEvents.size())+" events, expected "+String(expected));
+
+      float maxError = 0;
+      for (int i=1; i<listener.mEvents.size(); ++i)
+         maxError = MAX(maxError, fabsf((listener.mEvents[i] - listener.mEvents[i-1]) - intervalSamples));
+      expect(maxError <= 1, "events stray "+String(maxError)+" samples from the interval");
+   }
+};
+
+static TransportTests sTransportTests;
+
+#endif
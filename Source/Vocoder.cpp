@@ -11,16 +11,12 @@
 #include "Profiler.h"
 
 #define VOCODER_WINDOW_SIZE 1024
-#define FFT_FREQDOMAIN_SIZE VOCODER_WINDOW_SIZE/2 + 1
+#define VOCODER_HOP_SIZE (VOCODER_WINDOW_SIZE/4)
+#define VOCODER_OUTPUT_LEVEL .6144f  //where the level sat back when a frame was taken every 64 sample buffer
 
 Vocoder::Vocoder()
 : IAudioProcessor(gBufferSize)
-, mFFT(VOCODER_WINDOW_SIZE)
-, mRollingInputBuffer(VOCODER_WINDOW_SIZE)
-, mRollingOutputBuffer(VOCODER_WINDOW_SIZE)
-, mFFTData(VOCODER_WINDOW_SIZE, FFT_FREQDOMAIN_SIZE)
-, mRollingCarrierBuffer(VOCODER_WINDOW_SIZE)
-, mCarrierFFTData(VOCODER_WINDOW_SIZE, FFT_FREQDOMAIN_SIZE)
+, mSTFT(VOCODER_WINDOW_SIZE, VOCODER_HOP_SIZE, 2)
 , mInputPreamp(1)
 , mCarrierPreamp(1)
 , mVolume(1)
@@ -39,10 +35,7 @@ Vocoder::Vocoder()
 , mCut(1)
 , mCutSlider(nullptr)
 {
-   // Generate a window with a single raised cosine from N/4 to 3N/4
-   mWindower = new float[VOCODER_WINDOW_SIZE];
-   for (int i=0; i<VOCODER_WINDOW_SIZE; ++i)
-      mWindower[i] = -.5*cos(FTWO_PI*i/VOCODER_WINDOW_SIZE)+.5;
+   mSTFT.SetListener(this);
 
    mCarrierInputBuffer = new float[GetBuffer()->BufferSize()];
    Clear(mCarrierInputBuffer, GetBuffer()->BufferSize());
@@ -69,7 +62,6 @@ void Vocoder::CreateUIControls()
 
 Vocoder::~Vocoder()
 {
-   delete[] mWindower;
    delete[] mCarrierInputBuffer;
 }
 
@@ -90,7 +82,6 @@ void Vocoder::Process(double time)
    SyncBuffers();
 
    float inputPreampSq = mInputPreamp * mInputPreamp;
-   float carrierPreampSq = mCarrierPreamp * mCarrierPreamp;
    float volSq = mVolume * mVolume;
 
    int bufferSize = GetBuffer()->BufferSize();
@@ -112,59 +103,62 @@ void Vocoder::Process(double time)
 
    mGate.ProcessAudio(time, GetBuffer());
 
-   mRollingInputBuffer.WriteChunk(GetBuffer()->GetChannel(0), bufferSize, 0);
-   
-   //copy rolling input buffer into working buffer and window it
-   mRollingInputBuffer.ReadChunk(mFFTData.mTimeDomain, VOCODER_WINDOW_SIZE, 0, 0);
-   Mult(mFFTData.mTimeDomain, mWindower, VOCODER_WINDOW_SIZE);
-   Mult(mFFTData.mTimeDomain, inputPreampSq, VOCODER_WINDOW_SIZE);
-
-   mFFT.Forward(mFFTData.mTimeDomain,
-                mFFTData.mRealValues,
-                mFFTData.mImaginaryValues);
-
-   if (!fricative)
-   {
-      mRollingCarrierBuffer.WriteChunk(mCarrierInputBuffer, bufferSize, 0);
-   }
-   else
+   //the carrier gets analyzed right alongside the input, swapped for noise (at about the same level) during fricatives
+   const float* carrier = mCarrierInputBuffer;
+   if (fricative)
    {
-      //use noise as carrier signal if it's a fricative
-      //but make the noise the same-ish volume as input carrier
       for (int i=0; i<bufferSize; ++i)
-         mRollingCarrierBuffer.Write(mCarrierInputBuffer[rand()%bufferSize]*2, 0);
+         gWorkBuffer[i] = mCarrierInputBuffer[rand()%bufferSize]*2;
+      carrier = gWorkBuffer;
    }
 
-   //copy rolling carrier buffer into working buffer and window it
-   mRollingCarrierBuffer.ReadChunk(mCarrierFFTData.mTimeDomain, VOCODER_WINDOW_SIZE, 0, 0);
-   Mult(mCarrierFFTData.mTimeDomain, mWindower, VOCODER_WINDOW_SIZE);
-   Mult(mCarrierFFTData.mTimeDomain, carrierPreampSq, VOCODER_WINDOW_SIZE);
+   float* wet = gWorkBuffer + bufferSize;
+   const float* inputs[2] = { GetBuffer()->GetChannel(0), carrier };
+   mSTFT.Process(inputs, wet, bufferSize);
+
+   Mult(GetBuffer()->GetChannel(0), (1-mDryWet)*inputPreampSq, GetBuffer()->BufferSize());
+
+   for (int i=0; i<bufferSize; ++i)
+      GetBuffer()->GetChannel(0)[i] += wet[i] * volSq * mDryWet;
+
+   Add(GetTarget()->GetBuffer()->GetChannel(0), GetBuffer()->GetChannel(0), bufferSize);
+
+   GetVizBuffer()->WriteChunk(GetBuffer()->GetChannel(0),bufferSize, 0);
+
+   GetBuffer()->Reset();
+}
+
+void Vocoder::ProcessFrame(STFT* stft, int offset)
+{
+   float inputPreampSq = mInputPreamp * mInputPreamp;
+   float carrierPreampSq = mCarrierPreamp * mCarrierPreamp;
+   float* realValues = stft->GetReal(0);
+   float* imaginaryValues = stft->GetImag(0);
+   const float* carrierRealValues = stft->GetReal(1);
+   const float* carrierImaginaryValues = stft->GetImag(1);
 
-   mFFT.Forward(mCarrierFFTData.mTimeDomain,
-                mCarrierFFTData.mRealValues,
-                mCarrierFFTData.mImaginaryValues);
+   mPhaseOffsetSlider->Compute();
 
-   for (int i=0; i<FFT_FREQDOMAIN_SIZE; ++i)
+   for (int i=0; i<stft->GetNumBins(); ++i)
    {
-      float real = mFFTData.mRealValues[i];
-      float imag = mFFTData.mImaginaryValues[i];
+      float real = realValues[i];
+      float imag = imaginaryValues[i];
 
       //cartesian to polar
-      float amp = 2.*sqrtf(real*real + imag*imag);
+      float amp = 2.*sqrtf(real*real + imag*imag) * inputPreampSq;
       float phase = atan2(imag,real);
 
-      float carrierReal = mCarrierFFTData.mRealValues[i];
-      float carrierImag = mCarrierFFTData.mImaginaryValues[i];
+      float carrierReal = carrierRealValues[i];
+      float carrierImag = carrierImaginaryValues[i];
 
       //cartesian to polar
-      float carrierAmp = 2.*sqrtf(carrierReal*carrierReal + carrierImag*carrierImag);
+      float carrierAmp = 2.*sqrtf(carrierReal*carrierReal + carrierImag*carrierImag) * carrierPreampSq;
       float carrierPhase = atan2(carrierImag,carrierReal);
 
-      amp *= carrierAmp;
+      amp *= carrierAmp * VOCODER_OUTPUT_LEVEL;
       phase = carrierPhase;
 
       phase += ofRandom(mWhisper*FTWO_PI);
-      mPhaseOffsetSlider->Compute();
       phase += mPhaseOffset;
       FloatWrap(phase, FTWO_PI);
       
@@ -175,31 +169,9 @@ void Vocoder::Process(double time)
       real = amp*cos(phase);
       imag = amp*sin(phase);
 
-      mFFTData.mRealValues[i] = real;
-      mFFTData.mImaginaryValues[i] = imag;
+      realValues[i] = real;
+      imaginaryValues[i] = imag;
    }
-
-   mFFT.Inverse(mFFTData.mRealValues,
-                mFFTData.mImaginaryValues,
-                mFFTData.mTimeDomain);
-
-   for (int i=0; i<bufferSize; ++i)
-      mRollingOutputBuffer.Write(0, 0);
-
-   //copy rolling input buffer into working buffer and window it
-   for (int i=0; i<VOCODER_WINDOW_SIZE; ++i)
-      mRollingOutputBuffer.Accum(VOCODER_WINDOW_SIZE-i-1, mFFTData.mTimeDomain[i] * mWindower[i] * .0001f, 0);
-
-   Mult(GetBuffer()->GetChannel(0), (1-mDryWet)*inputPreampSq, GetBuffer()->BufferSize());
-
-   for (int i=0; i<bufferSize; ++i)
-      GetBuffer()->GetChannel(0)[i] += mRollingOutputBuffer.GetSample(VOCODER_WINDOW_SIZE-i-1, 0) * volSq * mDryWet;
-
-   Add(GetTarget()->GetBuffer()->GetChannel(0), GetBuffer()->GetChannel(0), bufferSize);
-
-   GetVizBuffer()->WriteChunk(GetBuffer()->GetChannel(0),bufferSize, 0);
-
-   GetBuffer()->Reset();
 }
 
 void Vocoder::DrawModule()
@@ -13,14 +13,13 @@
 #include "IAudioProcessor.h"
 #include "IDrawableModule.h"
 #include "Checkbox.h"
-#include "FFT.h"
-#include "RollingBuffer.h"
+#include "STFT.h"
 #include "Slider.h"
 #include "GateEffect.h"
 #include "BiquadFilterEffect.h"
 #include "VocoderCarrierInput.h"
 
-class Vocoder : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public VocoderBase, public IIntSliderListener
+class Vocoder : public IAudioProcessor, public IDrawableModule, public IFloatSliderListener, public VocoderBase, public IIntSliderListener, public ISTFTListener
 {
 public:
    Vocoder();
@@ -44,47 +43,21 @@ public:
    void FloatSliderUpdated(FloatSlider* slider, float oldVal) override {}
    void IntSliderUpdated(IntSlider* slider, int oldVal) override {}
    
+   //ISTFTListener
+   void ProcessFrame(STFT* stft, int offset) override;
+   
    virtual void LoadLayout(const ofxJSONElement& moduleInfo) override;
    virtual void SetUpFromSaveData() override;
    
 private:
-   struct FFTData
-   {
-      FFTData(int windowSize, int freqDomainSize)
-      {
-         mRealValues = new float[freqDomainSize];
-         mImaginaryValues = new float[freqDomainSize];
-         mTimeDomain = new float[windowSize];
-      }
-      ~FFTData()
-      {
-         delete[] mRealValues;
-         delete[] mImaginaryValues;
-         delete[] mTimeDomain;
-      }
-      float* mRealValues;
-      float* mImaginaryValues;
-      float* mTimeDomain;
-   };
-
    //IDrawableModule
    void DrawModule() override;
    void GetModuleDimensions(int& w, int&h) override { w=235; h=170; }
    bool Enabled() const override { return mEnabled; }
 
-   FFTData mFFTData;
-   
-   float* mWindower;
-
-   
-
-   ::FFT mFFT;
-   RollingBuffer mRollingInputBuffer;
-   RollingBuffer mRollingOutputBuffer;
+   STFT mSTFT;
 
    float* mCarrierInputBuffer;
-   RollingBuffer mRollingCarrierBuffer;
-   FFTData mCarrierFFTData;
 
    float mInputPreamp;
    float mCarrierPreamp;
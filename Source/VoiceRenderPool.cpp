@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.cpp
+    Created: 18 Oct 2026 12:31:07am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#include "VoiceRenderPool.h"
+#include "SynthGlobals.h"
+
+VoiceRenderPool* TheVoiceRenderPool = nullptr;
+
+VoiceRenderPool::VoiceRenderPool()
+{
+}
+
+VoiceRenderPool::~VoiceRenderPool()
+{
+   StopWorkers();
+}
+
+void VoiceRenderPool::SetNumWorkers(int numWorkers)
+{
+   numWorkers = ofClamp(numWorkers, 0, kMaxWorkers);
+
+   ScopedLock lock(mWorkersMutex);
+   StopWorkers();
+   for (int i=0; i<numWorkers; ++i)
+   {
+      Worker* worker = new Worker(this, i+1);
+      worker->startThread(9);
+      mWorkers.push_back(worker);
+   }
+}
+
+void VoiceRenderPool::StopWorkers()
+{
+   for (auto* worker : mWorkers)
+      worker->signalThreadShouldExit();
+   for (auto* worker : mWorkers)
+   {
+      worker->Wake();
+      worker->stopThread(1000);
+      delete worker;
+   }
+   mWorkers.clear();
+}
+
+bool VoiceRenderPool::Run(IJobList* jobs, int numJobs)
+{
+   //if the ui thread is busy changing the worker count, the caller just renders this block itself
+   ScopedTryLock lock(mWorkersMutex);
+   if (!lock.isLocked() || mWorkers.empty())
+      return false;
+
+   Batch* batch = nullptr;
+   for (int i=0; i<kMaxBatches; ++i)
+   {
+      bool expected = false;
+      if (mBatches[i].mClaimed.compare_exchange_strong(expected, true, std::memory_order_acquire))
+      {
+         batch = &mBatches[i];
+         break;
+      }
+   }
+   if (batch == nullptr)
+      return false;
+
+   //move on to the next run while closed, so anyone holding onto the last run's job list can't claim from this one
+   uint64 run = (batch->mState.load() >> 32) + 1;
+   batch->mState.store((run << 32) | kClosed);
+   batch->mJobs.store(jobs);
+   batch->mNumJobs.store(numJobs);
+   batch->mJobsDone.store(0);
+   uint64 state = run << 32;
+   batch->mState.store(state);
+
+   for (auto* worker : mWorkers)
+      worker->Wake();
+
+   //we claim every job that no worker has started yet, so all that can be left to wait for is jobs already running
+   RunJobs(*batch, state, jobs, numJobs);
+
+   SpinWait wait;
+   while (batch->mJobsDone.load(std::memory_order_acquire) < numJobs)
+      wait.Pause();  //a worker is finishing up the last jobs
+
+   batch->mClaimed.store(false, std::memory_order_release);
+   return true;
+}
+
+void VoiceRenderPool::RunBatches()
+{
+   for (int i=0; i<kMaxBatches; ++i)
+   {
+      Batch& batch = mBatches[i];
+      uint64 state = batch.mState.load();
+      if ((state & kClosed) == kClosed)
+         continue;
+      
+      //these might already belong to a later run, in which case claiming fails below
+      IJobList* jobs = batch.mJobs.load();
+      int numJobs = batch.mNumJobs.load();
+      RunJobs(batch, state, jobs, numJobs);
+   }
+}
+
+void VoiceRenderPool::RunJobs(Batch& batch, uint64 state, IJobList* jobs, int numJobs)
+{
+   uint64 run = state >> 32;
+   while (true)
+   {
+      if ((state >> 32) != run || (state & kClosed) >= uint64(numJobs))
+         break;
+      if (!batch.mState.compare_exchange_weak(state, state+1))
+         continue;
+      jobs->RunJob(int(state & kClosed));
+      batch.mJobsDone.fetch_add(1, std::memory_order_acq_rel);
+      ++state;
+   }
+}
+
+VoiceRenderPool::Worker::Worker(VoiceRenderPool* owner, int index)
+: juce::Thread("voice render worker "+String(index))
+, mOwner(owner)
+{
+}
+
+void VoiceRenderPool::Worker::run()
+{
+   PrepareAudioThread();
+   while (!threadShouldExit())
+   {
+      if (mWake.wait(100))
+         mOwner->RunBatches();
+   }
+}
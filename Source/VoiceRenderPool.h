@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    VoiceRenderPool.h
+    Created: 18 Oct 2026 12:31:07am
+    Author:  Ryan Challinor
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "OpenFrameworksPort.h"
+#include <atomic>
+
+//worker threads shared by every synth that renders its voices in parallel.
+//a batch of jobs runs on whichever workers are free and on the thread that submitted it, which claims jobs too,
+//so a batch always finishes even while the workers are busy with someone else's
+class VoiceRenderPool
+{
+public:
+   class IJobList
+   {
+   public:
+      virtual ~IJobList() {}
+      virtual void RunJob(int index) = 0;   //called from any thread, once per job
+   };
+
+   VoiceRenderPool();
+   ~VoiceRenderPool();
+
+   void SetNumWorkers(int numWorkers);   //main thread
+   int GetNumWorkers() const { return (int)mWorkers.size(); }
+   bool Run(IJobList* jobs, int numJobs);   //audio threads. returns once every job has run, or false without running any if there are no workers free to help
+
+   static const int kMaxWorkers = 15;
+   static const int kMaxBatches = 16;   //batches that can be in flight at once, one per synth on each audio graph thread
+
+private:
+   class Worker : public juce::Thread
+   {
+   public:
+      Worker(VoiceRenderPool* owner, int index);
+      void run() override;
+      void Wake() { mWake.signal(); }
+   private:
+      VoiceRenderPool* mOwner;
+      WaitableEvent mWake;
+   };
+
+   //jobs are claimed by bumping the low half of mState. the high half counts how many times the batch has been opened,
+   //so a worker that read the job list of an earlier run can't claim anything from a later one, and the submitter
+   //never has to wait for workers that looked at the batch and found nothing
+   struct Batch
+   {
+      Batch() : mClaimed(false), mState(kClosed), mJobs(nullptr), mNumJobs(0), mJobsDone(0) {}
+      std::atomic<bool> mClaimed;   //by the thread that submitted it
+      std::atomic<uint64> mState;
+      std::atomic<IJobList*> mJobs;
+      std::atomic<int> mNumJobs;
+      std::atomic<int> mJobsDone;
+   };
+   static const uint64 kClosed = 0xffffffff;   //a next job index past the end of any batch
+
+   void RunBatches();
+   void RunJobs(Batch& batch, uint64 state, IJobList* jobs, int numJobs);
+   void StopWorkers();
+
+   Batch mBatches[kMaxBatches];
+   CriticalSection mWorkersMutex;
+   vector<Worker*> mWorkers;
+};
+
+extern VoiceRenderPool* TheVoiceRenderPool;